@@ -2,18 +2,14 @@
  * @file client_impl.c
  * @brief Implementation de toutes les fonctions du CLIENT PIVOTE V2.
  *
- * Compilation (MinGW / Code::Blocks, C99) :
- * gcc -std=c99 -Wall client_impl.c client_main.c -o client.exe -lws2_32
+ * Compilation (Windows ou Linux, C99) : cmake -S . -B build && cmake --build build
+ * (cible pivote-client), ou le projet Code::Blocks Pivoteclient2.0.cbp.
  */
 
 #include "client.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <winsock2.h>
-#include <windows.h>
-
-#pragma comment(lib, "ws2_32.lib")
 
 /* =========================================================
  * 1. HELPERS CONSOLE
@@ -37,72 +33,59 @@ void lire_ligne(const char *invite, char *buffer, size_t taille)
 /* =========================================================
  * 2. CONNEXION RESEAU
  * ========================================================= */
-int initialiserSocket(SOCKET *sock)
+int initialiserSocket(SessionClient *s)
 {
-    WSADATA wsa;
-    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
-        printf("[ERREUR] Initialisation Winsock echouee.\n");
-        return 0;
-    }
-    *sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (*sock == INVALID_SOCKET) {
-        printf("[ERREUR] Creation de la socket echouee.\n");
-        WSACleanup();
+    clientInit(s);
+    if (!socketsInit()) {
+        printf("[ERREUR] Initialisation des sockets echouee.\n");
         return 0;
     }
     return 1;
 }
 
-int connecterAuServeur(SOCKET sock, char *server_ip)
+int connecterAuServeur(SessionClient *s, char *server_ip)
 {
-    struct sockaddr_in server_addr;
-
     printf("Entrez l'adresse IP du serveur (ex: 192.168.1.15) : ");
     scanf("%49s", server_ip);
     viderBuffer();
 
-    server_addr.sin_family      = AF_INET;
-    server_addr.sin_addr.s_addr = inet_addr(server_ip);
-    server_addr.sin_port        = htons(PORT);
-
     printf("Tentative de connexion a %s...\n", server_ip);
-    if (connect(sock, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+    if (!clientConnecter(s, server_ip, PORT)) {
         printf("\n[ERREUR FATALE] Impossible de joindre le serveur.\n");
         printf("Verifiez :\n");
         printf(" 1. L'adresse IP est correcte.\n");
         printf(" 2. Le serveur a lance l'option 9.\n");
-        printf(" 3. Le pare-feu Windows.\n");
+        printf(" 3. Le pare-feu du serveur.\n");
         return 0;
     }
     printf("Connexion etablie.\n\n");
     return 1;
 }
 
+int negocierProtocole(SessionClient *s, const char *server_ip)
+{
+    if (!clientNegocier(s, server_ip, PORT)) {
+        printf("\n[ERREUR] Reconnexion au serveur impossible.\n");
+        return 0;
+    }
+    return 1;
+}
+
 /* =========================================================
  * 3. AUTHENTIFICATION
  * ========================================================= */
-int authentifier(SOCKET sock, char *username, char *password)
+int authentifier(SessionClient *s, char *username, char *password)
 {
-    char send_buffer[BUFFER];
-    char recv_buffer[BUFFER];
-    int  tentatives = 3;
-    int  len;
+    int tentatives = 3;
 
     while (tentatives > 0) {
         printf("=== CONNEXION ===\n");
         lire_ligne("Identifiant : ", username, 65);
         lire_ligne("Mot de passe : ", password, 65);
 
-        /* Envoi "AUTH <username> <password>" */
-        snprintf(send_buffer, sizeof(send_buffer), "AUTH %s %s", username, password);
-        send(sock, send_buffer, strlen(send_buffer), 0);
-
-        /* Lecture reponse */
-        len = recv(sock, recv_buffer, BUFFER - 1, 0);
-        if (len <= 0) return 0;
-        recv_buffer[len] = '\0';
-
-        if (strcmp(recv_buffer, "AUTH_OK") == 0) {
+        int r = clientAuthentifier(s, username, password);
+        if (r < 0) return 0;
+        if (r == 1) {
             printf("\nConnexion reussie. Bonjour %s !\n", username);
             return 1;
         }
@@ -125,14 +108,12 @@ int authentifier(SOCKET sock, char *username, char *password)
 /* =========================================================
  * 4. VOTE
  * ========================================================= */
-void recevoirListeCandidats(SOCKET sock)
+void recevoirListeCandidats(SessionClient *s)
 {
-    char recv_buffer[BUFFER];
-    int len = recv(sock, recv_buffer, BUFFER - 1, 0);
-    if (len > 0) {
-        recv_buffer[len] = '\0';
-        printf("%s", recv_buffer);
-    }
+    char liste[CLIENT_TAMPON];
+
+    clientRecevoirListe(s, liste, sizeof(liste), NULL, 0);
+    printf("%s", liste);
 }
 
 void saisirVote(int *idE, int *idC)
@@ -165,32 +146,25 @@ void saisirVote(int *idE, int *idC)
     } while (!voteValide);
 }
 
-void envoyerVote(SOCKET sock, int idE, int idC)
+void envoyerVote(SessionClient *s, int idE, int idC)
 {
-    char send_buffer[BUFFER];
-    /* Format : "VOTE <idElecteur> <idCandidat>" */
-    snprintf(send_buffer, sizeof(send_buffer), "VOTE %d %d", idE, idC);
-    send(sock, send_buffer, strlen(send_buffer), 0);
+    clientEnvoyerVote(s, idE, idC);
 }
 
-void recevoirConfirmationVote(SOCKET sock)
+void recevoirConfirmationVote(SessionClient *s)
 {
-    char recv_buffer[BUFFER];
-    int len = recv(sock, recv_buffer, BUFFER - 1, 0);
-    if (len > 0) {
-        recv_buffer[len] = '\0';
-        if (strcmp(recv_buffer, "OK") == 0)
-            printf("\n[SUCCES] A PIVOTE ! Merci de votre participation.\n");
-        else
-            printf("\n[ECHEC] Vote refuse (ID invalide, deja vote, ou scrutin ferme).\n");
-    }
+    int r = clientRecevoirConfirmation(s);
+    if (r == 1)
+        printf("\n[SUCCES] A PIVOTE ! Merci de votre participation.\n");
+    else if (r == 0)
+        printf("\n[ECHEC] Vote refuse (ID invalide, deja vote, ou scrutin ferme).\n");
 }
 
 /* =========================================================
  * 5. NETTOYAGE
  * ========================================================= */
-void fermerConnexion(SOCKET sock)
+void fermerConnexion(SessionClient *s)
 {
-    closesocket(sock);
-    WSACleanup();
+    clientFermer(s);
+    socketsFin();
 }
@@ -9,20 +9,30 @@
  *   - fermerVote()          : appelle les 3 fonctions ci-dessus automatiquement
  *   - naviguerMenu()        : navigation fleches + couleurs console
  *
- * Compilation (MinGW / Code::Blocks, C99) :
- * gcc -std=c99 -Wall FONCTIONS_PIVOTE_SERVEUR_V2.c PIVOTE_SERVEUR_V2.c auth.c -o serveur.exe -lws2_32
+ * Compilation (Windows ou Linux, C99) : cmake -S . -B build && cmake --build build
+ * (cible pivote-serveur), ou le projet Code::Blocks Pivoteserveur2.0.cbp.
  */
 
-#include <conio.h>
 #include "serveur.h"
+#include <limits.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
-#include <winsock2.h>
-#include <windows.h>
 #include "auth.h"
+#include "decompte.h"
+#include "file_votes.h"
+#include "instantane.h"
+#include "journal_votes.h"
+#include "plateforme.h"
+#include "reseau_commun.h"
+#include "reseau_epoll.h"
+#include "reseau_uring.h"
 #include <locale.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
 
 /* =========================================================
  * COULEURS CONSOLE   doivent etre avant toute fonction
@@ -33,20 +43,31 @@
 
 static void setCouleur(int couleur)
 {
-    SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), couleur);
+    consoleCouleur(couleur);
 }
 
-#pragma comment(lib, "ws2_32.lib")
-
 /* =========================================================
  * VARIABLES GLOBALES
  * ========================================================= */
-Electeur electeurs[MAX];
-Candidat candidats[MAX];
-int nbElecteurs        = 0;
+TableElecteurs electeurs;   /* vide, rien d'alloue */
+Candidat candidats[MAX_CANDIDATS];
 int nbCandidats        = 0;
 int voteOuvert         = 0;
 int affichageAutoActif = 0;
+int nbWorkersReseau    = 0;
+
+/*
+ * Synchronisation avec les workers reseau :
+ *   - verrouDonnees (lecture/ecriture) protege electeurs et candidats[] ;
+ *     les ajouts le prennent en ecriture. Un vote se contente de la lecture :
+ *     il reserve son bit aVote (OU atomique) et compte sa voix dans sa tranche
+ *     (decompte.h), si bien que les workers votent en parallele. Le prendre
+ *     en ecriture garantit qu'aucun vote n'est a moitie applique.
+ *   - verrouFichiers serialise les ajouts au journal des votes et la copie
+ *     de l'etat pour un instantane (toujours pris avant verrouDonnees).
+ */
+Verrou        verrouDonnees  = VERROU_INIT;
+static Verrou verrouFichiers = VERROU_INIT;
 
 static AuthUser adminConnecte;
 
@@ -78,13 +99,171 @@ static void afficher_utilisateur(const AuthUser *u)
 /* =========================================================
  * 2. GESTION DES ELECTEURS ET CANDIDATS
  * ========================================================= */
-void ajouterElecteur(void)
+static unsigned int hashId(int id)
+{
+    return (unsigned int)id * 2654435761u;
+}
+
+static unsigned int hashLogin(const char *s)
+{
+    unsigned int h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/*
+ * Index persistants (adressage ouvert, sondage lineaire) : id -> slot et
+ * login -> slot dans electeurs, id -> slot dans candidats[]. Une case
+ * contient un slot (-1 = libre) ; la cle est relue dans la table. Les index
+ * sont proteges par verrouDonnees comme les tables, et reconstruits en
+ * entier quand ils sont a moitie pleins. Faute de memoire, les recherches
+ * reviennent au parcours lineaire jusqu'a la reconstruction suivante.
+ */
+typedef struct {
+    size_t masque;
+    int   *slots;
+} IndexSlots;
+
+static IndexSlots indexIdElecteur, indexLogin, indexIdCandidat;
+static int        indexValides = 0;
+
+static int *allouerSlots(size_t nbElements, size_t *masque)
+{
+    size_t taille = 64;
+    while (taille < nbElements * 2) taille *= 2;
+    int *slots = (int *)malloc(taille * sizeof(int));
+    if (slots) {
+        memset(slots, 0xFF, taille * sizeof(int));   /* -1 partout */
+        *masque = taille - 1;
+    }
+    return slots;
+}
+
+#if defined(__GNUC__)
+#define PRECHARGER(p) __builtin_prefetch((p), 1)
+#else
+#define PRECHARGER(p) ((void)0)
+#endif
+#define INDEX_LOT 16   /* cases prechargees avant d'etre remplies */
+
+static void placerSlot(IndexSlots *ix, unsigned int h, int slot)
+{
+    size_t i = h & ix->masque;
+    while (ix->slots[i] >= 0) i = (i + 1) & ix->masque;
+    ix->slots[i] = slot;
+}
+
+/* Reconstruit les trois index depuis les tables (verrouDonnees exclusif). */
+static void reconstruireIndex(void)
+{
+    IndexSlots e = {0, NULL}, l = {0, NULL}, c = {0, NULL};
+
+    e.slots = allouerSlots((size_t)electeurs.nb, &e.masque);
+    l.slots = allouerSlots((size_t)electeurs.nb, &l.masque);
+    c.slots = allouerSlots((size_t)nbCandidats, &c.masque);
+    if (!e.slots || !l.slots || !c.slots) {
+        free(e.slots);
+        free(l.slots);
+        free(c.slots);
+        indexValides = 0;
+        return;
+    }
+    /* Par lots : les cases d'un lot sont demandees a la memoire ensemble,
+       au lieu d'attendre chaque defaut de cache l'un apres l'autre */
+    for (int i = 0; i < electeurs.nb; i += INDEX_LOT) {
+        unsigned int he[INDEX_LOT], hl[INDEX_LOT];
+        int          n = electeurs.nb - i < INDEX_LOT ? electeurs.nb - i : INDEX_LOT;
+        for (int k = 0; k < n; k++) {
+            he[k] = hashId(electeurs.id[i + k]);
+            hl[k] = hashLogin(tableElecteursLogin(&electeurs, i + k));
+            PRECHARGER(&e.slots[he[k] & e.masque]);
+            PRECHARGER(&l.slots[hl[k] & l.masque]);
+        }
+        for (int k = 0; k < n; k++) {
+            placerSlot(&e, he[k], i + k);
+            placerSlot(&l, hl[k], i + k);
+        }
+    }
+    for (int j = 0; j < nbCandidats; j++)
+        placerSlot(&c, hashId(candidats[j].id), j);
+
+    free(indexIdElecteur.slots);
+    free(indexLogin.slots);
+    free(indexIdCandidat.slots);
+    indexIdElecteur = e;
+    indexLogin      = l;
+    indexIdCandidat = c;
+    indexValides    = 1;
+}
+
+/* Indexe electeurs[slot], qui vient d'etre ajoute (verrouDonnees exclusif). */
+static void indexerElecteur(int slot)
 {
-    if (nbElecteurs >= MAX) {
-        printf("Nombre maximum d'\xe9lecteurs atteint.\n");
+    if (!indexValides || (size_t)electeurs.nb * 2 > indexIdElecteur.masque + 1) {
+        reconstruireIndex();
         return;
     }
+    placerSlot(&indexIdElecteur, hashId(electeurs.id[slot]), slot);
+    placerSlot(&indexLogin, hashLogin(tableElecteursLogin(&electeurs, slot)), slot);
+}
+
+/* Indexe candidats[slot], qui vient d'etre ajoute (verrouDonnees exclusif). */
+static void indexerCandidat(int slot)
+{
+    if (!indexValides || (size_t)nbCandidats * 2 > indexIdCandidat.masque + 1) {
+        reconstruireIndex();
+        return;
+    }
+    placerSlot(&indexIdCandidat, hashId(candidats[slot].id), slot);
+}
+
+/* Slot de l'electeur d'id `id`, -1 si inconnu. */
+static int chercherElecteur(int id)
+{
+    const IndexSlots *ix = &indexIdElecteur;
+    if (!indexValides) {
+        for (int i = 0; i < electeurs.nb; i++)
+            if (electeurs.id[i] == id) return i;
+        return -1;
+    }
+    for (size_t i = hashId(id) & ix->masque; ix->slots[i] >= 0; i = (i + 1) & ix->masque)
+        if (electeurs.id[ix->slots[i]] == id) return ix->slots[i];
+    return -1;
+}
+
+/* Slot de l'electeur de login `login`, -1 si inconnu. */
+static int chercherElecteurLogin(const char *login)
+{
+    const IndexSlots *ix = &indexLogin;
+    if (!indexValides) {
+        for (int i = 0; i < electeurs.nb; i++)
+            if (strcmp(tableElecteursLogin(&electeurs, i), login) == 0) return i;
+        return -1;
+    }
+    for (size_t i = hashLogin(login) & ix->masque; ix->slots[i] >= 0; i = (i + 1) & ix->masque)
+        if (strcmp(tableElecteursLogin(&electeurs, ix->slots[i]), login) == 0) return ix->slots[i];
+    return -1;
+}
+
+/* Slot du candidat d'id `id`, -1 si inconnu (vote blanc). */
+static int chercherCandidat(int id)
+{
+    const IndexSlots *ix = &indexIdCandidat;
+    if (!indexValides) {
+        for (int j = 0; j < nbCandidats; j++)
+            if (candidats[j].id == id) return j;
+        return -1;
+    }
+    for (size_t i = hashId(id) & ix->masque; ix->slots[i] >= 0; i = (i + 1) & ix->masque)
+        if (candidats[ix->slots[i]].id == id) return ix->slots[i];
+    return -1;
+}
 
+void ajouterElecteur(void)
+{
     Electeur e;
     char username[AUTH_MAX_USERNAME + 1];
     char password[AUTH_MAX_PASSWORD + 1];
@@ -103,11 +282,9 @@ void ajouterElecteur(void)
     lire_ligne_srv("Identifiant de connexion (login) : ", username, sizeof(username));
     lire_ligne_srv("Mot de passe initial             : ", password, sizeof(password));
 
-    for (int i = 0; i < nbElecteurs; i++) {
-        if (electeurs[i].id == e.id) {
-            printf("Erreur : un \xe9lecteur avec l'ID %d existe d\xe9j\xe0.\n", e.id);
-            return;
-        }
+    if (chercherElecteur(e.id) >= 0) {
+        printf("Erreur : un \xe9lecteur avec l'ID %d existe d\xe9j\xe0.\n", e.id);
+        return;
     }
 
     AuthStatus st = auth_register_user(CSV_PATH, username, password, "votant");
@@ -115,31 +292,234 @@ void ajouterElecteur(void)
         printf("Erreur : un compte '%s' existe d\xe9j\xe0.\n", username);
         return;
     } else if (st != AUTH_OK) {
-        printf("Erreur cr\xe9ation du compte (code=%d).\n", st);
+        printf("Erreur cr\xe9" "ation du compte (code=%d).\n", st);
         return;
     }
 
-    e.a_vote     = 0;
-    e.vote_blanc = 0;
     strncpy(e.username, username, AUTH_MAX_USERNAME);
     e.username[AUTH_MAX_USERNAME] = '\0';
 
-    electeurs[nbElecteurs++] = e;
+    verrouExclusifPrendre(&verrouDonnees);
+    int slot = tableElecteursAjouter(&electeurs, e.id, e.nom, e.username);
+    if (slot >= 0) indexerElecteur(slot);
+    verrouExclusifRendre(&verrouDonnees);
+    if (slot < 0) {
+        printf("M\xe9moire insuffisante : \xe9lecteur non ajout\xe9.\n");
+        return;
+    }
     printf("\xc9lecteur '%s' (login: %s) enregistr\xe9 avec succ\xe8s.\n", e.nom, username);
 }
 
 void afficherElecteurs(void)
 {
-    for (int i = 0; i < nbElecteurs; i++)
+    verrouPartagePrendre(&verrouDonnees);
+    for (int i = 0; i < electeurs.nb; i++)
         printf("ID:%d | %s (login:%s) | A vot\xe9: %s\n",
-               electeurs[i].id, electeurs[i].nom,
-               electeurs[i].username,
-               electeurs[i].a_vote ? "OUI" : "NON");
+               electeurs.id[i], tableElecteursNom(&electeurs, i),
+               tableElecteursLogin(&electeurs, i),
+               decompteBit(electeurs.aVote, i) ? "OUI" : "NON");
+    verrouPartageRendre(&verrouDonnees);
+}
+
+/* =========================================================
+ * IMPORT EN MASSE D'ELECTEURS (fichier id;nom;login;password)
+ * ========================================================= */
+
+/*
+ * Ensemble temporaire (adressage ouvert, sondage lineaire) des ids et
+ * logins deja vus : les doublons sont detectes en une seule passe.
+ */
+typedef struct {
+    size_t       masque;
+    int         *ids;
+    char        *idsOccupes;
+    const char **logins;
+} EnsembleImport;
+
+static int ensembleInit(EnsembleImport *e, size_t nbElements)
+{
+    size_t taille = 64;
+    while (taille < nbElements * 2) taille *= 2;
+    e->masque     = taille - 1;
+    e->ids        = (int *)malloc(taille * sizeof(int));
+    e->idsOccupes = (char *)calloc(taille, 1);
+    e->logins     = (const char **)calloc(taille, sizeof(const char *));
+    return e->ids && e->idsOccupes && e->logins;
+}
+
+static void ensembleLiberer(EnsembleImport *e)
+{
+    free(e->ids);
+    free(e->idsOccupes);
+    free(e->logins);
+}
+
+/* Ajoute l'id ; renvoie 0 s'il etait deja present. */
+static int ensembleAjouterId(EnsembleImport *e, int id)
+{
+    size_t i = hashId(id) & e->masque;
+    while (e->idsOccupes[i]) {
+        if (e->ids[i] == id) return 0;
+        i = (i + 1) & e->masque;
+    }
+    e->idsOccupes[i] = 1;
+    e->ids[i]        = id;
+    return 1;
+}
+
+/* Ajoute le login (non copie) ; renvoie 0 s'il etait deja present. */
+static int ensembleAjouterLogin(EnsembleImport *e, const char *login)
+{
+    size_t i = hashLogin(login) & e->masque;
+    while (e->logins[i]) {
+        if (strcmp(e->logins[i], login) == 0) return 0;
+        i = (i + 1) & e->masque;
+    }
+    e->logins[i] = login;
+    return 1;
+}
+
+int importerElecteurs(const char *chemin)
+{
+    FILE *f = fopen(chemin, "r");
+    if (!f) {
+        printf("Impossible d'ouvrir %s.\n", chemin);
+        return -1;
+    }
+
+    Electeur *lus     = NULL;
+    AuthUser *comptes = NULL;
+    size_t    nb = 0, cap = 0;
+    char      ligne[512];
+    int       numLigne = 0;
+    int       erreur   = 0;
+
+    /* 1. Lecture de toutes les lignes */
+    while (!erreur && fgets(ligne, sizeof(ligne), f)) {
+        numLigne++;
+        size_t l = strlen(ligne);
+        while (l > 0 && (ligne[l-1] == '\n' || ligne[l-1] == '\r'))
+            ligne[--l] = '\0';
+        if (l == 0) continue;
+
+        char *sId   = strtok(ligne, ";");
+        char *nom   = strtok(NULL, ";");
+        char *login = strtok(NULL, ";");
+        char *mdp   = strtok(NULL, ";");
+        char *fin   = NULL;
+        long  id    = sId ? strtol(sId, &fin, 10) : 0;
+
+        if (!sId || fin == sId || *fin != '\0') {
+            if (numLigne == 1) continue;   /* Ligne d'en-tete */
+            printf("Ligne %d : ID invalide.\n", numLigne);
+            erreur = 1;
+            break;
+        }
+        if (!nom || !login || !mdp) {
+            printf("Ligne %d : format attendu id;nom;login;password.\n", numLigne);
+            erreur = 1;
+            break;
+        }
+
+        if (nb == cap) {
+            size_t nouv = cap ? cap * 2 : 256;
+            Electeur *t1 = (Electeur *)realloc(lus, nouv * sizeof(Electeur));
+            if (t1) lus = t1;
+            AuthUser *t2 = (AuthUser *)realloc(comptes, nouv * sizeof(AuthUser));
+            if (t2) comptes = t2;
+            if (!t1 || !t2) {
+                printf("M\xe9moire insuffisante.\n");
+                erreur = 1;
+                break;
+            }
+            cap = nouv;
+        }
+
+        Electeur *e = &lus[nb];
+        memset(e, 0, sizeof(*e));
+        e->id = (int)id;
+        strncpy(e->nom, nom, sizeof(e->nom) - 1);
+        strncpy(e->username, login, AUTH_MAX_USERNAME);
+
+        AuthUser *u = &comptes[nb];
+        memset(u, 0, sizeof(*u));
+        strncpy(u->username, login, AUTH_MAX_USERNAME);
+        strncpy(u->password, mdp, AUTH_MAX_PASSWORD);
+        strcpy(u->role, "votant");
+        nb++;
+    }
+    fclose(f);
+
+    /* 2. Doublons d'ID et de login en une passe (inscrits : index persistants) */
+    EnsembleImport vus;
+    memset(&vus, 0, sizeof(vus));
+    if (!erreur && !ensembleInit(&vus, nb)) {
+        printf("M\xe9moire insuffisante.\n");
+        erreur = 1;
+    }
+    for (size_t i = 0; !erreur && i < nb; i++) {
+        if (chercherElecteur(lus[i].id) >= 0 || !ensembleAjouterId(&vus, lus[i].id)) {
+            printf("Erreur : l'ID %d est en double.\n", lus[i].id);
+            erreur = 1;
+        } else if (chercherElecteurLogin(lus[i].username) >= 0
+                   || !ensembleAjouterLogin(&vus, lus[i].username)) {
+            printf("Erreur : le login '%s' est en double.\n", lus[i].username);
+            erreur = 1;
+        }
+    }
+    ensembleLiberer(&vus);
+
+    /* Place reservee avant de creer les comptes : les ajouts ne peuvent plus echouer */
+    if (!erreur) {
+        size_t octets = 0;
+        for (size_t i = 0; i < nb; i++)
+            octets += strlen(lus[i].nom) + strlen(lus[i].username) + 2;
+        verrouExclusifPrendre(&verrouDonnees);
+        if (nb > (size_t)INT_MAX || !tableElecteursReserver(&electeurs, (int)nb, octets)) {
+            printf("M\xe9moire insuffisante.\n");
+            erreur = 1;
+        }
+        verrouExclusifRendre(&verrouDonnees);
+    }
+
+    /* 3. Comptes crees en une seule ecriture, puis electeurs ajoutes */
+    if (!erreur && nb > 0) {
+        size_t     fautif = 0;
+        AuthStatus st = auth_register_users_batch(CSV_PATH, comptes, nb, &fautif);
+        if (st == AUTH_ERR_EXISTS) {
+            printf("Erreur : un compte '%s' existe d\xe9j\xe0.\n", comptes[fautif].username);
+            erreur = 1;
+        } else if (st != AUTH_OK) {
+            printf("Erreur cr\xe9" "ation des comptes (code=%d).\n", st);
+            erreur = 1;
+        }
+    }
+    if (!erreur) {
+        verrouExclusifPrendre(&verrouDonnees);
+        for (size_t i = 0; i < nb; i++)
+            tableElecteursAjouter(&electeurs, lus[i].id, lus[i].nom, lus[i].username);
+        reconstruireIndex();
+        verrouExclusifRendre(&verrouDonnees);
+        printf("%zu \xe9lecteur(s) import\xe9(s).\n", nb);
+    } else {
+        printf("Import annul\xe9 : aucun \xe9lecteur ajout\xe9.\n");
+    }
+
+    free(lus);
+    free(comptes);
+    return erreur ? -1 : (int)nb;
+}
+
+void importerElecteursCSV(void)
+{
+    char chemin[260];
+    lire_ligne_srv("Fichier \xe0 importer (id;nom;login;password) : ", chemin, sizeof(chemin));
+    importerElecteurs(chemin);
 }
 
 void ajouterCandidat(void)
 {
-    if (nbCandidats >= MAX) return;
+    if (nbCandidats >= MAX_CANDIDATS) return;
     Candidat c;
     printf("ID : ");
     scanf("%d", &c.id);
@@ -150,16 +530,24 @@ void ajouterCandidat(void)
         size_t l = strlen(c.nom);
         if (l > 0 && c.nom[l-1] == '\n') c.nom[l-1] = '\0';
     }
-    c.voix = 0;
+    verrouExclusifPrendre(&verrouDonnees);
+    decompteFixer(nbCandidats, 0);
     candidats[nbCandidats++] = c;
+    indexerCandidat(nbCandidats - 1);
+    verrouExclusifRendre(&verrouDonnees);
+    publierListeCandidats();
     printf("Candidat ajout\xe9.\n");
 }
 
 void afficherCandidats(void)
 {
-    for (int i = 0; i < nbCandidats; i++)
+    DecompteAgregats a;
+    verrouPartagePrendre(&verrouDonnees);
+    decompteAgreger(nbCandidats, &a);
+    for (int i = 0; i < a.nbCandidats; i++)
         printf("ID:%d | %s | Voix: %d\n",
-               candidats[i].id, candidats[i].nom, candidats[i].voix);
+               candidats[i].id, candidats[i].nom, a.voix[i]);
+    verrouPartageRendre(&verrouDonnees);
 }
 
 /* =========================================================
@@ -167,7 +555,9 @@ void afficherCandidats(void)
  * ========================================================= */
 void ouvrirVote(void)
 {
+    verrouExclusifPrendre(&verrouDonnees);
     voteOuvert = 1;
+    verrouExclusifRendre(&verrouDonnees);
     printf("Vote OUVERT.\n");
 }
 
@@ -180,7 +570,10 @@ void ouvrirVote(void)
  */
 void fermerVote(void)
 {
+    /* Aucun worker ne compte de vote apres ce point */
+    verrouExclusifPrendre(&verrouDonnees);
     voteOuvert = 0;
+    verrouExclusifRendre(&verrouDonnees);
     printf("Vote FERM\xc9.\n\n");
 
     printf("========================================\n");
@@ -192,25 +585,27 @@ void fermerVote(void)
     afficherGagnant();
 
     printf("\n");
-    genererRapportFinal();
+    genererRapportFinal();   /* et le CSV, dans la meme passe */
 }
 
 void afficherResultats(void)
 {
-    for (int i = 0; i < nbCandidats; i++)
-        printf("%s : %d voix\n", candidats[i].nom, candidats[i].voix);
+    DecompteAgregats a;
+    verrouPartagePrendre(&verrouDonnees);
+    decompteAgreger(nbCandidats, &a);
+    for (int i = 0; i < a.nbCandidats; i++)
+        printf("%s : %d voix\n", candidats[i].nom, a.voix[i]);
+    verrouPartageRendre(&verrouDonnees);
 }
 
 void afficherStatistiques(void)
 {
-    int v = 0, b = 0;
-    for (int i = 0; i < nbElecteurs; i++) {
-        if (electeurs[i].a_vote) {
-            v++;
-            if (electeurs[i].vote_blanc) b++;
-        }
-    }
-    printf("Votants: %d / %d | Votes blancs: %d\n", v, nbElecteurs, b);
+    DecompteAgregats a;
+    verrouPartagePrendre(&verrouDonnees);
+    decompteAgreger(nbCandidats, &a);
+    int n = electeurs.nb;
+    verrouPartageRendre(&verrouDonnees);
+    printf("Votants: %ld / %d | Votes blancs: %ld\n", a.votants, n, a.blancs);
 }
 
 /* =========================================================
@@ -231,33 +626,33 @@ void afficherStatistiques(void)
  */
 void afficherBarresASCII(void)
 {
+    verrouPartagePrendre(&verrouDonnees);
     if (nbCandidats == 0) {
+        verrouPartageRendre(&verrouDonnees);
         printf("Aucun candidat enregistr\xe9.\n");
         return;
     }
 
-    /* Calcul du total des voix (candidats + blancs) */
-    int totalVoix = 0;
-    for (int i = 0; i < nbCandidats; i++)
-        totalVoix += candidats[i].voix;
-
-    int blancs = 0;
-    for (int i = 0; i < nbElecteurs; i++)
-        if (electeurs[i].vote_blanc) blancs++;
-    totalVoix += blancs;
+    /* Une seule lecture : les barres restent coherentes avec le total
+       meme si des votes arrivent pendant l'affichage */
+    DecompteAgregats a;
+    decompteAgreger(nbCandidats, &a);
+    int totalVoix = (int)a.total;
+    int blancs    = (int)a.blancs;
 
     /* Largeur de la barre */
     int largeur = 20;
 
     printf("\n");
-    for (int i = 0; i < nbCandidats; i++) {
-        double pct    = (totalVoix > 0) ? (100.0 * candidats[i].voix / totalVoix) : 0.0;
-        int    rempli = (totalVoix > 0) ? (largeur * candidats[i].voix / totalVoix) : 0;
+    for (int i = 0; i < a.nbCandidats; i++) {
+        int    voix   = a.voix[i];
+        double pct    = (totalVoix > 0) ? (100.0 * voix / totalVoix) : 0.0;
+        int    rempli = (totalVoix > 0) ? (largeur * voix / totalVoix) : 0;
 
         printf("  %-15s [", candidats[i].nom);
         for (int k = 0; k < largeur; k++)
             printf("%c", k < rempli ? '#' : ' ');
-        printf("] %3d voix (%5.1f%%)\n", candidats[i].voix, pct);
+        printf("] %3d voix (%5.1f%%)\n", voix, pct);
     }
 
     /* Ligne votes blancs */
@@ -269,76 +664,279 @@ void afficherBarresASCII(void)
     printf("] %3d voix (%5.1f%%)\n", blancs, pctBlanc);
 
     printf("\n  Total votes exprim\xe9s : %d\n", totalVoix);
+    verrouPartageRendre(&verrouDonnees);
 }
 
 /*
  * afficherGagnant()
  * -----------------
- * Parcourt les candidats pour trouver le maximum de voix.
- * Si plusieurs candidats sont a egalite, tous sont affiches.
+ * Le maximum de voix et le nombre de candidats qui l'atteignent
+ * viennent de decompteAgreger(). Si plusieurs candidats sont a egalite, tous sont affiches.
  * Les votes blancs ne peuvent pas gagner.
  */
 void afficherGagnant(void)
 {
+    verrouPartagePrendre(&verrouDonnees);
     if (nbCandidats == 0) {
+        verrouPartageRendre(&verrouDonnees);
         printf("Aucun candidat enregistr\xe9.\n");
         return;
     }
 
-    /* Recherche du maximum */
-    int maxVoix = 0;
-    for (int i = 0; i < nbCandidats; i++)
-        if (candidats[i].voix > maxVoix)
-            maxVoix = candidats[i].voix;
+    DecompteAgregats a;
+    decompteAgreger(nbCandidats, &a);
+    int maxVoix = a.maxVoix;
 
     if (maxVoix == 0) {
+        verrouPartageRendre(&verrouDonnees);
         printf("Aucun vote exprim\xe9. Pas de gagnant.\n");
         return;
     }
 
-    /* Compte les candidats a egalite */
-    int nbGagnants = 0;
-    for (int i = 0; i < nbCandidats; i++)
-        if (candidats[i].voix == maxVoix)
-            nbGagnants++;
-
     printf("========================================\n");
-    if (nbGagnants == 1) {
+    if (a.nbEnTete == 1) {
         printf("   GAGNANT DU SCRUTIN\n");
         printf("========================================\n");
-        for (int i = 0; i < nbCandidats; i++) {
-            if (candidats[i].voix == maxVoix)
+        for (int i = 0; i < a.nbCandidats; i++) {
+            if (a.voix[i] == maxVoix)
                 printf("   >> %s avec %d voix <<\n", candidats[i].nom, maxVoix);
         }
     } else {
         printf("   EGALITE PARFAITE !\n");
         printf("========================================\n");
         printf("   Les candidats suivants sont \xe0 \xe9galit\xe9 avec %d voix :\n", maxVoix);
-        for (int i = 0; i < nbCandidats; i++) {
-            if (candidats[i].voix == maxVoix)
+        for (int i = 0; i < a.nbCandidats; i++) {
+            if (a.voix[i] == maxVoix)
                 printf("   >> %s <<\n", candidats[i].nom);
         }
     }
     printf("========================================\n");
+    verrouPartageRendre(&verrouDonnees);
 }
 
+/* =========================================================
+ * 5. PERSISTANCE DES DONNEES
+ * La base est le dernier instantane binaire (instantane.h) ; les votes qui
+ * suivent sont dans le journal (journal_votes.h), dont un nouveau segment
+ * commence a chaque instantane. vote_data.txt (ancien format texte) n'est
+ * plus que relu, si aucun instantane n'a jamais ete ecrit, puis mis de cote
+ * par le premier. Un instantane present mais illisible arrete le demarrage.
+ * ========================================================= */
 /*
- * genererRapportFinal()
- * ----------------------
- * Cree le fichier rapport_final.txt avec :
- *   - Date et heure de generation
- *   - Nom de chaque candidat, voix, pourcentage
- *   - Votes blancs
- *   - Gagnant (ou egalite)
- *   - Taux de participation
+ * Ecrivain de fond : les instantanes et l'export CSV sont ecrits par un
+ * thread dedie. Sous verrouFichiers et verrouDonnees exclusifs, il ne fait
+ * que recopier l'etat dans un second jeu de tables (copieElecteurs, gardee
+ * d'une fois sur l'autre : une suite de memcpy, sans allocation une fois a
+ * la bonne taille) ; l'ecriture sur disque se fait ensuite sans verrou,
+ * pendant que les votes continuent.
+ *
+ * Les demandes sont numerotees (generations). Une demande qui arrive avant
+ * que la copie ne soit prise est servie par cette copie : quand les
+ * demandes vont plus vite que le disque, une seule ecriture attend derriere
+ * celle en cours, quel que soit le nombre de demandes. Sans thread, le
+ * demandeur ecrit lui-meme, sous csPersistance.
+ *
+ * Le meme thread tient les exports a jour : au plus une fois par
+ * PIVOTE_EXPORT_MS (defaut EXPORT_PERIODE_MS), et seulement si les
+ * resultats ont change depuis le precedent (resultatsModifies).
  */
-void genererRapportFinal(void)
+#define PERSISTER_INSTANTANE 1
+#define PERSISTER_EXPORT     2
+
+static Section   csPersistance;
+static Condition cvPersistanceDemande;
+static Condition cvPersistanceFaite;
+static unsigned long      generationDemandee  = 0;
+static unsigned long      generationCommencee = 0;   /* copie prise ou en cours   */
+static unsigned long      generationTraitee   = 0;
+static unsigned long      generationReussie   = 0;   /* dernier instantane ecrit   */
+static unsigned long      generationExportee  = 0;   /* derniers exports ecrits    */
+static int                travauxDemandes     = 0;   /* PERSISTER_* de la suivante */
+static int                persistanceActive   = 0;
+static int                persistanceArretee  = 0;
+static unsigned long long sequenceInstantane  = 0;   /* couverte par le dernier    */
+static int                exportPeriodeMs;
+static volatile long      resultatsModifies   = 0;   /* depuis les derniers exports */
+
+/* Double tampon : a l'ecrivain seul */
+static InstantaneScrutin  copieScrutin;
+static DecompteAgregats   copieAgregats;
+static int                copieNbElecteurs;
+static TableElecteurs     copieElecteurs;
+
+/*
+ * Resultats changes (vote, candidat...) ; ne salit la ligne qu'une fois.
+ * L'echange publie les changements faits avant l'appel a l'ecrivain qui
+ * lit l'indicateur.
+ */
+static void marquerResultats(void)
 {
-    FILE *f = fopen(FICHIER_RAPPORT, "w");
-    if (!f) {
-        printf("[ERREUR] Impossible de creer le rapport final.\n");
+    if (!atomiqueLire(&resultatsModifies)) atomiqueEchanger(&resultatsModifies, 1);
+}
+
+/* Candidats et voix, depuis l'etat courant (verrouDonnees tenu). */
+static void copierScrutin(void)
+{
+    decompteAgreger(nbCandidats, &copieAgregats);
+    copieNbElecteurs         = electeurs.nb;
+    copieScrutin.voteOuvert  = voteOuvert;
+    copieScrutin.nbCandidats = copieAgregats.nbCandidats;
+    for (int i = 0; i < copieAgregats.nbCandidats; i++) {
+        copieScrutin.idCandidat[i] = candidats[i].id;
+        copieScrutin.voix[i]       = copieAgregats.voix[i];
+        memcpy(copieScrutin.nomCandidat[i], candidats[i].nom, INSTANTANE_NOM);
+    }
+}
+
+/*
+ * Copie l'etat complet et commence un nouveau segment du journal, que
+ * l'instantane couvrira exactement. Aucun vote n'est alors a moitie
+ * applique ni en cours d'ajout au journal (un vote ne tient que le verrou
+ * partage). Le segment precedent n'est abandonne que si le dernier
+ * instantane ecrit couvre son debut : apres un echec d'ecriture, les
+ * segments s'accumulent dans le precedent jusqu'au prochain succes.
+ */
+static int copierEtat(void)
+{
+    verrouExclusifPrendre(&verrouFichiers);
+    verrouExclusifPrendre(&verrouDonnees);
+    int ok = tableElecteursCopier(&copieElecteurs, &electeurs);
+    if (ok) {
+        copierScrutin();
+        copieScrutin.sequence = journalSequence();
+        /* Journal ferme apres une erreur : le nouveau segment le rouvre */
+        if ((!journalActif() || journalSequence() > journalPremier())
+            && journalPremier() <= sequenceInstantane)
+            journalTourner();
+    }
+    verrouExclusifRendre(&verrouDonnees);
+    verrouExclusifRendre(&verrouFichiers);
+    return ok;
+}
+
+/* Ouvre le fichier temporaire d'un export (`tmp` : chemin + ".tmp"). */
+static FILE *ouvrirExport(const char *chemin, char *tmp, size_t taille)
+{
+    snprintf(tmp, taille, "%s.tmp", chemin);
+    FILE *f = fopen(tmp, "w");
+    if (!f) printf("[ERREUR] Impossible de cr\xe9\x65r %s.\n", tmp);
+    return f;
+}
+
+/* Met l'export en place d'un coup : un lecteur voit l'ancien ou le nouveau. */
+static int publierExport(FILE *f, const char *tmp, const char *chemin)
+{
+    int ok = !ferror(f);
+    if (fclose(f) != 0) ok = 0;
+    if (ok) ok = fichierRemplacer(tmp, chemin);
+    if (!ok) remove(tmp);
+    return ok;
+}
+
+#if defined(_WIN32)
+/*
+ * Page de code 1252 de la console, 0x80 a 0x9F (le reste est du Latin-1) ;
+ * les cinq octets non attribues restent tels quels, comme sous Windows.
+ */
+static const unsigned short cp1252Haut[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178
+};
+
+/* Octet >= 0x80 saisi en page 1252, en UTF-8. */
+static void ecrireOctetJson(FILE *f, const unsigned char **p)
+{
+    unsigned c = **p < 0xA0 ? cp1252Haut[**p - 0x80] : **p;
+    if (c >= 0x800) {
+        fputc((int)(0xE0 | (c >> 12)), f);
+        fputc((int)(0x80 | ((c >> 6) & 0x3F)), f);
+    } else {
+        fputc((int)(0xC0 | (c >> 6)), f);
+    }
+    fputc((int)(0x80 | (c & 0x3F)), f);
+}
+#else
+/* Longueur de la sequence UTF-8 valide qui commence en `p`, 0 sinon. */
+static int sequenceUtf8(const unsigned char *p)
+{
+    unsigned c, min;
+    int      n;
+
+    if (p[0] < 0xC2) return 0;                  /* suite isolee, ou trop longue */
+    if (p[0] < 0xE0)      { n = 2; c = p[0] & 0x1F; min = 0x80; }
+    else if (p[0] < 0xF0) { n = 3; c = p[0] & 0x0F; min = 0x800; }
+    else if (p[0] < 0xF5) { n = 4; c = p[0] & 0x07; min = 0x10000; }
+    else return 0;
+    for (int k = 1; k < n; k++) {
+        if ((p[k] & 0xC0) != 0x80) return 0;    /* le '\0' final aussi */
+        c = (c << 6) | (p[k] & 0x3F);
+    }
+    if (c < min || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) return 0;
+    return n;
+}
+
+/* Octet >= 0x80 : les noms sont deja en UTF-8 (console, CSV), copies tels quels. */
+static void ecrireOctetJson(FILE *f, const unsigned char **p)
+{
+    int n = sequenceUtf8(*p);
+    if (n == 0) {
+        fputs("\\ufffd", f);                  /* octet invalide : remplace */
         return;
     }
+    fwrite(*p, 1, (size_t)n, f);
+    *p += n - 1;
+}
+#endif
+
+/* Chaine JSON : echappements, et texte de la console en UTF-8. */
+static void ecrireChaineJson(FILE *f, const char *s)
+{
+    fputc('"', f);
+    for (const unsigned char *p = (const unsigned char *)s; *p; p++) {
+        if (*p == '"' || *p == '\\') {
+            fputc('\\', f);
+            fputc(*p, f);
+        } else if (*p < 0x20) {
+            fprintf(f, "\\u%04x", *p);
+        } else if (*p >= 0x80) {
+            ecrireOctetJson(f, &p);
+        } else {
+            fputc(*p, f);
+        }
+    }
+    fputc('"', f);
+}
+
+/*
+ * Ecrit les exports a partir de la copie (copieScrutin, copieAgregats), en
+ * une passe : resultats_vote.csv, resultats_vote.json et rapport_final.txt
+ * avancent ensemble, chacun dans son fichier temporaire renomme a la fin.
+ * Le rapport est "provisoire" tant que le vote est ouvert.
+ * @return 1 si les trois sont en place.
+ */
+static int ecrireExports(void)
+{
+    char  tmpCsv[64], tmpJson[64], tmpTxt[64];
+    FILE *csv  = ouvrirExport(FICHIER_EXCEL, tmpCsv, sizeof(tmpCsv));
+    FILE *json = ouvrirExport(FICHIER_JSON, tmpJson, sizeof(tmpJson));
+    FILE *txt  = ouvrirExport(FICHIER_RAPPORT, tmpTxt, sizeof(tmpTxt));
+    if (!csv || !json || !txt) {
+        if (csv)  { fclose(csv);  remove(tmpCsv); }
+        if (json) { fclose(json); remove(tmpJson); }
+        if (txt)  { fclose(txt);  remove(tmpTxt); }
+        return 0;
+    }
+
+    const DecompteAgregats  *a = &copieAgregats;
+    const InstantaneScrutin *s = &copieScrutin;
+    int    votants   = (int)a->votants;
+    int    blancs    = (int)a->blancs;
+    int    totalVoix = (int)a->total;
+    double tauxParticipation = (copieNbElecteurs > 0)
+                               ? (100.0 * votants / copieNbElecteurs)
+                               : 0.0;
 
     /* Date et heure */
     time_t now = time(NULL);
@@ -346,273 +944,1354 @@ void genererRapportFinal(void)
     char dateBuf[64];
     strftime(dateBuf, sizeof(dateBuf), "%d/%m/%Y a %H:%M:%S", t);
 
-    fprintf(f, "================================================\n");
-    fprintf(f, "         RAPPORT FINAL - SCRUTIN PIVOTE\n");
-    fprintf(f, "================================================\n");
-    fprintf(f, "Genere le : %s\n\n", dateBuf);
-
-    /* Statistiques de participation */
-    int votants = 0, blancs = 0;
-    for (int i = 0; i < nbElecteurs; i++) {
-        if (electeurs[i].a_vote) {
-            votants++;
-            if (electeurs[i].vote_blanc) blancs++;
-        }
+    fprintf(csv, "ID Candidat;Nom Candidat;Nombre de Voix\n");
+
+    fprintf(json, "{\n  \"genere\": %lld,\n  \"voteOuvert\": %s,\n",
+            (long long)now, s->voteOuvert ? "true" : "false");
+    fprintf(json, "  \"inscrits\": %d,\n  \"votants\": %d,\n  \"blancs\": %d,\n"
+                  "  \"total\": %d,\n  \"candidats\": [",
+            copieNbElecteurs, votants, blancs, totalVoix);
+
+    fprintf(txt, "================================================\n");
+    fprintf(txt, s->voteOuvert ? "     RESULTATS PROVISOIRES - SCRUTIN PIVOTE\n"
+                               : "         RAPPORT FINAL - SCRUTIN PIVOTE\n");
+    fprintf(txt, "================================================\n");
+    fprintf(txt, "Genere le : %s\n\n", dateBuf);
+    fprintf(txt, "------------------------------------------------\n");
+    fprintf(txt, "PARTICIPATION\n");
+    fprintf(txt, "------------------------------------------------\n");
+    fprintf(txt, "Electeurs inscrits : %d\n", copieNbElecteurs);
+    fprintf(txt, "Votes exprimes     : %d\n", votants);
+    fprintf(txt, "Votes blancs       : %d\n", blancs);
+    fprintf(txt, "Taux participation : %.1f%%\n\n", tauxParticipation);
+    fprintf(txt, "------------------------------------------------\n");
+    fprintf(txt, "RESULTATS PAR CANDIDAT\n");
+    fprintf(txt, "------------------------------------------------\n");
+
+    for (int i = 0; i < s->nbCandidats; i++) {
+        int    voix = s->voix[i];
+        double pct  = (totalVoix > 0) ? (100.0 * voix / totalVoix) : 0.0;
+        fprintf(csv, "%d;%s;%d\n", s->idCandidat[i], s->nomCandidat[i], voix);
+        fprintf(json, "%s\n    {\"id\": %d, \"nom\": ", i > 0 ? "," : "", s->idCandidat[i]);
+        ecrireChaineJson(json, s->nomCandidat[i]);
+        fprintf(json, ", \"voix\": %d, \"enTete\": %s}",
+                voix, voix > 0 && voix == a->maxVoix ? "true" : "false");
+        fprintf(txt, "  %-20s : %3d voix  (%.1f%%)\n", s->nomCandidat[i], voix, pct);
     }
-    double tauxParticipation = (nbElecteurs > 0)
-                               ? (100.0 * votants / nbElecteurs)
-                               : 0.0;
 
-    fprintf(f, "------------------------------------------------\n");
-    fprintf(f, "PARTICIPATION\n");
-    fprintf(f, "------------------------------------------------\n");
-    fprintf(f, "Electeurs inscrits : %d\n", nbElecteurs);
-    fprintf(f, "Votes exprimes     : %d\n", votants);
-    fprintf(f, "Votes blancs       : %d\n", blancs);
-    fprintf(f, "Taux participation : %.1f%%\n\n", tauxParticipation);
-
-    /* Resultats par candidat */
-    int totalVoix = 0;
-    for (int i = 0; i < nbCandidats; i++) totalVoix += candidats[i].voix;
-    totalVoix += blancs;
-
-    fprintf(f, "------------------------------------------------\n");
-    fprintf(f, "RESULTATS PAR CANDIDAT\n");
-    fprintf(f, "------------------------------------------------\n");
-    for (int i = 0; i < nbCandidats; i++) {
-        double pct = (totalVoix > 0) ? (100.0 * candidats[i].voix / totalVoix) : 0.0;
-        fprintf(f, "  %-20s : %3d voix  (%.1f%%)\n",
-                candidats[i].nom, candidats[i].voix, pct);
-    }
+    fprintf(csv, "0;VOTE BLANC;%ld\n", a->blancs);
+    fprintf(json, "\n  ],\n  \"egalite\": %s\n}\n", a->nbEnTete > 1 ? "true" : "false");
+
     double pctBlanc = (totalVoix > 0) ? (100.0 * blancs / totalVoix) : 0.0;
-    fprintf(f, "  %-20s : %3d voix  (%.1f%%)\n", "VOTE BLANC", blancs, pctBlanc);
-    fprintf(f, "\n  Total votes : %d\n\n", totalVoix);
+    fprintf(txt, "  %-20s : %3d voix  (%.1f%%)\n", "VOTE BLANC", blancs, pctBlanc);
+    fprintf(txt, "\n  Total votes : %d\n\n", totalVoix);
 
     /* Gagnant */
-    fprintf(f, "------------------------------------------------\n");
-    fprintf(f, "RESULTAT FINAL\n");
-    fprintf(f, "------------------------------------------------\n");
+    fprintf(txt, "------------------------------------------------\n");
+    fprintf(txt, s->voteOuvert ? "EN TETE\n" : "RESULTAT FINAL\n");
+    fprintf(txt, "------------------------------------------------\n");
+    if (a->maxVoix == 0) {
+        fprintf(txt, "Aucun vote exprime. Pas de gagnant.\n");
+    } else if (a->nbEnTete == 1) {
+        for (int i = 0; i < s->nbCandidats; i++)
+            if (s->voix[i] == a->maxVoix)
+                fprintf(txt, "%s : %s avec %d voix\n",
+                        s->voteOuvert ? "EN TETE" : "GAGNANT", s->nomCandidat[i], a->maxVoix);
+    } else {
+        fprintf(txt, "EGALITE entre les candidats suivants (%d voix chacun) :\n", a->maxVoix);
+        for (int i = 0; i < s->nbCandidats; i++)
+            if (s->voix[i] == a->maxVoix)
+                fprintf(txt, "  - %s\n", s->nomCandidat[i]);
+    }
+    fprintf(txt, "\n================================================\n");
+    fprintf(txt, "           FIN DU RAPPORT\n");
+    fprintf(txt, "================================================\n");
+
+    int ok = publierExport(csv, tmpCsv, FICHIER_EXCEL);
+    ok = publierExport(json, tmpJson, FICHIER_JSON) && ok;
+    ok = publierExport(txt, tmpTxt, FICHIER_RAPPORT) && ok;
+    return ok;
+}
 
-    int maxVoix = 0;
-    for (int i = 0; i < nbCandidats; i++)
-        if (candidats[i].voix > maxVoix) maxVoix = candidats[i].voix;
+/*
+ * Execute les travaux PERSISTER_* (ecrivain de fond, ou demandeur sous
+ * csPersistance). Un export seul ne copie que les candidats ; avec un
+ * instantane, il part de la meme copie.
+ * @return Les travaux reussis.
+ */
+static int persister(int travaux)
+{
+    int faits = 0;
+    if (travaux & PERSISTER_EXPORT)
+        atomiqueEchanger(&resultatsModifies, 0);   /* avant la copie, qu'un vote resalit */
+    if ((travaux & PERSISTER_INSTANTANE) && copierEtat()) {
+        if (instantaneEcrire(FICHIER_INSTANTANE, &copieScrutin, &copieElecteurs))
+            faits |= PERSISTER_INSTANTANE;
+    } else if (travaux & PERSISTER_EXPORT) {
+        verrouPartagePrendre(&verrouDonnees);
+        copierScrutin();
+        verrouPartageRendre(&verrouDonnees);
+    }
+    if (travaux & PERSISTER_EXPORT) {
+        if (ecrireExports()) faits |= PERSISTER_EXPORT;
+        else marquerResultats();   /* nouvel essai a la periode suivante */
+    }
+    return faits;
+}
 
-    if (maxVoix == 0) {
-        fprintf(f, "Aucun vote exprime. Pas de gagnant.\n");
+static void threadPersistance(void *arg)
+{
+    long long prochainExport = reseauMaintenantMs() + exportPeriodeMs;
+    (void)arg;
+
+    for (;;) {
+        /* Une demande, ou l'echeance des exports s'ils sont a refaire */
+        long long maintenant;
+        sectionEntrer(&csPersistance);
+        while (generationCommencee == generationDemandee
+               && ((maintenant = reseauMaintenantMs()) < prochainExport
+                   || !atomiqueLire(&resultatsModifies))) {
+            long attente = maintenant < prochainExport ? (long)(prochainExport - maintenant)
+                                                       : (long)exportPeriodeMs;
+            conditionAttendre(&cvPersistanceDemande, &csPersistance, attente);
+        }
+        unsigned long g       = generationDemandee;
+        int           travaux = travauxDemandes;
+        generationCommencee = g;
+        travauxDemandes     = 0;
+        sectionQuitter(&csPersistance);
+
+        if (atomiqueLire(&resultatsModifies) && reseauMaintenantMs() >= prochainExport)
+            travaux |= PERSISTER_EXPORT;
+        if (travaux & PERSISTER_EXPORT)
+            prochainExport = reseauMaintenantMs() + exportPeriodeMs;
+        int faits = persister(travaux);
+
+        sectionEntrer(&csPersistance);
+        if (faits & PERSISTER_INSTANTANE) {
+            generationReussie  = g;
+            sequenceInstantane = copieScrutin.sequence;
+        }
+        if (faits & PERSISTER_EXPORT) generationExportee = g;
+        generationTraitee = g;
+        conditionReveillerTout(&cvPersistanceFaite);
+        sectionQuitter(&csPersistance);
+    }
+}
+
+static void demarrerPersistance(void)
+{
+    const char *ms = getenv("PIVOTE_EXPORT_MS");
+
+    exportPeriodeMs = ms ? atoi(ms) : 0;
+    if (exportPeriodeMs <= 0) exportPeriodeMs = EXPORT_PERIODE_MS;
+    sectionInit(&csPersistance);
+    conditionInit(&cvPersistanceDemande);
+    conditionInit(&cvPersistanceFaite);
+    if (!threadLancer(threadPersistance, NULL)) return;   /* chaque demandeur ecrira lui-meme */
+    persistanceActive = 1;
+}
+
+/* Ajoute `travaux` a la prochaine ecriture ; rend sa generation (csPersistance tenue). */
+static unsigned long demanderPersistance(int travaux)
+{
+    /* Une demande dont la copie n'est pas prise couvre aussi celle-ci */
+    if (generationDemandee == generationCommencee) generationDemandee++;
+    travauxDemandes |= travaux;
+    conditionReveiller(&cvPersistanceDemande);
+    return generationDemandee;
+}
+
+/*
+ * Ecrit `travaux` a partir de l'etat au moment de l'appel et attend qu'ils
+ * soient faits. L'appelant ne tient ni verrouFichiers ni verrouDonnees.
+ * @return 1 si les travaux sont faits (pour un instantane : si un
+ *         instantane au moins aussi recent est en place), 0 sinon ou apres
+ *         l'arret.
+ */
+static int persisterEtAttendre(int travaux)
+{
+    int ok = 0;
+    sectionEntrer(&csPersistance);
+    if (persistanceArretee) {
+        /* fichiers supprimes : plus rien a ecrire */
+    } else if (!persistanceActive) {
+        int faits = persister(travaux);
+        if (faits & PERSISTER_INSTANTANE) sequenceInstantane = copieScrutin.sequence;
+        ok = faits == travaux;
     } else {
-        int nbGagnants = 0;
-        for (int i = 0; i < nbCandidats; i++)
-            if (candidats[i].voix == maxVoix) nbGagnants++;
-
-        if (nbGagnants == 1) {
-            for (int i = 0; i < nbCandidats; i++) {
-                if (candidats[i].voix == maxVoix)
-                    fprintf(f, "GAGNANT : %s avec %d voix\n",
-                            candidats[i].nom, maxVoix);
+        unsigned long g = demanderPersistance(travaux);
+        while (generationTraitee < g && !persistanceArretee)
+            conditionAttendre(&cvPersistanceFaite, &csPersistance, ATTENTE_INFINIE);
+        ok = generationTraitee >= g
+          && (!(travaux & PERSISTER_INSTANTANE) || generationReussie >= g)
+          && (!(travaux & PERSISTER_EXPORT) || generationExportee >= g);
+    }
+    sectionQuitter(&csPersistance);
+    return ok;
+}
+
+/* Attend la fin de l'ecriture en cours puis refuse les suivantes. */
+static void arreterPersistance(void)
+{
+    sectionEntrer(&csPersistance);
+    persistanceArretee = 1;
+    while (generationTraitee < generationCommencee)
+        conditionAttendre(&cvPersistanceFaite, &csPersistance, ATTENTE_INFINIE);
+    generationDemandee = generationCommencee;
+    conditionReveillerTout(&cvPersistanceFaite);
+    sectionQuitter(&csPersistance);
+}
+
+int sauvegarderDonnees(void)
+{
+    marquerResultats();   /* candidat ajoute, vote ouvert ou ferme... */
+    return persisterEtAttendre(PERSISTER_INSTANTANE);
+}
+
+/*
+ * Politique de synchronisation du journal : variable d'environnement
+ * PIVOTE_FSYNC = toujours (defaut), periodique ou jamais ; PIVOTE_FSYNC_MS
+ * fixe la periode (defaut JOURNAL_PERIODE_MS).
+ */
+static JournalSync politiqueJournal(int *periodeMs)
+{
+    const char *mode = getenv("PIVOTE_FSYNC");
+    const char *ms   = getenv("PIVOTE_FSYNC_MS");
+
+    *periodeMs = ms ? atoi(ms) : 0;
+    if (*periodeMs <= 0) *periodeMs = JOURNAL_PERIODE_MS;
+    if (mode && strcmp(mode, "periodique") == 0) return JOURNAL_SYNC_PERIODIQUE;
+    if (mode && strcmp(mode, "jamais") == 0)     return JOURNAL_SYNC_JAMAIS;
+    return JOURNAL_SYNC_TOUJOURS;
+}
+
+/* Rejoue un vote du journal comme un premier vote de l'electeur. */
+static void rejouerVote(const JournalVote *v, void *ctx)
+{
+    long *rejoues = (long *)ctx;
+    int   i       = (int)v->slot;
+
+    if (v->slot >= (unsigned int)electeurs.nb || !decompteReserver(electeurs.aVote, i))
+        return;   /* electeur inconnu de la base, ou vote deja compte */
+    int slot = v->idCandidat == JOURNAL_BLANC ? -1 : chercherCandidat(v->idCandidat);
+    decompteAjouter(slot);
+    electeurs.choix[i] = (short)slot;
+    if (slot < 0) decompteMarquer(electeurs.blanc, i);
+    (*rejoues)++;
+}
+
+/*
+ * Applicateur des votes : un seul thread compte les votes, les ajoute au
+ * journal et repond aux sessions. Une session valide son vote (electeur,
+ * candidat) sous le verrou partage, depose une DemandeVote dans une file
+ * bornee sans verrou (file_votes.h) et attend. L'applicateur retire les
+ * demandes par lots et, pour tout un lot :
+ *   - compte les votes sous un seul verrou partage, qui ne le protege que
+ *     d'un agrandissement des tables ou d'une copie d'instantane : il est
+ *     seul a compter des votes ;
+ *   - les ajoute au journal en une ecriture et une synchronisation ;
+ *   - publie le resultat de chaque demande et reveille ensemble les
+ *     sessions du lot.
+ * File pleine : la session attend une place et ne lit plus son socket
+ * pendant ce temps, ce qui ralentit le client (pression arriere).
+ *
+ * Les backends evenementiels ne bloquent jamais leur boucle : leurs
+ * demandes (VoteDiffere) sont allouees, et l'applicateur les range dans la
+ * file de fins de la boucle (session.h) au lieu de reveiller un
+ * demandeur. File pleine, elles attendent dans la file de fins, et
+ * l'applicateur signale les places liberees a chaque boucle.
+ *
+ * Reglages : PIVOTE_FILE_VOTES (demandes en file, defaut FILE_VOTES_MAX),
+ * PIVOTE_COMMIT_LOT (votes par lot, defaut COMMIT_LOT_MAX ; un lot de
+ * VOTEBATCH n'est jamais coupe) et PIVOTE_COMMIT_MS (attente des
+ * retardataires apres la premiere demande, defaut COMMIT_ATTENTE_MS). Le
+ * meme thread demande un instantane a l'ecrivain de fond tous les
+ * PIVOTE_INSTANTANE_VOTES votes journalises (defaut INSTANTANE_VOTES).
+ * Sans thread, chaque session traite sa demande elle-meme, sous csVotes.
+ */
+typedef struct {
+    int electeur;   /* slot dans electeurs               */
+    int candidat;   /* slot dans candidats[], -1 : blanc */
+    int rang;       /* dans la requete (bit de resultats) */
+} IntentionVote;
+
+typedef struct {
+    const IntentionVote *intentions;
+    int                  nb;
+    unsigned char       *resultats;   /* bit `rang` a 1 si compte ; NULL : vote seul */
+    int                  acceptes;
+    int                  etat;        /* 0 : en attente, 1 : fait, -1 : ecriture refusee */
+    SessionFins         *fins;        /* NULL : le demandeur attend (cvVoteFait) */
+} DemandeVote;
+
+/* Demande d'une boucle evenementielle : a elle jusqu'au depot, puis a l'applicateur */
+typedef struct VoteDiffere {
+    DemandeVote         d;            /* premier membre : l'applicateur ne voit qu'elle */
+    SessionVote         v;
+    struct VoteDiffere *attente;      /* file pleine : suivante a deposer  */
+    IntentionVote       intentions[];
+} VoteDiffere;
+
+struct SessionFins {
+    Section             cs;           /* protege fins                       */
+    SessionVote        *fins;         /* rangees par l'applicateur, derniere en tete */
+    int                 fd;           /* eventfd                            */
+    VoteDiffere        *attenteTete;  /* a la boucle seule : file pleine    */
+    VoteDiffere        *attenteQueue;
+    int                 reveil;       /* a la boucle seule : depot non signale */
+    SessionFins        *suivante;     /* finsInscrites, sous csVotes        */
+};
+
+static FileVotes          fileVotes;
+static Section   csVotes;
+static Condition cvVoteDemande;    /* applicateur, file vide          */
+static Condition cvVoteFait;
+static Condition cvVotePlace;      /* sessions, file pleine           */
+static volatile long      applicateurEndormi = 0;
+static volatile long      sessionsBloquees   = 0;
+static int                applicateurActif   = 0;
+static int                commitLotMax;
+static int                commitAttenteMs;
+static long               instantaneVotes;  /* votes journalises entre deux instantanes */
+static SessionFins       *finsInscrites = NULL;   /* a prevenir des places liberees */
+static int                journalPeriodique = 0;  /* PIVOTE_FSYNC=periodique */
+
+/* Enregistrement de journal du vote de l'electeur `i` pour le candidat `slot`. */
+static JournalVote voteJournal(int i, int slot)
+{
+    JournalVote v;
+    v.slot       = (unsigned int)i;
+    v.idCandidat = slot >= 0 ? candidats[slot].id : JOURNAL_BLANC;
+    v.horodatage = journalMaintenant();
+    return v;
+}
+
+/* Annule le vote de l'electeur `i` (ecriture refusee). */
+static void annulerVote(int i)
+{
+    decompteRetirer(electeurs.choix[i]);
+    electeurs.choix[i] = -1;
+    decompteLiberer(electeurs.blanc, i);
+    decompteLiberer(electeurs.aVote, i);
+}
+
+/*
+ * Instantane periodique, sans attendre son ecriture : le segment du journal
+ * qu'il couvre deviendra le precedent. Rien n'est demande tant qu'une
+ * ecriture est en attente ou en cours.
+ */
+static void instantanePeriodique(unsigned long long sequence)
+{
+    sectionEntrer(&csPersistance);
+    int du = !persistanceArretee && generationTraitee == generationDemandee
+          && sequence - sequenceInstantane >= (unsigned long long)instantaneVotes;
+    if (du && persistanceActive) demanderPersistance(PERSISTER_INSTANTANE);
+    sectionQuitter(&csPersistance);
+    if (du && !persistanceActive) persisterEtAttendre(PERSISTER_INSTANTANE);
+}
+
+/*
+ * Compte puis rend durables les votes des demandes `lot[0..nb[`
+ * (applicateur, ou session sous csVotes). Sans journal, les votes
+ * deviennent durables par un instantane (qui rouvre le journal) ; si
+ * celui-ci echoue aussi, ils sont annules.
+ * @param tampon Place pour tous les votes du lot.
+ * @return 1 si les votes comptes sont durables.
+ */
+static int appliquerDemandes(DemandeVote **lot, int nb, JournalVote *tampon)
+{
+    int                n        = 0;
+    unsigned long long sequence = 0;
+
+    verrouPartagePrendre(&verrouDonnees);
+    for (int k = 0; k < nb; k++) {
+        DemandeVote *d = lot[k];
+        d->acceptes = 0;
+        for (int j = 0; j < d->nb; j++) {
+            const IntentionVote *v = &d->intentions[j];
+            /* Un electeur present deux fois n'est compte qu'une fois */
+            if (!voteOuvert || !decompteReserver(electeurs.aVote, v->electeur)) continue;
+            decompteAjouter(v->candidat);   /* < 0 : vote blanc */
+            electeurs.choix[v->electeur] = (short)v->candidat;
+            if (v->candidat < 0) decompteMarquer(electeurs.blanc, v->electeur);
+            tampon[n++] = voteJournal(v->electeur, v->candidat);
+            if (d->resultats)
+                d->resultats[v->rang / 8] |= (unsigned char)(1u << (v->rang % 8));
+            d->acceptes++;
+        }
+    }
+    verrouPartageRendre(&verrouDonnees);
+    if (n == 0) return 1;
+
+    verrouExclusifPrendre(&verrouFichiers);
+    int ok   = journalActif() && journalAjouter(tampon, n);
+    sequence = journalSequence();
+    verrouExclusifRendre(&verrouFichiers);
+    marquerResultats();
+    if (ok) {
+        instantanePeriodique(sequence);
+        return 1;
+    }
+    if (persisterEtAttendre(PERSISTER_INSTANTANE)) return 1;
+
+    verrouExclusifPrendre(&verrouDonnees);
+    for (int m = 0; m < n; m++)
+        annulerVote((int)tampon[m].slot);
+    verrouExclusifRendre(&verrouDonnees);
+    return 0;
+}
+
+/* Rend la file de fins lisible. */
+static void finsSignaler(SessionFins *f)
+{
+#if defined(__linux__)
+    unsigned long long un = 1;
+    ssize_t            n  = write(f->fd, &un, sizeof(un));
+    (void)n;   /* compteur sature : deja lisible */
+#else
+    (void)f;
+#endif
+}
+
+/* Remet le compteur de la file de fins a zero. */
+static void finsVider(SessionFins *f)
+{
+#if defined(__linux__)
+    unsigned long long compte;
+    ssize_t            n = read(f->fd, &compte, sizeof(compte));
+    (void)n;   /* deja vide */
+#else
+    (void)f;
+#endif
+}
+
+/* Range une demande differee finie dans la file de fins de sa boucle. */
+static void finsRanger(DemandeVote *d, int ok)
+{
+    VoteDiffere *a = (VoteDiffere *)d;
+    SessionFins *f = d->fins;
+
+    a->v.acceptes = ok ? d->acceptes : -1;
+    if (!ok && a->v.resultats) memset(a->v.resultats, 0, ((size_t)a->v.nb + 7) / 8);
+    sectionEntrer(&f->cs);
+    int vide = f->fins == NULL;
+    a->v.suiv = f->fins;
+    f->fins   = &a->v;
+    sectionQuitter(&f->cs);
+    if (vide) finsSignaler(f);   /* sinon deja signalee, pas encore relevee */
+}
+
+/* Attend une demande au plus `ms` ; les sessions reveillent l'applicateur endormi. */
+static void attendreDemande(long ms)
+{
+    sectionEntrer(&csVotes);
+    atomiqueEchanger(&applicateurEndormi, 1);   /* barriere : avant de relire la file */
+    if (fileVotesProfondeur(&fileVotes) == 0)
+        conditionAttendre(&cvVoteDemande, &csVotes, ms);
+    atomiqueEchanger(&applicateurEndormi, 0);
+    sectionQuitter(&csVotes);
+}
+
+/*
+ * Applicateur inoccupe : force sur disque les votes que la periode de
+ * synchronisation a laisses en attente, faute de vote suivant pour le faire.
+ * @return Attente avant la prochaine echeance (ATTENTE_INFINIE : aucune).
+ */
+static long synchroniserJournal(void)
+{
+    if (!journalPeriodique) return ATTENTE_INFINIE;
+    verrouExclusifPrendre(&verrouFichiers);
+    long ms = journalSynchroniser();
+    verrouExclusifRendre(&verrouFichiers);
+    return ms < 0 ? ATTENTE_INFINIE : ms;
+}
+
+static void threadApplicateur(void *arg)
+{
+    DemandeVote **lot    = (DemandeVote **)malloc((size_t)commitLotMax * sizeof(DemandeVote *));
+    JournalVote  *tampon = NULL;
+    int           cap    = 0;
+    (void)arg;
+
+    if (!lot) return;
+    for (;;) {
+        /* Un lot : tout ce qui est en file, jusqu'a commitLotMax votes */
+        int       nb = 0, votes = 0;
+        long long fin = 0;
+        for (;;) {
+            int k = fileVotesRetirer(&fileVotes, (void **)lot + nb, commitLotMax - nb);
+            for (int j = nb; j < nb + k; j++) votes += lot[j]->nb;
+            nb += k;
+            if (k > 0 && fin == 0) fin = reseauMaintenantMs() + commitAttenteMs;
+            if (nb == commitLotMax || votes >= commitLotMax) break;
+            long long t = reseauMaintenantMs();
+            if (nb > 0 && t >= fin) break;
+            attendreDemande(nb > 0 ? (long)(fin - t) : synchroniserJournal());
+        }
+        barriereMemoire();   /* places liberees, avant de relire sessionsBloquees */
+        if (sessionsBloquees) {
+            sectionEntrer(&csVotes);
+            conditionReveillerTout(&cvVotePlace);
+            for (SessionFins *f = finsInscrites; f; f = f->suivante)
+                finsSignaler(f);
+            sectionQuitter(&csVotes);
+        }
+
+        int ok = 1;
+        if (votes > cap) {
+            JournalVote *t = (JournalVote *)realloc(tampon, (size_t)votes * sizeof(JournalVote));
+            if (t) {
+                tampon = t;
+                cap    = votes;
+            } else {
+                ok = 0;   /* lot refuse, sans rien compter */
             }
-        } else {
-            fprintf(f, "EGALITE entre les candidats suivants (%d voix chacun) :\n", maxVoix);
-            for (int i = 0; i < nbCandidats; i++)
-                if (candidats[i].voix == maxVoix)
-                    fprintf(f, "  - %s\n", candidats[i].nom);
         }
+        if (ok) ok = appliquerDemandes(lot, nb, tampon);
+
+        /* Les demandes vivent sur la pile des sessions, ou appartiennent a
+           leur boucle une fois rangees : plus rien n'y touche ensuite */
+        sectionEntrer(&csVotes);
+        for (int k = 0; k < nb; k++) {
+            if (lot[k]->fins) finsRanger(lot[k], ok);
+            else lot[k]->etat = ok ? 1 : -1;
+        }
+        conditionReveillerTout(&cvVoteFait);
+        sectionQuitter(&csVotes);
     }
+}
 
-    fprintf(f, "\n================================================\n");
-    fprintf(f, "           FIN DU RAPPORT\n");
-    fprintf(f, "================================================\n");
+static void demarrerApplicateur(void)
+{
+    const char *lot  = getenv("PIVOTE_COMMIT_LOT");
+    const char *ms   = getenv("PIVOTE_COMMIT_MS");
+    const char *inst = getenv("PIVOTE_INSTANTANE_VOTES");
+    const char *file = getenv("PIVOTE_FILE_VOTES");
+    long        capacite;
+
+    commitLotMax    = lot  ? atoi(lot)  : 0;
+    commitAttenteMs = ms   ? atoi(ms)   : COMMIT_ATTENTE_MS;
+    instantaneVotes = inst ? atol(inst) : 0;
+    capacite        = file ? atol(file) : 0;
+    if (commitLotMax <= 0) commitLotMax = COMMIT_LOT_MAX;
+    if (commitAttenteMs < 0) commitAttenteMs = 0;
+    if (instantaneVotes <= 0) instantaneVotes = INSTANTANE_VOTES;
+    if (capacite <= 0) capacite = FILE_VOTES_MAX;
+
+    sectionInit(&csVotes);
+    conditionInit(&cvVoteDemande);
+    conditionInit(&cvVoteFait);
+    conditionInit(&cvVotePlace);
+    if (!fileVotesInit(&fileVotes, (unsigned long)capacite)) return;
+    if (!threadLancer(threadApplicateur, NULL)) return;   /* chaque session traitera sa demande */
+    applicateurActif = 1;
+}
 
-    fclose(f);
-    printf("[INFO] Rapport final g\xe9n\xe9r\xe9 : %s\n", FICHIER_RAPPORT);
+/* Sans applicateur : le demandeur compte et ecrit lui-meme, sous csVotes. */
+static int appliquerSeul(DemandeVote *d)
+{
+    JournalVote *tampon = (JournalVote *)malloc((size_t)d->nb * sizeof(JournalVote));
+    sectionEntrer(&csVotes);
+    int ok = tampon && appliquerDemandes(&d, 1, tampon);
+    sectionQuitter(&csVotes);
+    free(tampon);
+    return ok;
 }
 
-/* =========================================================
- * 5. PERSISTANCE DES DONNEES
- * ========================================================= */
-void sauvegarderDonnees(void)
-{
-    FILE *f = fopen(FICHIER_SAUVEGARDE, "w");
-    if (!f) return;
-    fprintf(f, "%d\n%d\n", voteOuvert, nbElecteurs);
-    for (int i = 0; i < nbElecteurs; i++)
-        fprintf(f, "%d %s %d %d %s\n",
-                electeurs[i].id, electeurs[i].nom,
-                electeurs[i].a_vote, electeurs[i].vote_blanc,
-                electeurs[i].username);
-    fprintf(f, "%d\n", nbCandidats);
-    for (int i = 0; i < nbCandidats; i++)
-        fprintf(f, "%d %s %d\n",
-                candidats[i].id, candidats[i].nom, candidats[i].voix);
-    fclose(f);
+/* Apres un depot : reveille l'applicateur s'il dort. */
+static void reveillerApplicateur(void)
+{
+    barriereMemoire();   /* depot visible avant de relire applicateurEndormi */
+    if (!applicateurEndormi) return;
+    sectionEntrer(&csVotes);
+    conditionReveiller(&cvVoteDemande);
+    sectionQuitter(&csVotes);
 }
 
-void chargerDonnees(void)
+/*
+ * Fait compter et rendre durables les votes de `d`, et attend le resultat
+ * (d->etat, d->acceptes). L'appelant ne tient aucun verrou.
+ */
+static void soumettreDemande(DemandeVote *d)
+{
+    d->etat = 0;
+    d->fins = NULL;
+    if (!applicateurActif) {
+        d->etat = appliquerSeul(d) ? 1 : -1;
+        return;
+    }
+
+    if (!fileVotesDeposer(&fileVotes, d)) {
+        /* File pleine : attendre que l'applicateur libere des places */
+        sectionEntrer(&csVotes);
+        atomiqueIncrementer(&sessionsBloquees);
+        while (!fileVotesDeposer(&fileVotes, d))
+            conditionAttendre(&cvVotePlace, &csVotes, 1);
+        atomiqueDecrementer(&sessionsBloquees);
+        sectionQuitter(&csVotes);
+    }
+    barriereMemoire();   /* depot visible avant de relire applicateurEndormi */
+
+    sectionEntrer(&csVotes);
+    if (applicateurEndormi) conditionReveiller(&cvVoteDemande);
+    while (d->etat == 0)
+        conditionAttendre(&cvVoteFait, &csVotes, ATTENTE_INFINIE);
+    sectionQuitter(&csVotes);
+}
+
+/*
+ * Confie la demande differee `a` a l'applicateur sans attendre ; le
+ * resultat arrivera par la file de fins. File pleine, ou des demandes de
+ * la meme boucle attendent deja : elle attend son tour dans la file de fins.
+ */
+static SessionVote *soumettreDiffere(VoteDiffere *a)
+{
+    DemandeVote *d = &a->d;
+    SessionFins *f = d->fins;
+
+    if (d->nb == 0) {                       /* rien de valide : refus immediat */
+        finsRanger(d, 1);
+        return &a->v;
+    }
+    if (!applicateurActif) {
+        finsRanger(d, appliquerSeul(d));
+        return &a->v;
+    }
+    if (f->attenteTete || !fileVotesDeposer(&fileVotes, d)) {
+        /* Compte avant le nouvel essai : l'applicateur qui libere une place
+           voit le compte, ou l'essai voit la place */
+        atomiqueIncrementer(&sessionsBloquees);
+        if (f->attenteTete || !fileVotesDeposer(&fileVotes, d)) {
+            a->attente = NULL;
+            if (f->attenteQueue) f->attenteQueue->attente = a; else f->attenteTete = a;
+            f->attenteQueue = a;
+            return &a->v;
+        }
+        atomiqueDecrementer(&sessionsBloquees);
+    }
+    f->reveil = 1;   /* l'applicateur sera reveille par sessionFinsPublier */
+    return &a->v;
+}
+
+/* Demande differee de `nb` intentions ; `lot` : avec les bits de resultat. */
+static VoteDiffere *allouerDiffere(SessionFins *f, void *session, int nb, int lot)
+{
+    size_t       taille = sizeof(VoteDiffere) + (size_t)nb * sizeof(IntentionVote);
+    size_t       octets = lot ? ((size_t)nb + 7) / 8 : 0;
+    VoteDiffere *a      = (VoteDiffere *)malloc(taille + octets);
+
+    if (!a) return NULL;
+    memset(a, 0, sizeof(*a));
+    a->d.intentions = a->intentions;
+    a->d.fins       = f;
+    a->v.session    = session;
+    a->v.nb         = lot ? nb : 1;
+    if (lot) {
+        a->v.resultats = (unsigned char *)a + taille;
+        a->d.resultats = a->v.resultats;
+        memset(a->v.resultats, 0, octets);
+    }
+    return a;
+}
+
+SessionFins *sessionFinsCreer(void)
+{
+#if defined(__linux__)
+    SessionFins *f = (SessionFins *)calloc(1, sizeof(*f));
+    if (!f) return NULL;
+    f->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (f->fd < 0) {
+        free(f);
+        return NULL;
+    }
+    sectionInit(&f->cs);
+    sectionEntrer(&csVotes);
+    f->suivante   = finsInscrites;
+    finsInscrites = f;
+    sectionQuitter(&csVotes);
+    return f;
+#else
+    return NULL;   /* pas de boucle evenementielle : votes bloquants */
+#endif
+}
+
+int sessionFinsDescripteur(const SessionFins *f)
+{
+    return f->fd;
+}
+
+SessionVote *sessionFinsRelever(SessionFins *f)
+{
+    SessionVote *pile, *finis = NULL;
+    finsVider(f);   /* avant de relever : un rangement qui suit resignale */
+
+    /* Places liberees : depot dans l'ordre ; un vote abandonne n'est jamais compte */
+    while (f->attenteTete) {
+        VoteDiffere *a = f->attenteTete;
+        if (a->v.session && !fileVotesDeposer(&fileVotes, &a->d)) break;
+        f->attenteTete = a->attente;
+        if (!f->attenteTete) f->attenteQueue = NULL;
+        atomiqueDecrementer(&sessionsBloquees);
+        if (a->v.session) f->reveil = 1;
+        else free(a);
+    }
+
+    sectionEntrer(&f->cs);
+    pile    = f->fins;
+    f->fins = NULL;
+    sectionQuitter(&f->cs);
+
+    /* Pile : la derniere rangee en tete ; on la retourne */
+    while (pile) {
+        SessionVote *v = pile;
+        pile = v->suiv;
+        if (!v->session) {
+            sessionVoteLiberer(v);
+            continue;
+        }
+        v->fini = 1;
+        v->suiv = finis;
+        finis   = v;
+    }
+    return finis;
+}
+
+void sessionFinsPublier(SessionFins *f)
+{
+    if (!f->reveil) return;
+    f->reveil = 0;
+    reveillerApplicateur();
+}
+
+void sessionVoteLiberer(SessionVote *v)
+{
+    if (v) free((char *)v - offsetof(VoteDiffere, v));
+}
+
+/* Etat de la file des votes (statistiques, affichage temps reel). */
+static void afficherFileVotes(void)
+{
+    FileVotesMetriques m;
+    if (!applicateurActif) return;
+    fileVotesMetriques(&fileVotes, &m);
+    printf("File des votes : %llu / %llu en attente (max %llu) | %ld fois pleine | "
+           "%llu demandes en %llu lots\n",
+           m.profondeur, m.capacite, m.profondeurMax, m.pleins, m.deposes, m.lots);
+}
+
+/*
+ * Rejoue le journal sur la base chargee, a partir de la sequence `depuis`,
+ * puis l'ouvre pour les votes a venir. Avec une `base`, un journal
+ * illisible, ou qui ne reprend pas la ou elle s'arrete, laisserait un
+ * decompte faux : le demarrage est refuse et le journal conserve.
+ */
+static void ouvrirJournal(unsigned long long depuis, int base)
+{
+    int         periodeMs;
+    JournalSync sync    = politiqueJournal(&periodeMs);
+    long        rejoues = 0;
+    long        lus     = journalOuvrir(FICHIER_JOURNAL, depuis, sync, periodeMs,
+                                        rejouerVote, &rejoues);
+
+    if (lus < 0 && base) {
+        printf("[ERREUR] Journal %s illisible, ou commen\xe7" "ant apr\xe8s la base charg\xe9" "e "
+               "(segment %s perdu) : d\xe9marrage refus\xe9.\n"
+               "         Le journal est conserv\xe9 ; restaurez-le avant de relancer.\n",
+               FICHIER_JOURNAL, FICHIER_JOURNAL JOURNAL_SUFFIXE_PREC);
+        exit(EXIT_FAILURE);
+    }
+    if (lus < 0) {
+        printf("[ATTENTION] Journal %s indisponible, sauvegarde compl\xe8te \xe0 chaque vote.\n",
+               FICHIER_JOURNAL);
+        return;
+    }
+    journalPeriodique = sync == JOURNAL_SYNC_PERIODIQUE;
+    if (rejoues > 0)
+        printf(">> %ld vote(s) r\xe9" "cup\xe9r\xe9(s) depuis le journal.\n", rejoues);
+}
+
+/* Ancienne sauvegarde texte (avant les instantanes) ; 0 si absente. */
+static int chargerTexte(void)
 {
     FILE *f = fopen(FICHIER_SAUVEGARDE, "r");
-    if (!f) return;
+    char  nom[50], login[AUTH_MAX_USERNAME + 1];
+    int   nb = 0, id, aVote, blanc, voix;
+    if (!f) return 0;
     fscanf(f, "%d", &voteOuvert);
-    fscanf(f, "%d", &nbElecteurs);
-    for (int i = 0; i < nbElecteurs; i++)
-        fscanf(f, "%d %s %d %d %s",
-               &electeurs[i].id, electeurs[i].nom,
-               &electeurs[i].a_vote, &electeurs[i].vote_blanc,
-               electeurs[i].username);
+    fscanf(f, "%d", &nb);
+    tableElecteursTronquer(&electeurs, 0);
+    for (int i = 0; i < nb; i++) {
+        if (fscanf(f, "%d %49s %d %d %64s", &id, nom, &aVote, &blanc, login) != 5)
+            break;
+        int slot = tableElecteursAjouter(&electeurs, id, nom, login);
+        if (slot < 0) break;
+        if (aVote) decompteMarquer(electeurs.aVote, slot);
+        if (blanc) decompteMarquer(electeurs.blanc, slot);
+    }
     fscanf(f, "%d", &nbCandidats);
-    for (int i = 0; i < nbCandidats; i++)
-        fscanf(f, "%d %s %d",
-               &candidats[i].id, candidats[i].nom, &candidats[i].voix);
+    if (nbCandidats < 0 || nbCandidats > MAX_CANDIDATS) nbCandidats = 0;
+    for (int i = 0; i < nbCandidats; i++) {
+        voix = 0;
+        fscanf(f, "%d %s %d", &candidats[i].id, candidats[i].nom, &voix);
+        decompteFixer(i, voix);
+    }
     fclose(f);
-    printf(">> Donn\xe9es charg\xe9es.\n");
+    return 1;
+}
+
+/* Dernier instantane valide ; 0 s'il n'y en a pas. */
+static int chargerInstantane(unsigned long long *sequence)
+{
+    static InstantaneScrutin s;   /* au demarrage, un seul thread */
+    int r = instantaneCharger(FICHIER_INSTANTANE, &s, &electeurs);
+    if (r < 0) {
+        printf("[ERREUR] M\xe9moire insuffisante pour charger %s.\n", FICHIER_INSTANTANE);
+        exit(EXIT_FAILURE);   /* repartir d'une base vide perdrait le scrutin */
+    }
+    if (r == 0) return 0;
+
+    voteOuvert  = s.voteOuvert;
+    nbCandidats = s.nbCandidats;
+    for (int i = 0; i < nbCandidats; i++) {
+        candidats[i].id = s.idCandidat[i];
+        memcpy(candidats[i].nom, s.nomCandidat[i], INSTANTANE_NOM);
+        decompteFixer(i, s.voix[i]);
+    }
+    *sequence = sequenceInstantane = s.sequence;
+    return 1;
+}
+
+/*
+ * Ancienne base reprise : des que le premier instantane la remplace, elle
+ * est mise de cote (FICHIER_SAUVEGARDE SAUVEGARDE_SUFFIXE_MIGREE), pour ne
+ * plus jamais servir de base au journal, dont les segments suivants sont
+ * relatifs aux instantanes.
+ */
+static void migrerTexte(void)
+{
+    if (!sauvegarderDonnees()) {
+        printf("[ATTENTION] Premier instantan\xe9 impossible, %s reste la base.\n",
+               FICHIER_SAUVEGARDE);
+        return;
+    }
+    if (fichierRemplacer(FICHIER_SAUVEGARDE, FICHIER_SAUVEGARDE SAUVEGARDE_SUFFIXE_MIGREE))
+        printf(">> %s remplac\xe9 par %s (ancienne base : %s).\n", FICHIER_SAUVEGARDE,
+               FICHIER_INSTANTANE, FICHIER_SAUVEGARDE SAUVEGARDE_SUFFIXE_MIGREE);
+    else
+        remove(FICHIER_SAUVEGARDE);   /* l'instantane, present, prime de toute facon */
+}
+
+void chargerDonnees(void)
+{
+    unsigned long long depuis = 0;
+    int                texte  = 0;
+
+    demarrerPersistance();
+
+    int base = chargerInstantane(&depuis);
+    if (!base) {
+        if (instantanePresent(FICHIER_INSTANTANE)) {
+            /* Rejouer le journal sur une autre base perdrait ou deplacerait des votes */
+            printf("[ERREUR] %s et %s sont illisibles ou corrompus : d\xe9marrage refus\xe9.\n"
+                   "         Le journal %s est conserv\xe9 ; restaurez un instantan\xe9 "
+                   "avant de relancer.\n",
+                   FICHIER_INSTANTANE, FICHIER_INSTANTANE INSTANTANE_SUFFIXE_PREC,
+                   FICHIER_JOURNAL);
+            exit(EXIT_FAILURE);
+        }
+        base = texte = chargerTexte();   /* jamais d'instantane : ancienne base texte */
+    }
+    if (!base) {
+        /* Pas de base : un journal restant ne designe aucun electeur connu */
+        remove(FICHIER_JOURNAL);
+        remove(FICHIER_JOURNAL JOURNAL_SUFFIXE_PREC);
+        ouvrirJournal(0, 0);
+        demarrerApplicateur();
+        publierListeCandidats();   /* bulletin vide */
+        return;
+    }
+    decompteFixerBulletins(decompteCompter(electeurs.aVote, electeurs.nb),
+                           decompteCompter(electeurs.blanc, electeurs.nb));
+    reconstruireIndex();
+    ouvrirJournal(texte ? JOURNAL_DEPUIS_DEBUT : depuis, 1);
+    demarrerApplicateur();
+    publierListeCandidats();
+    if (texte) migrerTexte();
+    printf(">> Donn\xe9" "es charg\xe9" "es.\n");
 }
 
 void exporterVersExcel(void)
 {
-    FILE *f = fopen(FICHIER_EXCEL, "w");
-    if (!f) return;
-    fprintf(f, "ID Candidat;Nom Candidat;Nombre de Voix\n");
-    for (int i = 0; i < nbCandidats; i++)
-        fprintf(f, "%d;%s;%d\n",
-                candidats[i].id, candidats[i].nom, candidats[i].voix);
-    int blancs = 0;
-    for (int i = 0; i < nbElecteurs; i++)
-        if (electeurs[i].vote_blanc) blancs++;
-    fprintf(f, "0;VOTE BLANC;%d\n", blancs);
-    fclose(f);
+    persisterEtAttendre(PERSISTER_EXPORT);
+}
+
+/*
+ * genererRapportFinal()
+ * ----------------------
+ * Fait ecrire tout de suite les exports (rapport_final.txt, CSV, JSON) par
+ * l'ecrivain de fond, a partir d'une meme copie du decompte : voir
+ * ecrireExports().
+ */
+void genererRapportFinal(void)
+{
+    if (persisterEtAttendre(PERSISTER_EXPORT))
+        printf("[INFO] Rapport final g\xe9n\xe9r\xe9 : %s\n", FICHIER_RAPPORT);
+    else
+        printf("[ERREUR] Impossible de creer le rapport final.\n");
 }
 
 /* =========================================================
- * 6. SERVEUR RESEAU (threads Windows)
+ * 6. SERVEUR RESEAU (pool de threads, epoll, io_uring)
  * ========================================================= */
-DWORD WINAPI threadServeurReseau(LPVOID arg)
+/*
+ * Pool de workers :
+ * le thread d'ecoute ne fait qu'accepter les connexions et les depose
+ * dans une file bornee ; chaque worker sert un client de bout en bout
+ * (AUTH, liste, VOTE). Un votant lent a son kiosque n'immobilise plus
+ * que son worker, pas tout le bureau de vote.
+ */
+static Socket             fileClients[FILE_CLIENTS];
+static int                fileTete = 0;
+static int                fileNb   = 0;
+static Section   csFile;
+static Condition cvNonVide;
+static Condition cvNonPleine;
+
+/*
+ * Taille du pool : nbWorkersReseau si > 0, sinon la variable
+ * d'environnement PIVOTE_WORKERS, sinon 4 workers par coeur (les workers
+ * attendent surtout la saisie des votants, pas le processeur).
+ */
+static int taillePoolReseau(void)
+{
+    int n = nbWorkersReseau;
+    if (n <= 0) {
+        const char *env = getenv("PIVOTE_WORKERS");
+        if (env) n = atoi(env);
+    }
+    if (n <= 0) {
+        n = 4 * nbProcesseurs();
+        if (n < NB_WORKERS_MIN) n = NB_WORKERS_MIN;
+    }
+    if (n > NB_WORKERS_MAX) n = NB_WORKERS_MAX;
+    return n;
+}
+
+static void deposerClient(Socket client)
+{
+    sectionEntrer(&csFile);
+    while (fileNb == FILE_CLIENTS)
+        conditionAttendre(&cvNonPleine, &csFile, ATTENTE_INFINIE);
+    fileClients[(fileTete + fileNb) % FILE_CLIENTS] = client;
+    fileNb++;
+    conditionReveiller(&cvNonVide);
+    sectionQuitter(&csFile);
+}
+
+static Socket retirerClient(void)
+{
+    sectionEntrer(&csFile);
+    while (fileNb == 0)
+        conditionAttendre(&cvNonVide, &csFile, ATTENTE_INFINIE);
+    Socket client = fileClients[fileTete];
+    fileTete = (fileTete + 1) % FILE_CLIENTS;
+    fileNb--;
+    conditionReveiller(&cvNonPleine);
+    sectionQuitter(&csFile);
+    return client;
+}
+
+/*
+ * Etapes de session (session.h) :
+ * utilisees par tous les backends, via reseau_commun.c.
+ */
+ProfilSession sessionVerifierCompte(const char *username, const char *password)
+{
+    AuthUser uAuth;
+    AuthStatus stAuth = auth_authenticate(CSV_PATH, username, password, &uAuth);
+    if (stAuth != AUTH_OK) return PROFIL_REFUSE;
+    if (strcmp(uAuth.role, "votant") == 0) return PROFIL_VOTANT;
+    if (strcmp(uAuth.role, ROLE_AGREGATEUR) == 0) return PROFIL_AGREGATEUR;
+    if (strcmp(uAuth.role, ROLE_OBSERVATEUR) == 0) return PROFIL_OBSERVATEUR;
+    return PROFIL_REFUSE;
+}
+
+int sessionAuthentifier(const char *requete, char *username)
+{
+    char cmd[16];
+    char password[AUTH_MAX_PASSWORD + 1];
+    int  parsed = sscanf(requete, "%15s %64s %64s", cmd, username, password);
+
+    if (parsed != 3 || strcmp(cmd, "AUTH") != 0)
+        return 0;
+    return sessionVerifierCompte(username, password) == PROFIL_VOTANT;
+}
+
+/*
+ * Bulletin partage : listeCourante tient sa propre reference ; chaque
+ * session en prend une le temps d'envoyer la liste. Une nouvelle
+ * publication remplace le pointeur, l'ancien bulletin est libere par la
+ * derniere session qui le rend.
+ */
+static Verrou         verrouListe   = VERROU_INIT;
+static ListeCandidats *listeCourante = NULL;
+static volatile long   versionListe  = 0;
+
+void publierListeCandidats(void)
+{
+    static const char *entete = "\n--- LISTE DES CANDIDATS ---\n";
+    static const char *pied   = "[0] VOTE BLANC\n---------------------------\n";
+    ProtoTampon texte = {0}, trame = {0};
+    char        ligne[80];
+    size_t      debut;
+    long        version = atomiqueIncrementer(&versionListe);
+
+    /* Une seule passe lineaire, dans des tampons extensibles */
+    int ok = protoTamponAjouter(&texte, entete, strlen(entete))
+          && protoOuvrir(&trame, PROTO_CANDIDATS, &debut)
+          && protoAjouterI32(&trame, version);
+    verrouPartagePrendre(&verrouDonnees);
+    for (int k = 0; k < nbCandidats && ok; k++) {
+        int n = snprintf(ligne, sizeof(ligne), "[%d] %s\n", candidats[k].id, candidats[k].nom);
+        ok = protoTamponAjouter(&texte, ligne, (size_t)n)
+          && protoAjouterI32(&trame, candidats[k].id)
+          && protoAjouterChaine(&trame, candidats[k].nom);
+    }
+    verrouPartageRendre(&verrouDonnees);
+    ok = ok && protoTamponAjouter(&texte, pied, strlen(pied));
+
+    /* Un seul bloc : en-tete, texte puis trame */
+    ListeCandidats *l = NULL;
+    if (ok) {
+        protoFermer(&trame, debut);
+        l = (ListeCandidats *)malloc(sizeof(*l) + texte.fin + trame.fin);
+    }
+    if (l) {
+        char *p = (char *)(l + 1);
+        memcpy(p, texte.data, texte.fin);
+        memcpy(p + texte.fin, trame.data, trame.fin);
+        l->version  = (unsigned long)version;
+        l->texte    = p;
+        l->lenTexte = texte.fin;
+        l->trame    = (const unsigned char *)(p + texte.fin);
+        l->lenTrame = trame.fin;
+        l->refs     = 1;
+    }
+    protoTamponLiberer(&texte);
+    protoTamponLiberer(&trame);
+    if (!l) return;   /* memoire insuffisante : l'ancien bulletin reste servi */
+
+    verrouExclusifPrendre(&verrouListe);
+    ListeCandidats *ancienne = listeCourante;
+    if (ancienne && ancienne->version > l->version) {
+        ancienne = l;                 /* publication concurrente plus recente */
+    } else {
+        listeCourante = l;
+    }
+    verrouExclusifRendre(&verrouListe);
+    sessionRendreListe(ancienne);
+}
+
+const ListeCandidats *sessionPrendreListe(void)
+{
+    verrouPartagePrendre(&verrouListe);
+    ListeCandidats *l = listeCourante;
+    if (l) atomiqueIncrementer((volatile long *)&l->refs);
+    verrouPartageRendre(&verrouListe);
+    return l;
+}
+
+void sessionRendreListe(const ListeCandidats *liste)
+{
+    ListeCandidats *l = (ListeCandidats *)liste;
+    if (l && atomiqueDecrementer((volatile long *)&l->refs) == 0)
+        free(l);
+}
+
+/*
+ * Controle le vote de l'electeur `idE` (compte `username`) pour `idC`.
+ * @return 1 si `v` est a soumettre, 0 si le vote est refuse.
+ */
+static int validerVote(const char *username, int idE, int idC, IntentionVote *v)
+{
+    int i;
+
+    verrouPartagePrendre(&verrouDonnees);
+    i = voteOuvert ? chercherElecteurLogin(username) : -1;
+    if (i >= 0 && (electeurs.id[i] != idE || decompteBit(electeurs.aVote, i))) i = -1;
+    v->electeur = i;
+    v->candidat = i >= 0 ? chercherCandidat(idC) : -1;   /* < 0 : vote blanc */
+    v->rang     = 0;
+    verrouPartageRendre(&verrouDonnees);
+    return i >= 0;
+}
+
+/* Controle un lot d'agregateur ; rend le nombre d'intentions ecrites dans `iv`. */
+static int validerLot(const ProtoVote *votes, int nb, IntentionVote *iv)
+{
+    int n = 0;
+
+    verrouPartagePrendre(&verrouDonnees);
+    for (int k = 0; k < nb && voteOuvert; k++) {
+        int i = chercherElecteur(votes[k].idElecteur);
+        if (i < 0 || decompteBit(electeurs.aVote, i)) continue;
+        iv[n].electeur = i;
+        iv[n].candidat = chercherCandidat(votes[k].idCandidat);
+        iv[n].rang     = k;
+        n++;
+    }
+    verrouPartageRendre(&verrouDonnees);
+    return n;
+}
+
+int sessionEnregistrerVote(const char *username, int idE, int idC)
+{
+    IntentionVote v;
+    DemandeVote   d;
+
+    /* Validation ; le vote lui-meme est compte par l'applicateur */
+    if (!validerVote(username, idE, idC, &v)) return 0;
+
+    /* Un seul des votes concurrents de cet electeur est compte */
+    d.intentions = &v;
+    d.nb         = 1;
+    d.resultats  = NULL;
+    soumettreDemande(&d);
+    return d.etat > 0 && d.acceptes == 1;
+}
+
+int sessionVoterLot(const ProtoVote *votes, int nb, unsigned char *resultats)
 {
-    WSADATA wsa;
-    SOCKET  serveur, client;
+    IntentionVote *iv = (IntentionVote *)malloc((size_t)nb * sizeof(IntentionVote));
+    DemandeVote    d;
+    int            n;
+
+    memset(resultats, 0, ((size_t)nb + 7) / 8);
+    if (!iv) return -1;
+    n = validerLot(votes, nb, iv);
+
+    /* Une seule demande : le lot est compte et ecrit d'un bloc ; si
+       l'ecriture echoue, rien n'est garde */
+    int acceptes = 0;
+    if (n > 0) {
+        d.intentions = iv;
+        d.nb         = n;
+        d.resultats  = resultats;
+        soumettreDemande(&d);
+        acceptes = d.etat > 0 ? d.acceptes : -1;
+        if (acceptes < 0) memset(resultats, 0, ((size_t)nb + 7) / 8);
+    }
+    free(iv);
+    return acceptes;
+}
+
+SessionVote *sessionSoumettreVote(SessionFins *f, void *session, const char *username,
+                                  int idE, int idC)
+{
+    VoteDiffere *a = allouerDiffere(f, session, 1, 0);
+    if (!a) return NULL;
+    a->d.nb = validerVote(username, idE, idC, &a->intentions[0]);
+    return soumettreDiffere(a);
+}
+
+SessionVote *sessionSoumettreLot(SessionFins *f, void *session, const ProtoVote *votes, int nb)
+{
+    VoteDiffere *a = allouerDiffere(f, session, nb, 1);
+    if (!a) return NULL;
+    a->d.nb = validerLot(votes, nb, a->intentions);
+    return soumettreDiffere(a);
+}
+
+void sessionLireResultats(SessionResultats *r)
+{
+    DecompteAgregats a;
+
+    verrouPartagePrendre(&verrouDonnees);
+    decompteAgreger(nbCandidats, &a);
+    r->voteOuvert = voteOuvert;
+    r->inscrits   = electeurs.nb;
+    for (int i = 0; i < a.nbCandidats; i++) {
+        r->voix[i].idCandidat = candidats[i].id;
+        r->voix[i].voix       = a.voix[i];
+    }
+    verrouPartageRendre(&verrouDonnees);
+    r->votants     = a.votants;
+    r->blancs      = a.blancs;
+    r->nbCandidats = a.nbCandidats;
+}
+
+int sessionLireVote(const char *requete, int *idE, int *idC)
+{
+    char cmd[16] = "";
+    *idE = *idC = -1;
+    sscanf(requete, "%15s %d %d", cmd, idE, idC);
+    return strcmp(cmd, "VOTE") == 0;
+}
+
+int sessionVoter(const char *username, const char *requete)
+{
+    int idE, idC;
+    if (!sessionLireVote(requete, &idE, &idC)) return 0;
+    return sessionEnregistrerVote(username, idE, idC);
+}
+
+/*
+ * Session complete d'un votant ; le socket est ferme par l'appelant, sauf
+ * s'il est confie a la diffusion (observateur abonne : renvoie 1).
+ * Meme machine a etats que les backends Linux (texte ou trames) ; les
+ * send() bloquants partent en entier, la liste est donc deja envoyee
+ * quand on repasse en attente du vote.
+ */
+static int traiterClient(Socket client)
+{
+    char          buffer[BUFFER];
+    SessionReseau s;
+    Reponse       rep[2];
+
+    memset(&s, 0, sizeof(s));
+    s.etat = ATTENTE_AUTH;
+    while (s.etat != TERMINEE && s.etat != ABONNEE) {
+        int recv_size = recv(client, buffer, BUFFER, 0);
+        if (recv_size <= 0 || !reseauAjouterEntree(&s, buffer, (size_t)recv_size))
+            break;
+
+        while (reseauEntreeDisponible(&s)) {
+            int nb = reseauTraiterMessage(&s, rep);
+            if (nb < 0) {
+                s.etat = TERMINEE;
+                break;
+            }
+            for (int i = 0; i < nb; i++)
+                send(client, rep[i].data, (int)rep[i].len, 0);
+            if (s.etat == LISTE_ENVOYEE) reseauListeEnvoyee(&s);
+        }
+    }
+    reseauLibererSession(&s);
+    return s.etat == ABONNEE && diffusionAbonner(client, s.periodeMs);
+}
+
+static void threadWorkerReseau(void *arg)
+{
+    (void)arg;
+    while (1) {
+        Socket client = retirerClient();
+        if (!traiterClient(client)) socketFermer(client);
+    }
+}
+
+/* Pool de workers : ecoute et depose les connexions, jusqu'a une erreur. */
+static void servirPool(void)
+{
+    Socket serveur, client;
     struct sockaddr_in addr;
-    char   buffer[BUFFER];
-    char   listeCandidatsStr[BUFFER];
-    int    addrlen = sizeof(addr);
 
-    WSAStartup(MAKEWORD(2,2), &wsa);
+    if (!socketsInit()) {
+        printf("[ERREUR] Initialisation des sockets \xe9" "chou\xe9" "e.\n");
+        return;
+    }
     serveur = socket(AF_INET, SOCK_STREAM, 0);
 
+    memset(&addr, 0, sizeof(addr));
     addr.sin_family      = AF_INET;
     addr.sin_addr.s_addr = INADDR_ANY;
     addr.sin_port        = htons(PORT);
 
-    if (bind(serveur, (struct sockaddr*)&addr, sizeof(addr)) == SOCKET_ERROR) {
+    if (serveur == SOCKET_INVALIDE
+        || bind(serveur, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
         printf("[ERREUR] Impossible de lier le port %d.\n", PORT);
-        return 1;
+        return;
     }
-    listen(serveur, 5);
-    printf(">> Serveur r\xe9seau ACTIF sur le port %d.\n", PORT);
+    listen(serveur, SOMAXCONN);
+
+    sectionInit(&csFile);
+    conditionInit(&cvNonVide);
+    conditionInit(&cvNonPleine);
+
+    int nbWorkers = 0;
+    int demandes  = taillePoolReseau();
+    for (int k = 0; k < demandes; k++) {
+        if (!threadLancer(threadWorkerReseau, NULL)) break;
+        nbWorkers++;
+    }
+    if (nbWorkers == 0) {
+        printf("[ERREUR] Aucun worker r\xe9seau n'a pu \xea" "tre cr\xe9\xe9.\n");
+        socketFermer(serveur);
+        return;
+    }
+    printf(">> Serveur r\xe9seau ACTIF sur le port %d (%d workers).\n", PORT, nbWorkers);
 
     while (1) {
-        client = accept(serveur, (struct sockaddr*)&addr, &addrlen);
-        if (client == INVALID_SOCKET) continue;
-
-        /* Etape 1 : Authentification */
-        int recv_size = recv(client, buffer, BUFFER - 1, 0);
-        if (recv_size <= 0) { closesocket(client); continue; }
-        buffer[recv_size] = '\0';
-
-        char cmd[16];
-        char username[AUTH_MAX_USERNAME + 1];
-        char password[AUTH_MAX_PASSWORD + 1];
-        int  parsed = sscanf(buffer, "%15s %64s %64s", cmd, username, password);
-
-        if (parsed != 3 || strcmp(cmd, "AUTH") != 0) {
-            send(client, "AUTH_FAIL", 9, 0);
-            closesocket(client);
-            continue;
-        }
+        client = accept(serveur, NULL, NULL);
+        if (client == SOCKET_INVALIDE) continue;
 
-        AuthUser uAuth;
-        AuthStatus stAuth = auth_authenticate(CSV_PATH, username, password, &uAuth);
-        if (stAuth != AUTH_OK || strcmp(uAuth.role, "votant") != 0) {
-            send(client, "AUTH_FAIL", 9, 0);
-            closesocket(client);
-            continue;
-        }
-        send(client, "AUTH_OK", 7, 0);
-
-        /* Etape 2 : Envoi liste candidats */
-        strcpy(listeCandidatsStr, "\n--- LISTE DES CANDIDATS ---\n");
-        char ligne[100];
-        for (int k = 0; k < nbCandidats; k++) {
-            sprintf(ligne, "[%d] %s\n", candidats[k].id, candidats[k].nom);
-            strcat(listeCandidatsStr, ligne);
-        }
-        strcat(listeCandidatsStr, "[0] VOTE BLANC\n---------------------------\n");
-        send(client, listeCandidatsStr, strlen(listeCandidatsStr), 0);
-
-        /* Etape 3 : Reception du vote */
-        recv_size = recv(client, buffer, BUFFER - 1, 0);
-        if (recv_size <= 0) { closesocket(client); continue; }
-        buffer[recv_size] = '\0';
-
-        char cmd2[16];
-        int  idE = -1, idC = -1;
-        sscanf(buffer, "%15s %d %d", cmd2, &idE, &idC);
-
-        int ok = 0;
-        if (strcmp(cmd2, "VOTE") == 0 && voteOuvert) {
-            for (int i = 0; i < nbElecteurs; i++) {
-                if (electeurs[i].id == idE
-                    && strcmp(electeurs[i].username, username) == 0
-                    && electeurs[i].a_vote == 0)
-                {
-                    int candidatTrouve = 0;
-                    for (int j = 0; j < nbCandidats; j++) {
-                        if (candidats[j].id == idC) {
-                            candidats[j].voix++;
-                            candidatTrouve = 1;
-                            break;
-                        }
-                    }
-                    electeurs[i].vote_blanc = candidatTrouve ? 0 : 1;
-                    electeurs[i].a_vote = 1;
-                    ok = 1;
-                    break;
-                }
-            }
-        }
+        /* Un kiosque abandonne libere son worker au bout du delai */
+        socketDelaiReception(client, DELAI_CLIENT_MS);
+        deposerClient(client);
+    }
+}
 
-        if (ok) {
-            send(client, "OK", 2, 0);
-            sauvegarderDonnees();
-            exporterVersExcel();
-        } else {
-            send(client, "ERREUR", 6, 0);
-        }
-        closesocket(client);
+void threadServeurReseau(void *arg)
+{
+    (void)arg;
+#if defined(__linux__)
+    /*
+     * Sous Linux : un seul thread sert toutes les sessions, avec io_uring
+     * si le noyau le permet, sinon epoll (PIVOTE_RESEAU=epoll pour forcer,
+     * PIVOTE_RESEAU=threads pour le pool de workers des autres systemes).
+     */
+    const char *mode = getenv("PIVOTE_RESEAU");
+    int r = -1;
+    if (mode && strcmp(mode, "threads") == 0) {
+        servirPool();
+        return;
     }
-    return 0;
+    if (!mode || strcmp(mode, "epoll") != 0)
+        r = serveurUring(PORT, RESEAU_MAX_CONNEXIONS, DELAI_CLIENT_MS);
+    if (r < 0)
+        serveurEpoll(PORT, RESEAU_MAX_CONNEXIONS, DELAI_CLIENT_MS);
+#else
+    servirPool();
+#endif
 }
 
-DWORD WINAPI threadAffichageTempsReel(LPVOID arg)
+void threadAffichageTempsReel(void *arg)
 {
+    (void)arg;
     while (affichageAutoActif) {
-        system("cls");
+        consoleEffacer();
         printf("===== CONTROLE EN TEMPS REEL =====\n");
         afficherBarresASCII();
         printf("\n");
         afficherStatistiques();
+        afficherFileVotes();
+        printf("Observateurs abonn\xe9s : %d\n", diffusionNbAbonnes());
         printf("\n[INFO] Fichier Excel mis \xe0 jour automatiquement.\n");
         printf("Appuie sur une touche du menu pour quitter...\n");
-        Sleep(3000);
+        dormirMs(3000);
     }
-    return 0;
+}
+
+/* Diffusion des resultats aux observateurs (PIVOTE_DIFFUSION_MS : periode). */
+static void demarrerDiffusion(void)
+{
+    const char *ms = getenv("PIVOTE_DIFFUSION_MS");
+    int periodeMs = ms ? atoi(ms) : 0;
+
+    if (periodeMs <= 0) periodeMs = DIFFUSION_PERIODE_MS;
+    if (!diffusionDemarrer(periodeMs))
+        printf("[ERREUR] Diffusion des r\xe9sultats indisponible.\n");
 }
 
 void lancerServeurReseau(void)
 {
-    HANDLE thread = CreateThread(NULL, 0, threadServeurReseau, NULL, 0, NULL);
-    if (!thread) {
+    demarrerDiffusion();
+    if (!threadLancer(threadServeurReseau, NULL)) {
         printf("Erreur thread r\xe9seau.\n");
         return;
     }
     affichageAutoActif = 1;
-    CreateThread(NULL, 0, threadAffichageTempsReel, NULL, 0, NULL);
+    threadLancer(threadAffichageTempsReel, NULL);
     printf("Mode r\xe9seau actif. Appuyez sur 0 pour quitter proprement.\n");
 }
 
@@ -627,7 +2306,7 @@ void menu_inscription_admin(void)
 
     lire_ligne_srv("Identifiant : ", username, sizeof(username));
     lire_ligne_srv("Mot de passe : ", password, sizeof(password));
-    lire_ligne_srv("Role (votant/admin) : ", role, sizeof(role));
+    lire_ligne_srv("Role (votant/" ROLE_AGREGATEUR "/" ROLE_OBSERVATEUR "/admin) : ", role, sizeof(role));
 
     AuthStatus st = auth_register_user(CSV_PATH, username, password, role);
     if (st == AUTH_OK)
@@ -665,7 +2344,7 @@ void menu_reinitialiser_mdp(void)
     char new_password[AUTH_MAX_PASSWORD + 1];
 
     printf("\n[REINITIALISATION MOT DE PASSE]\n");
-    printf("R\xe9serv\xe9e \xe0 l'administrateur (sans contr\xf4le de l'ancien mdp).\n\n");
+    printf("R\xe9serv\xe9" "e \xe0 l'administrateur (sans contr\xf4le de l'ancien mdp).\n\n");
 
     lire_ligne_srv("Identifiant de l'\xe9lecteur : ", username, sizeof(username));
     lire_ligne_srv("Nouveau mot de passe       : ", new_password, sizeof(new_password));
@@ -715,7 +2394,7 @@ void menu_lister(void)
 void afficherMenuGestionNavigue(int sel)
 {
     const char *options[] = {
-        "1. Cr\xe9er un compte (admin/autre)",
+        "1. Cr\xe9" "er un compte (admin/autre)",
         "2. Changer un mot de passe",
         "3. Activer un compte",
         "4. D\xe9sactiver un compte",
@@ -725,7 +2404,7 @@ void afficherMenuGestionNavigue(int sel)
     };
     int nbOptions = 7;
 
-    system("cls");
+    consoleEffacer();
 
     setCouleur(COULEUR_TITRE);
     printf("\n  ===== GESTION DES COMPTES =====\n\n");
@@ -760,20 +2439,17 @@ void menuGestionComptes(void)
 
         /* Navigation fleches */
         while (1) {
-            touche = _getch();
-            if (touche == 0 || touche == 224) {
-                touche = _getch();
-                if (touche == 72) {         /* Fleche HAUT */
-                    sel = (sel - 1 + nbItems) % nbItems;
-                    afficherMenuGestionNavigue(sel);
-                } else if (touche == 80) {  /* Fleche BAS */
-                    sel = (sel + 1) % nbItems;
-                    afficherMenuGestionNavigue(sel);
-                }
-            } else if (touche == 13) {      /* Entree */
-                choix = indexVersOptionGestion[sel];
+            touche = consoleTouche();
+            if (touche == TOUCHE_HAUT) {
+                sel = (sel - 1 + nbItems) % nbItems;
+                afficherMenuGestionNavigue(sel);
+            } else if (touche == TOUCHE_BAS) {
+                sel = (sel + 1) % nbItems;
+                afficherMenuGestionNavigue(sel);
+            } else if (touche == TOUCHE_ENTREE || touche == TOUCHE_FIN) {
+                choix = touche == TOUCHE_FIN ? 0 : indexVersOptionGestion[sel];
                 setCouleur(COULEUR_NORMAL);
-                system("cls");
+                consoleEffacer();
                 break;
             }
         }
@@ -792,7 +2468,7 @@ void menuGestionComptes(void)
         /* Pause apres chaque action sauf Retour */
         if (choix != 0) {
             printf("\n  Appuyez sur une touche pour revenir...");
-            _getch();
+            consoleTouche();
         }
 
     } while (choix != 0);
@@ -816,11 +2492,12 @@ void afficherMenuNavigue(int sel)
         "10. Lancer le mode R\xc9SEAU",
         "11. Exporter vers Excel",
         "12. Gestion des comptes",
+        "13. Importer des \xe9lecteurs (CSV)",
         "0.  Quitter ET R\xc9INITIALISER"
     };
-    int nbOptions = 13;
+    int nbOptions = 14;
 
-    system("cls");
+    consoleEffacer();
 
     setCouleur(COULEUR_TITRE);
     printf("\n  ===== MENU PIVOTE ADMINISTRATEUR =====\n\n");
@@ -845,37 +2522,37 @@ void afficherMenuNavigue(int sel)
 
 /* Table de correspondance : index dans le menu -> numero d'option reel */
 static const int indexVersOption[] = {
-    1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 0
+    1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 0
 };
 
 int naviguerMenu(void)
 {
     int sel     = 0;   /* index courant dans la liste */
-    int nbItems = 13;  /* nombre total d'options      */
+    int nbItems = 14;  /* nombre total d'options      */
     int touche;
 
     afficherMenuNavigue(sel);
 
     while (1) {
-        touche = _getch();
+        touche = consoleTouche();
 
-        /* Les fleches envoient 2 codes : 0 ou 224, puis le code reel */
-        if (touche == 0 || touche == 224) {
-            touche = _getch();
-            if (touche == 72) {          /* Fleche HAUT */
-                sel = (sel - 1 + nbItems) % nbItems;
-                afficherMenuNavigue(sel);
-            }
-            else if (touche == 80) {     /* Fleche BAS */
-                sel = (sel + 1) % nbItems;
-                afficherMenuNavigue(sel);
-            }
+        if (touche == TOUCHE_HAUT) {
+            sel = (sel - 1 + nbItems) % nbItems;
+            afficherMenuNavigue(sel);
+        }
+        else if (touche == TOUCHE_BAS) {
+            sel = (sel + 1) % nbItems;
+            afficherMenuNavigue(sel);
         }
-        else if (touche == 13) {         /* Touche ENTREE */
+        else if (touche == TOUCHE_ENTREE) {
             setCouleur(COULEUR_NORMAL);
-            system("cls");
+            consoleEffacer();
             return indexVersOption[sel];
         }
+        else if (touche == TOUCHE_FIN) {
+            setCouleur(COULEUR_NORMAL);
+            return -1;
+        }
     }
 }
 
@@ -888,6 +2565,15 @@ void menuServeur(void)
     do {
         /* Navigation avec fleches au lieu de scanf */
         choix = naviguerMenu();
+        if (choix < 0) {
+            /* Plus d'entree (stdin ferme) : arret sans reinitialiser */
+            affichageAutoActif = 0;
+            arreterPersistance();
+            verrouExclusifPrendre(&verrouFichiers);
+            journalFermer();
+            verrouExclusifRendre(&verrouFichiers);
+            break;
+        }
 
         switch (choix) {
         case 1:  ajouterElecteur();      sauvegarderDonnees(); break;
@@ -898,7 +2584,7 @@ void menuServeur(void)
         case 6:  fermerVote();           sauvegarderDonnees(); break;
         case 7:  afficherResultats();    break;
         case 8:  afficherBarresASCII();  break;
-        case 9:  afficherStatistiques(); break;
+        case 9:  afficherStatistiques(); afficherFileVotes(); break;
         case 10: lancerServeurReseau();  break;
         case 11:
             exporterVersExcel();
@@ -907,10 +2593,23 @@ void menuServeur(void)
         case 12:
             menuGestionComptes();
             break;
+        case 13:
+            importerElecteursCSV();
+            sauvegarderDonnees();
+            break;
         case 0:
             affichageAutoActif = 0;
+            arreterPersistance();
+            verrouExclusifPrendre(&verrouFichiers);
+            journalFermer();
+            verrouExclusifRendre(&verrouFichiers);
+            remove(FICHIER_INSTANTANE);
+            remove(FICHIER_INSTANTANE INSTANTANE_SUFFIXE_PREC);
             remove(FICHIER_SAUVEGARDE);
-            printf(">> Session termin\xe9e. Fichiers de sauvegarde supprim\xe9s.\n");
+            remove(FICHIER_SAUVEGARDE SAUVEGARDE_SUFFIXE_MIGREE);
+            remove(FICHIER_JOURNAL);
+            remove(FICHIER_JOURNAL JOURNAL_SUFFIXE_PREC);
+            printf(">> Session termin\xe9" "e. Fichiers de sauvegarde supprim\xe9s.\n");
             break;
         default:
             printf("Choix invalide.\n");
@@ -920,7 +2619,7 @@ void menuServeur(void)
         /* Pause apres chaque action pour lire le resultat */
         if (choix != 0 && choix != 10) {
             printf("\n  Appuyez sur une touche pour revenir au menu...");
-            _getch();
+            consoleTouche();
         }
 
     } while (choix != 0);
@@ -953,12 +2652,12 @@ int ecranConnexionAdmin(void)
 
     if (!adminExiste) {
         printf("\n[PREMIERE UTILISATION] Aucun administrateur trouv\xe9.\n");
-        printf("Veuillez cr\xe9er le compte administrateur principal :\n");
+        printf("Veuillez cr\xe9" "er le compte administrateur principal :\n");
         lire_ligne_srv("Identifiant admin  : ", username, sizeof(username));
         lire_ligne_srv("Mot de passe admin : ", password, sizeof(password));
         AuthStatus st = auth_register_user(CSV_PATH, username, password, "admin");
         if (st != AUTH_OK) {
-            printf("Erreur cr\xe9ation admin (code=%d).\n", st);
+            printf("Erreur cr\xe9" "ation admin (code=%d).\n", st);
             return 0;
         }
         printf("Compte admin cr\xe9\xe9. Veuillez vous connecter.\n\n");
@@ -3,58 +3,58 @@
  * @brief Point d'entree du CLIENT PIVOTE V2 (votant).
  *
  * Flux d'execution :
- *   1. initialiserSocket       -> init Winsock + creation socket TCP
+ *   1. initialiserSocket       -> init sockets + session (client_protocole.h)
  *   2. connecterAuServeur      -> saisie IP + connect()
+ *      negocierProtocole       -> protocole trame, ou texte si ancien serveur
  *   3. authentifier            -> boucle login/mdp (3 tentatives max)
  *   4. recevoirListeCandidats  -> affichage liste envoyee par le serveur
  *   5. saisirVote              -> saisie ID electeur + ID candidat + confirmation
  *   6. envoyerVote             -> envoi "VOTE <idE> <idC>"
  *   7. recevoirConfirmationVote-> affichage resultat final
- *   8. fermerConnexion         -> closesocket + WSACleanup
+ *   8. fermerConnexion         -> fermeture socket + socketsFin
  *
- * Compilation (MinGW / Code::Blocks, C99) :
- * gcc -std=c99 -Wall client_impl.c client_main.c -o client.exe -lws2_32
+ * Compilation (Windows ou Linux, C99) : cmake -S . -B build && cmake --build build
+ * (cible pivote-client), ou le projet Code::Blocks Pivoteclient2.0.cbp.
  */
 
 #include "client.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <locale.h>
-#include <winsock2.h>
-#include <windows.h>
 #include "auth.h"
+#include "plateforme.h"
 
 int main(void)
 {
     /* Support des accents sous Windows */
-    SetConsoleOutputCP(65001);
-    SetConsoleCP(65001);
+    consoleInit(65001);
     setlocale(LC_ALL, "");
 
-    SOCKET sock;
-    char   server_ip[50];
-    char   username[65];
-    char   password[65];
-    int    idE, idC;
+    SessionClient session;
+    char          server_ip[50];
+    char          username[65];
+    char          password[65];
+    int           idE, idC;
 
     printf("===================================================\n");
     printf("                     PIVOTE\n");
     printf("===================================================\n\n");
 
     /* --------------------------------------------------
-     * Etape 1 : Initialisation Winsock + creation socket
+     * Etape 1 : Initialisation des sockets + creation socket
      * -------------------------------------------------- */
-    if (!initialiserSocket(&sock)) {
-        system("pause");
+    if (!initialiserSocket(&session)) {
+        consolePause();
         return 1;
     }
 
     /* --------------------------------------------------
      * Etape 2 : Connexion au serveur
      * -------------------------------------------------- */
-    if (!connecterAuServeur(sock, server_ip)) {
-        fermerConnexion(sock);
-        system("pause");
+    if (!connecterAuServeur(&session, server_ip)
+        || !negocierProtocole(&session, server_ip)) {
+        fermerConnexion(&session);
+        consolePause();
         return 1;
     }
 
@@ -63,16 +63,16 @@ int main(void)
      * Le message "mot de passe oublie" s'affiche uniquement
      * en cas d'echec, pas systematiquement.
      * -------------------------------------------------- */
-    if (!authentifier(sock, username, password)) {
-        fermerConnexion(sock);
-        system("pause");
+    if (!authentifier(&session, username, password)) {
+        fermerConnexion(&session);
+        consolePause();
         return 1;
     }
 
     /* --------------------------------------------------
      * Etape 4 : Reception et affichage liste des candidats
      * -------------------------------------------------- */
-    recevoirListeCandidats(sock);
+    recevoirListeCandidats(&session);
 
     /* --------------------------------------------------
      * Etape 5 : Saisie et confirmation du vote
@@ -82,17 +82,17 @@ int main(void)
     /* --------------------------------------------------
      * Etape 6 : Envoi du vote au serveur
      * -------------------------------------------------- */
-    envoyerVote(sock, idE, idC);
+    envoyerVote(&session, idE, idC);
 
     /* --------------------------------------------------
      * Etape 7 : Reception de la confirmation finale
      * -------------------------------------------------- */
-    recevoirConfirmationVote(sock);
+    recevoirConfirmationVote(&session);
 
     /* --------------------------------------------------
      * Etape 8 : Fermeture propre de la connexion
      * -------------------------------------------------- */
-    fermerConnexion(sock);
+    fermerConnexion(&session);
 
     printf("\nAppuyez sur Entree pour quitter...");
     getchar();
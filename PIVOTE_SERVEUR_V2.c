@@ -4,27 +4,27 @@
  *
  * Flux d'execution :
  *   1. auth_init           -> initialise le fichier users.csv
+ *      auth_store_open     -> charge et indexe users.csv en memoire
+ *      auth_store_set_journal -> inscriptions en ajout dans users.csv.journal
  *   2. ecranConnexionAdmin -> cree/authentifie l'administrateur
  *   3. chargerDonnees      -> recharge les donnees de vote persistees
  *   4. menuServeur         -> boucle principale du menu admin
  *
- * Compilation (MinGW / Code::Blocks, C99) :
- * gcc -std=c99 -Wall serveur_impl.c serveur_main.c auth.c -o serveur.exe -lws2_32
+ * Compilation (Windows ou Linux, C99) : cmake -S . -B build && cmake --build build
+ * (cible pivote-serveur), ou le projet Code::Blocks Pivoteserveur2.0.cbp.
  */
 
 #include "serveur.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <locale.h>
-#include <winsock2.h>
-#include <windows.h>
 #include "auth.h"
+#include "plateforme.h"
 
 int main(void)
 {
     /* 1252 = Windows Latin-1 : support complet des accents           */
-    SetConsoleOutputCP(1252);
-    SetConsoleCP(1252);
+    consoleInit(1252);
     setlocale(LC_ALL, "");
     AuthStatus st = auth_init(CSV_PATH);
     if (st != AUTH_OK)
@@ -33,10 +33,17 @@ int main(void)
         return 1;
     }
 
+    /* Store resident : les logins reseau ne relisent plus users.csv */
+    st = auth_store_open(CSV_PATH);
+    if (st != AUTH_OK)
+        printf("[ATTENTION] users.csv non charge en memoire (code=%d), lecture fichier.\n", st);
+    else if (auth_store_set_journal(1) != AUTH_OK)
+        printf("[ATTENTION] Journal users.csv.journal indisponible, reecriture complete.\n");
+
     if (!ecranConnexionAdmin())
     {
         printf("Impossible de se connecter. Fermeture.\n");
-        system("pause");
+        consolePause();
         return 1;
     }
 
@@ -3,15 +3,100 @@
  * @brief Implémentation de la bibliothèque d'authentification simple basée sur un CSV.
  */
 
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L /* pthread_rwlock_t en -std=c99 */
+#endif
+
 #include "auth.h"
+#include "auth_scan.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
 /** Taille maximale d'une ligne lue dans le CSV. */
 #define AUTH_MAX_LINE 512
 
+/** Taille maximale d'un chemin dérivé (journal, fichier temporaire). */
+#define AUTH_MAX_PATH 512
+
+/** Capacité initiale (puissance de 2) de la table de hachage du store. */
+#define AUTH_STORE_MIN_SLOTS 64
+
+/** Suffixes des fichiers dérivés du CSV. */
+#define AUTH_JOURNAL_SUFFIX ".journal"
+#define AUTH_TMP_SUFFIX     ".tmp"
+
+/**
+ * Nombre minimal d'enregistrements dans le journal avant de lancer une
+ * compaction en arrière-plan (et au moins autant que d'utilisateurs).
+ */
+#define AUTH_JOURNAL_COMPACT_MIN 4096
+
+/**
+ * @brief Case de la table de hachage (adressage ouvert, sondage linéaire).
+ *
+ * `index` vaut position + 1 dans `AuthStore.users`, 0 pour une case vide.
+ * Le hash complet est conservé pour éviter la plupart des `strcmp`.
+ */
+typedef struct
+{
+    uint32_t hash;
+    uint32_t index;
+} AuthSlot;
+
+/**
+ * @brief Utilisateurs dans l'ordre du fichier + index par login.
+ *
+ * Sert au store résident (`g_store`) et, temporairement, à la relecture
+ * base + journal en mode fichier.
+ */
+typedef struct
+{
+    char     *path;      /**< Fichier couvert par le store (NULL si fermé). */
+    AuthUser *users;     /**< Utilisateurs, dans l'ordre du CSV. */
+    size_t    count;
+    size_t    cap;
+    AuthSlot *slots;     /**< Table de hachage, taille puissance de 2. */
+    size_t    nb_slots;
+    FILE     *journal;   /**< Journal ouvert en ajout (mode journalisé), sinon NULL. */
+    size_t    journal_records; /**< Enregistrements dans le journal courant. */
+    int       compacting;      /**< 1 si une compaction est programmée ou en cours. */
+} AuthStore;
+
+static AuthStore g_store;
+
+/* Verrou lecteurs/écrivain : les logins réseau lisent pendant que le menu
+ * admin peut modifier un compte. Le second verrou sérialise tout ce qui
+ * réécrit la base par <csv>.tmp hors du premier (compaction, retour au mode
+ * réécriture) et permet à auth_store_close() d'attendre la compaction. */
+#ifdef _WIN32
+static SRWLOCK g_store_lock   = SRWLOCK_INIT;
+static SRWLOCK g_compact_lock = SRWLOCK_INIT;
+#define auth_lock_shared()      AcquireSRWLockShared(&g_store_lock)
+#define auth_unlock_shared()    ReleaseSRWLockShared(&g_store_lock)
+#define auth_lock_exclusive()   AcquireSRWLockExclusive(&g_store_lock)
+#define auth_unlock_exclusive() ReleaseSRWLockExclusive(&g_store_lock)
+#define auth_lock_compact()     AcquireSRWLockExclusive(&g_compact_lock)
+#define auth_unlock_compact()   ReleaseSRWLockExclusive(&g_compact_lock)
+#else
+static pthread_rwlock_t g_store_lock   = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_mutex_t  g_compact_lock = PTHREAD_MUTEX_INITIALIZER;
+#define auth_lock_shared()      pthread_rwlock_rdlock(&g_store_lock)
+#define auth_unlock_shared()    pthread_rwlock_unlock(&g_store_lock)
+#define auth_lock_exclusive()   pthread_rwlock_wrlock(&g_store_lock)
+#define auth_unlock_exclusive() pthread_rwlock_unlock(&g_store_lock)
+#define auth_lock_compact()     pthread_mutex_lock(&g_compact_lock)
+#define auth_unlock_compact()   pthread_mutex_unlock(&g_compact_lock)
+#endif
+
 /**
  * @brief Supprime le '\n' final éventuel d'une chaîne.
  */
@@ -87,6 +172,485 @@ static AuthStatus auth_fprint_user(FILE *f, const AuthUser *u)
     return AUTH_OK;
 }
 
+/**
+ * @brief Construit "<csv_path><suffix>" dans `out`.
+ * @return AUTH_OK, ou AUTH_ERR_INVALID si le chemin est trop long.
+ */
+static AuthStatus auth_derived_path(const char *csv_path, const char *suffix,
+                                    char *out, size_t size)
+{
+    int n = snprintf(out, size, "%s%s", csv_path, suffix);
+    if (n < 0 || (size_t)n >= size)
+        return AUTH_ERR_INVALID;
+    return AUTH_OK;
+}
+
+/**
+ * @brief Renomme `from` en `to` en remplaçant `to` s'il existe.
+ */
+static int auth_rename_replace(const char *from, const char *to)
+{
+#ifdef _WIN32
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING) ? 0 : -1;
+#else
+    return rename(from, to);
+#endif
+}
+
+/* =========================================================
+ * TABLE D'UTILISATEURS INDEXÉE
+ * ========================================================= */
+
+/** Valeur renvoyée par `auth_store_find()` si l'identifiant est absent. */
+#define AUTH_STORE_NONE ((size_t)-1)
+
+/**
+ * @brief Hash FNV-1a 32 bits d'un identifiant.
+ */
+static uint32_t auth_hash(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s)
+    {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/**
+ * @brief Cherche un identifiant dans la table de hachage.
+ * @return Position dans `s->users`, ou AUTH_STORE_NONE.
+ */
+static size_t auth_store_find(const AuthStore *s, const char *username)
+{
+    if (s->nb_slots == 0)
+        return AUTH_STORE_NONE;
+
+    uint32_t h    = auth_hash(username);
+    size_t   mask = s->nb_slots - 1;
+
+    for (size_t i = h & mask; ; i = (i + 1) & mask)
+    {
+        const AuthSlot *slot = &s->slots[i];
+        if (slot->index == 0)
+            return AUTH_STORE_NONE;
+        if (slot->hash == h && strcmp(s->users[slot->index - 1].username, username) == 0)
+            return slot->index - 1;
+    }
+}
+
+/**
+ * @brief Place la position `pos` dans la table (l'identifiant n'y est pas encore).
+ */
+static void auth_store_index(AuthStore *s, size_t pos, uint32_t h)
+{
+    size_t mask = s->nb_slots - 1;
+    size_t i    = h & mask;
+
+    while (s->slots[i].index != 0)
+        i = (i + 1) & mask;
+
+    s->slots[i].hash  = h;
+    s->slots[i].index = (uint32_t)(pos + 1);
+}
+
+/**
+ * @brief Garantit de la place pour `needed` utilisateurs (tableau + table à
+ *        moitié pleine au plus), en réindexant si la table doit grandir.
+ */
+static AuthStatus auth_store_reserve(AuthStore *s, size_t needed)
+{
+    if (needed > s->cap)
+    {
+        size_t new_cap = s->cap == 0 ? 8 : s->cap;
+        while (new_cap < needed)
+            new_cap *= 2;
+        AuthUser *tmp = (AuthUser *)realloc(s->users, new_cap * sizeof(AuthUser));
+        if (!tmp)
+            return AUTH_ERR_IO;
+        s->users = tmp;
+        s->cap   = new_cap;
+    }
+
+    if (needed * 2 > s->nb_slots)
+    {
+        size_t n = s->nb_slots == 0 ? AUTH_STORE_MIN_SLOTS : s->nb_slots;
+        while (needed * 2 > n)
+            n *= 2;
+
+        AuthSlot *slots = (AuthSlot *)calloc(n, sizeof(AuthSlot));
+        if (!slots)
+            return AUTH_ERR_IO;
+
+        AuthSlot *old    = s->slots;
+        size_t    old_nb = s->nb_slots;
+        s->slots    = slots;
+        s->nb_slots = n;
+        for (size_t i = 0; i < old_nb; ++i)
+        {
+            if (old[i].index != 0)
+                auth_store_index(s, old[i].index - 1, old[i].hash);
+        }
+        free(old);
+    }
+    return AUTH_OK;
+}
+
+/**
+ * @brief Ajoute un utilisateur ou remplace celui de même identifiant.
+ */
+static AuthStatus auth_store_upsert(AuthStore *s, const AuthUser *u)
+{
+    size_t pos = auth_store_find(s, u->username);
+    if (pos != AUTH_STORE_NONE)
+    {
+        s->users[pos] = *u;
+        return AUTH_OK;
+    }
+
+    AuthStatus st = auth_store_reserve(s, s->count + 1);
+    if (st != AUTH_OK)
+        return st;
+
+    s->users[s->count] = *u;
+    auth_store_index(s, s->count, auth_hash(u->username));
+    s->count++;
+    return AUTH_OK;
+}
+
+/**
+ * @brief Libère la mémoire d'une table et ferme son journal éventuel.
+ */
+static void auth_store_free(AuthStore *s)
+{
+    if (s->journal)
+        fclose(s->journal);
+    free(s->path);
+    free(s->users);
+    free(s->slots);
+    memset(s, 0, sizeof(*s));
+}
+
+/* =========================================================
+ * JOURNAL DES MODIFICATIONS
+ *
+ * Un enregistrement par ligne, le dernier pour un identifiant l'emporte :
+ *   U;identifiant;mot_de_passe;role;actif   (création / remplacement)
+ *   P;identifiant;mot_de_passe              (changement de mot de passe)
+ *   A;identifiant;actif                     (activation / désactivation)
+ * Chaque enregistrement décrit un état et non un delta : rejouer le journal
+ * sur une base plus récente redonne le même résultat.
+ * ========================================================= */
+
+/**
+ * @brief Rejoue une ligne complète du journal sur une table.
+ * @return AUTH_OK, ou AUTH_ERR_FORMAT si la ligne est invalide.
+ */
+static AuthStatus auth_journal_apply(AuthStore *s, char *line)
+{
+    auth_chomp(line);
+    if (line[0] == '\0')
+        return AUTH_OK;
+    if (line[1] != ';')
+        return AUTH_ERR_FORMAT;
+
+    char op = line[0];
+    if (op == 'U')
+    {
+        AuthUser u;
+        if (auth_parse_line(line + 2, &u) != AUTH_OK)
+            return AUTH_ERR_FORMAT;
+        return auth_store_upsert(s, &u);
+    }
+
+    char *username = strtok(line + 2, ";");
+    char *value    = strtok(NULL, ";");
+    if (!username || !value)
+        return AUTH_ERR_FORMAT;
+
+    size_t pos = auth_store_find(s, username);
+    if (pos == AUTH_STORE_NONE)
+        return AUTH_OK; /* Compte inconnu de la base : rien à appliquer. */
+
+    if (op == 'P')
+    {
+        strncpy(s->users[pos].password, value, AUTH_MAX_PASSWORD);
+        s->users[pos].password[AUTH_MAX_PASSWORD] = '\0';
+    }
+    else if (op == 'A')
+    {
+        s->users[pos].active = atoi(value) ? 1 : 0;
+    }
+    else
+    {
+        return AUTH_ERR_FORMAT;
+    }
+    return AUTH_OK;
+}
+
+/**
+ * @brief Écrit un enregistrement dans le tampon du journal (sans le vider).
+ *
+ * @param op 'U', 'P' ou 'A' (voir le format ci-dessus).
+ */
+static int auth_journal_print(FILE *f, char op, const AuthUser *u)
+{
+    if (op == 'U')
+        return fprintf(f, "U;%s;%s;%s;%d\n", u->username, u->password, u->role, u->active ? 1 : 0);
+    if (op == 'P')
+        return fprintf(f, "P;%s;%s\n", u->username, u->password);
+    return fprintf(f, "A;%s;%d\n", u->username, u->active ? 1 : 0);
+}
+
+/**
+ * @brief Écrit des enregistrements dans le journal ouvert puis le vide sur
+ *        disque en une fois.
+ */
+static AuthStatus auth_journal_write(FILE *f, char op, const AuthUser *users, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (auth_journal_print(f, op, &users[i]) < 0)
+            return AUTH_ERR_IO;
+    }
+    if (fflush(f) != 0)
+        return AUTH_ERR_IO;
+    return AUTH_OK;
+}
+
+/**
+ * @brief Charge la base CSV puis rejoue le journal éventuel.
+ *
+ * @param torn Si non NULL, mis à 1 quand la dernière ligne du journal est
+ *             incomplète (écriture interrompue) ; elle est alors ignorée.
+ * @return AUTH_OK, AUTH_ERR_IO si la base est illisible, AUTH_ERR_FORMAT.
+ */
+static AuthStatus auth_store_load(AuthStore *s, const char *csv_path, int *torn)
+{
+    char line[AUTH_MAX_LINE];
+    char journal_path[AUTH_MAX_PATH];
+
+    if (torn)
+        *torn = 0;
+
+    AuthStatus st = auth_derived_path(csv_path, AUTH_JOURNAL_SUFFIX,
+                                      journal_path, sizeof(journal_path));
+    if (st != AUTH_OK)
+        return st;
+
+    /* Base : fichier projeté et découpé sans copie, puis une seule copie
+     * par champ vers la table. */
+    AuthScan scan;
+    st = auth_scan_open(csv_path, &scan);
+    if (st != AUTH_OK)
+        return st;
+
+    st = auth_store_reserve(s, s->count + scan.count);
+    if (st != AUTH_OK)
+    {
+        auth_scan_close(&scan);
+        return st;
+    }
+    for (size_t i = 0; i < scan.count; ++i)
+    {
+        AuthUser *u = &s->users[s->count];
+        auth_scan_copy_user(&scan.users[i], u);
+
+        /* En cas de doublon dans la base, la première ligne fait foi
+         * (même comportement que l'ancien parcours linéaire). */
+        if (auth_store_find(s, u->username) == AUTH_STORE_NONE)
+            auth_store_index(s, s->count, auth_hash(u->username));
+        s->count++;
+    }
+    auth_scan_close(&scan);
+
+    FILE *f = fopen(journal_path, "r");
+    if (!f)
+        return AUTH_OK; /* Pas de journal : la base est complète. */
+
+    while (fgets(line, sizeof(line), f))
+    {
+        if (strchr(line, '\n') == NULL && feof(f))
+        {
+            if (torn)
+                *torn = 1;
+            break;
+        }
+        st = auth_journal_apply(s, line);
+        if (st != AUTH_OK)
+        {
+            fclose(f);
+            return st;
+        }
+        s->journal_records++;
+    }
+    fclose(f);
+    return AUTH_OK;
+}
+
+/**
+ * @brief Lit et parse tout le fichier CSV, journal compris (sans le store).
+ */
+static AuthStatus auth_read_file(const char *csv_path,
+                                 AuthUser **out_users,
+                                 size_t *out_count)
+{
+    AuthStore tmp;
+    memset(&tmp, 0, sizeof(tmp));
+
+    *out_users = NULL;
+    *out_count = 0;
+
+    AuthStatus st = auth_store_load(&tmp, csv_path, NULL);
+    if (st == AUTH_OK)
+    {
+        *out_users = tmp.users;
+        *out_count = tmp.count;
+        tmp.users  = NULL;
+    }
+    auth_store_free(&tmp);
+    return st;
+}
+
+/**
+ * @brief Écrit une liste complète dans un fichier temporaire puis le renomme
+ *        sur le CSV : un lecteur ne voit jamais de fichier à moitié écrit.
+ */
+static AuthStatus auth_replace_file(const char *csv_path,
+                                    const AuthUser *users,
+                                    size_t count)
+{
+    char tmp_path[AUTH_MAX_PATH];
+    AuthStatus st = auth_derived_path(csv_path, AUTH_TMP_SUFFIX, tmp_path, sizeof(tmp_path));
+    if (st != AUTH_OK)
+        return st;
+
+    FILE *f = fopen(tmp_path, "w");
+    if (!f)
+        return AUTH_ERR_IO;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        st = auth_fprint_user(f, &users[i]);
+        if (st != AUTH_OK)
+        {
+            fclose(f);
+            remove(tmp_path);
+            return st;
+        }
+    }
+
+    if (fclose(f) != 0 || auth_rename_replace(tmp_path, csv_path) != 0)
+    {
+        remove(tmp_path);
+        return AUTH_ERR_IO;
+    }
+    return AUTH_OK;
+}
+
+/**
+ * @brief Sauvegarde une liste d'utilisateurs complète dans le CSV (remplacement).
+ *
+ * La base contient alors tout l'état : le journal éventuel est supprimé.
+ */
+static AuthStatus auth_save_all(const char *csv_path,
+                                const AuthUser *users,
+                                size_t count)
+{
+    char journal_path[AUTH_MAX_PATH];
+    AuthStatus st = auth_derived_path(csv_path, AUTH_JOURNAL_SUFFIX,
+                                      journal_path, sizeof(journal_path));
+    if (st != AUTH_OK)
+        return st;
+
+    st = auth_replace_file(csv_path, users, count);
+    if (st == AUTH_OK)
+        remove(journal_path);
+    return st;
+}
+
+/* =========================================================
+ * STORE RESIDENT (fonctions internes, verrou déjà pris)
+ * ========================================================= */
+
+/**
+ * @brief Indique si le store est ouvert sur ce fichier.
+ */
+static int auth_store_covers(const char *csv_path)
+{
+    return g_store.path != NULL && strcmp(g_store.path, csv_path) == 0;
+}
+
+#ifdef _WIN32
+static DWORD WINAPI auth_compact_thread(LPVOID arg)
+{
+    (void)arg;
+    auth_store_compact();
+    return 0;
+}
+#else
+static void *auth_compact_thread(void *arg)
+{
+    (void)arg;
+    auth_store_compact();
+    return NULL;
+}
+#endif
+
+/**
+ * @brief Compte `n` enregistrements de plus et lance la compaction en
+ *        arrière-plan quand le journal devient plus gros que la base.
+ */
+static void auth_store_journaled(size_t n)
+{
+    g_store.journal_records += n;
+    if (g_store.compacting
+        || g_store.journal_records < AUTH_JOURNAL_COMPACT_MIN
+        || g_store.journal_records < g_store.count)
+        return;
+
+#ifdef _WIN32
+    HANDLE h = CreateThread(NULL, 0, auth_compact_thread, NULL, 0, NULL);
+    if (h)
+    {
+        g_store.compacting = 1;
+        CloseHandle(h);
+    }
+#else
+    pthread_t th;
+    if (pthread_create(&th, NULL, auth_compact_thread, NULL) == 0)
+    {
+        g_store.compacting = 1;
+        pthread_detach(th);
+    }
+#endif
+}
+
+/**
+ * @brief Persiste des modifications déjà validées : `nb` lignes de journal
+ *        en mode journalisé, sinon réécriture complète depuis la mémoire.
+ *
+ * @param u/nb        Utilisateurs modifiés (enregistrements `op`).
+ * @param users/count État complet à écrire en mode réécriture.
+ */
+static AuthStatus auth_store_persist(char op, const AuthUser *u, size_t nb,
+                                     const AuthUser *users, size_t count)
+{
+    if (g_store.journal)
+    {
+        AuthStatus st = auth_journal_write(g_store.journal, op, u, nb);
+        if (st == AUTH_OK)
+            auth_store_journaled(nb);
+        return st;
+    }
+    return auth_save_all(g_store.path, users, count);
+}
+
+/* =========================================================
+ * API PUBLIQUE
+ * ========================================================= */
+
 AuthStatus auth_init(const char *csv_path)
 {
     if (!csv_path)
@@ -109,57 +673,230 @@ AuthStatus auth_init(const char *csv_path)
     return AUTH_OK;
 }
 
-AuthStatus auth_list_users(const char *csv_path,
-                           AuthUser **out_users,
-                           size_t *out_count)
+AuthStatus auth_store_open(const char *csv_path)
 {
-    if (!csv_path || !out_users || !out_count)
+    if (!csv_path)
         return AUTH_ERR_INVALID;
 
-    *out_users = NULL;
-    *out_count = 0;
+    AuthStore s;
+    int       torn = 0;
+    memset(&s, 0, sizeof(s));
 
-    FILE *f = fopen(csv_path, "r");
-    if (!f)
-        return AUTH_ERR_IO;
+    AuthStatus st = auth_store_load(&s, csv_path, &torn);
+    if (st == AUTH_OK)
+    {
+        s.path = (char *)malloc(strlen(csv_path) + 1);
+        if (s.path)
+            strcpy(s.path, csv_path);
+        else
+            st = AUTH_ERR_IO;
+    }
 
-    AuthUser *list = NULL;
-    size_t    used = 0;
-    size_t    cap  = 0;
+    /* Journal terminé par une ligne tronquée : on replie tout dans la base
+     * pour que les prochains ajouts ne se collent pas à ce fragment. */
+    if (st == AUTH_OK && torn)
+    {
+        st = auth_save_all(csv_path, s.users, s.count);
+        s.journal_records = 0;
+    }
 
-    char line[AUTH_MAX_LINE];
-    while (fgets(line, sizeof(line), f))
+    if (st != AUTH_OK)
     {
-        AuthUser u;
-        AuthStatus st = auth_parse_line(line, &u);
-        if (st != AUTH_OK)
+        auth_store_free(&s);
+        return st;
+    }
+
+    auth_lock_compact();
+    auth_lock_exclusive();
+    auth_store_free(&g_store);
+    g_store = s;
+    auth_unlock_exclusive();
+    auth_unlock_compact();
+    return AUTH_OK;
+}
+
+void auth_store_close(void)
+{
+    /* Attend la fin d'une compaction en cours avant de tout libérer. */
+    auth_lock_compact();
+    auth_lock_exclusive();
+    auth_store_free(&g_store);
+    auth_unlock_exclusive();
+    auth_unlock_compact();
+}
+
+AuthStatus auth_store_set_journal(int enabled)
+{
+    char       journal_path[AUTH_MAX_PATH];
+    AuthStatus st = AUTH_OK;
+
+    /* Une compaction en cours écrit aussi <csv>.tmp : on attend qu'elle finisse. */
+    auth_lock_compact();
+    auth_lock_exclusive();
+    if (!g_store.path)
+    {
+        auth_unlock_exclusive();
+        auth_unlock_compact();
+        return AUTH_ERR_INVALID;
+    }
+
+    if (enabled && !g_store.journal)
+    {
+        st = auth_derived_path(g_store.path, AUTH_JOURNAL_SUFFIX,
+                               journal_path, sizeof(journal_path));
+        if (st == AUTH_OK)
         {
-            fclose(f);
-            free(list);
-            return AUTH_ERR_FORMAT;
+            g_store.journal = fopen(journal_path, "a");
+            if (!g_store.journal)
+                st = AUTH_ERR_IO;
+        }
+    }
+    else if (!enabled && g_store.journal)
+    {
+        /* Retour au mode réécriture : la base reprend tout l'état. */
+        fclose(g_store.journal);
+        g_store.journal = NULL;
+        st = auth_save_all(g_store.path, g_store.users, g_store.count);
+        if (st == AUTH_OK)
+            g_store.journal_records = 0;
+    }
+    auth_unlock_exclusive();
+    auth_unlock_compact();
+    return st;
+}
+
+AuthStatus auth_store_compact(void)
+{
+    char       journal_path[AUTH_MAX_PATH];
+    char       tmp_path[AUTH_MAX_PATH];
+    char      *path     = NULL;
+    AuthUser  *snapshot = NULL;
+    size_t     count    = 0;
+    long       offset   = 0;
+    AuthStatus st       = AUTH_OK;
+
+    auth_lock_compact();
+
+    /* 1. Photo de l'état + position actuelle dans le journal. */
+    auth_lock_exclusive();
+    if (!g_store.path || !g_store.journal)
+    {
+        st = g_store.path ? AUTH_OK : AUTH_ERR_INVALID;
+        g_store.compacting = 0;
+        auth_unlock_exclusive();
+        auth_unlock_compact();
+        return st;
+    }
+    path     = (char *)malloc(strlen(g_store.path) + 1);
+    snapshot = (AuthUser *)malloc((g_store.count ? g_store.count : 1) * sizeof(AuthUser));
+    if (path && snapshot)
+    {
+        strcpy(path, g_store.path);
+        count = g_store.count;
+        if (count)
+            memcpy(snapshot, g_store.users, count * sizeof(AuthUser));
+        offset = ftell(g_store.journal);
+        if (offset < 0)
+            st = AUTH_ERR_IO;
+    }
+    else
+    {
+        st = AUTH_ERR_IO;
+    }
+    auth_unlock_exclusive();
+
+    /* 2. Nouvelle base écrite hors verrou : les logins continuent. */
+    if (st == AUTH_OK)
+        st = auth_replace_file(path, snapshot, count);
+    free(snapshot);
+
+    /* 3. On ne garde du journal que ce qui a été ajouté pendant l'écriture.
+     *    Un arrêt entre 2 et 3 laisse l'ancien journal, rejouable sans risque. */
+    if (st == AUTH_OK)
+        st = auth_derived_path(path, AUTH_JOURNAL_SUFFIX, journal_path, sizeof(journal_path));
+    if (st == AUTH_OK)
+        st = auth_derived_path(journal_path, AUTH_TMP_SUFFIX, tmp_path, sizeof(tmp_path));
+
+    auth_lock_exclusive();
+    if (st == AUTH_OK && g_store.journal && auth_store_covers(path))
+    {
+        FILE  *in   = fopen(journal_path, "rb");
+        FILE  *out  = fopen(tmp_path, "wb");
+        size_t kept = 0;
+        char   buf[4096];
+        size_t n;
+
+        if (!in || !out || fseek(in, offset, SEEK_SET) != 0)
+            st = AUTH_ERR_IO;
+        while (st == AUTH_OK && (n = fread(buf, 1, sizeof(buf), in)) > 0)
+        {
+            for (size_t i = 0; i < n; ++i)
+                kept += buf[i] == '\n';
+            if (fwrite(buf, 1, n, out) != n)
+                st = AUTH_ERR_IO;
         }
+        if (in)
+            fclose(in);
+        if (out && fclose(out) != 0)
+            st = AUTH_ERR_IO;
 
-        if (used == cap)
+        if (st == AUTH_OK)
+        {
+            fclose(g_store.journal);
+            g_store.journal = NULL;
+            if (auth_rename_replace(tmp_path, journal_path) == 0)
+                g_store.journal_records = kept;
+            else
+                st = AUTH_ERR_IO;
+            g_store.journal = fopen(journal_path, "a");
+            if (!g_store.journal)
+                st = AUTH_ERR_IO;
+        }
+        else
         {
-            size_t new_cap = cap == 0 ? 8 : cap * 2;
-            AuthUser *tmp = (AuthUser *)realloc(list, new_cap * sizeof(AuthUser));
-            if (!tmp)
-            {
-                fclose(f);
-                free(list);
-                return AUTH_ERR_IO;
-            }
-            list = tmp;
-            cap  = new_cap;
+            remove(tmp_path);
         }
-        list[used++] = u;
     }
+    g_store.compacting = 0;
+    auth_unlock_exclusive();
 
-    fclose(f);
+    free(path);
+    auth_unlock_compact();
+    return st;
+}
 
-    *out_users = list;
-    *out_count = used;
-    return AUTH_OK;
+AuthStatus auth_list_users(const char *csv_path,
+                           AuthUser **out_users,
+                           size_t *out_count)
+{
+    if (!csv_path || !out_users || !out_count)
+        return AUTH_ERR_INVALID;
+
+    auth_lock_shared();
+    if (auth_store_covers(csv_path))
+    {
+        AuthStatus st = AUTH_OK;
+        AuthUser  *copy = NULL;
+
+        /* Toujours un bloc alloué, même vide, comme la lecture fichier. */
+        copy = (AuthUser *)malloc((g_store.count ? g_store.count : 1) * sizeof(AuthUser));
+        if (copy)
+        {
+            if (g_store.count)
+                memcpy(copy, g_store.users, g_store.count * sizeof(AuthUser));
+            *out_users = copy;
+            *out_count = g_store.count;
+        }
+        else
+        {
+            st = AUTH_ERR_IO;
+        }
+        auth_unlock_shared();
+        return st;
+    }
+    auth_unlock_shared();
+
+    return auth_read_file(csv_path, out_users, out_count);
 }
 
 void auth_free_user_list(AuthUser *users)
@@ -168,27 +905,36 @@ void auth_free_user_list(AuthUser *users)
 }
 
 /**
- * @brief Sauvegarde une liste d'utilisateurs complète dans le CSV (remplacement).
+ * @brief Inscription dans le store : la persistance a lieu avant que le
+ *        nouvel utilisateur ne devienne visible, rien à annuler en cas d'échec.
  */
-static AuthStatus auth_save_all(const char *csv_path,
-                                const AuthUser *users,
-                                size_t count)
+static AuthStatus auth_store_register(const char *username,
+                                      const char *password,
+                                      const char *role)
 {
-    FILE *f = fopen(csv_path, "w");
-    if (!f)
-        return AUTH_ERR_IO;
+    if (auth_store_find(&g_store, username) != AUTH_STORE_NONE)
+        return AUTH_ERR_EXISTS;
 
-    for (size_t i = 0; i < count; ++i)
-    {
-        AuthStatus st = auth_fprint_user(f, &users[i]);
-        if (st != AUTH_OK)
-        {
-            fclose(f);
-            return st;
-        }
-    }
+    AuthStatus st = auth_store_reserve(&g_store, g_store.count + 1);
+    if (st != AUTH_OK)
+        return st;
 
-    fclose(f);
+    AuthUser *nu = &g_store.users[g_store.count];
+    memset(nu, 0, sizeof(*nu));
+    strncpy(nu->username, username, AUTH_MAX_USERNAME);
+    nu->username[AUTH_MAX_USERNAME] = '\0';
+    strncpy(nu->password, password, AUTH_MAX_PASSWORD);
+    nu->password[AUTH_MAX_PASSWORD] = '\0';
+    strncpy(nu->role, role, AUTH_MAX_ROLE);
+    nu->role[AUTH_MAX_ROLE] = '\0';
+    nu->active = 1;
+
+    st = auth_store_persist('U', nu, 1, g_store.users, g_store.count + 1);
+    if (st != AUTH_OK)
+        return st;
+
+    auth_store_index(&g_store, g_store.count, auth_hash(nu->username));
+    g_store.count++;
     return AUTH_OK;
 }
 
@@ -200,6 +946,15 @@ AuthStatus auth_register_user(const char *csv_path,
     if (!csv_path || !username || !password || !role)
         return AUTH_ERR_INVALID;
 
+    auth_lock_exclusive();
+    if (auth_store_covers(csv_path))
+    {
+        AuthStatus st = auth_store_register(username, password, role);
+        auth_unlock_exclusive();
+        return st;
+    }
+    auth_unlock_exclusive();
+
     AuthStatus st = auth_init(csv_path);
     if (st != AUTH_OK)
         return st;
@@ -207,10 +962,10 @@ AuthStatus auth_register_user(const char *csv_path,
     AuthUser *users = NULL;
     size_t    count = 0;
 
-    st = auth_list_users(csv_path, &users, &count);
+    st = auth_read_file(csv_path, &users, &count);
     if (st != AUTH_OK && st != AUTH_ERR_IO)
     {
-        /* AUTH_ERR_IO est déjà géré dans auth_list_users, ici on renvoie st. */
+        /* AUTH_ERR_IO est déjà géré dans auth_read_file, ici on renvoie st. */
         return st;
     }
 
@@ -248,6 +1003,125 @@ AuthStatus auth_register_user(const char *csv_path,
     return st;
 }
 
+/**
+ * @brief Copie les entrées d'un lot en comptes actifs à la suite de `dst`,
+ *        en vérifiant qu'aucun identifiant n'est vide ni déjà dans `known`
+ *        ou plus haut dans le lot (une seule passe, via une table de hachage).
+ *
+ * @param known Table des comptes existants (peut être vide).
+ * @return AUTH_OK, AUTH_ERR_EXISTS ou AUTH_ERR_INVALID ; `*out_index`
+ *         reçoit alors la position fautive dans le lot.
+ */
+static AuthStatus auth_batch_prepare(const AuthStore *known,
+                                     const AuthUser *users, size_t count,
+                                     AuthUser *dst, size_t *out_index)
+{
+    AuthStore  seen;
+    AuthStatus st = AUTH_OK;
+    memset(&seen, 0, sizeof(seen));
+
+    st = auth_store_reserve(&seen, count);
+    for (size_t i = 0; st == AUTH_OK && i < count; ++i)
+    {
+        AuthUser *nu = &dst[i];
+        memset(nu, 0, sizeof(*nu));
+        strncpy(nu->username, users[i].username, AUTH_MAX_USERNAME);
+        strncpy(nu->password, users[i].password, AUTH_MAX_PASSWORD);
+        strncpy(nu->role, users[i].role, AUTH_MAX_ROLE);
+        nu->active = 1;
+
+        if (nu->username[0] == '\0' || nu->password[0] == '\0' || nu->role[0] == '\0')
+            st = AUTH_ERR_INVALID;
+        else if (auth_store_find(known, nu->username) != AUTH_STORE_NONE
+                 || auth_store_find(&seen, nu->username) != AUTH_STORE_NONE)
+            st = AUTH_ERR_EXISTS;
+        else
+            st = auth_store_upsert(&seen, nu);
+
+        if (st != AUTH_OK && out_index)
+            *out_index = i;
+    }
+    auth_store_free(&seen);
+    return st;
+}
+
+/**
+ * @brief Inscription d'un lot dans le store : une seule persistance, puis
+ *        publication de tous les comptes.
+ */
+static AuthStatus auth_store_register_batch(const AuthUser *users, size_t count,
+                                            size_t *out_index)
+{
+    AuthStatus st = auth_store_reserve(&g_store, g_store.count + count);
+    if (st != AUTH_OK)
+        return st;
+
+    AuthUser *nu = &g_store.users[g_store.count];
+    st = auth_batch_prepare(&g_store, users, count, nu, out_index);
+    if (st == AUTH_OK)
+        st = auth_store_persist('U', nu, count, g_store.users, g_store.count + count);
+    if (st != AUTH_OK)
+        return st;
+
+    for (size_t i = 0; i < count; ++i)
+        auth_store_index(&g_store, g_store.count + i, auth_hash(nu[i].username));
+    g_store.count += count;
+    return AUTH_OK;
+}
+
+AuthStatus auth_register_users_batch(const char *csv_path,
+                                     const AuthUser *users,
+                                     size_t count,
+                                     size_t *out_index)
+{
+    if (!csv_path || (!users && count > 0))
+        return AUTH_ERR_INVALID;
+    if (count == 0)
+        return AUTH_OK;
+
+    auth_lock_exclusive();
+    if (auth_store_covers(csv_path))
+    {
+        AuthStatus st = auth_store_register_batch(users, count, out_index);
+        auth_unlock_exclusive();
+        return st;
+    }
+    auth_unlock_exclusive();
+
+    AuthStatus st = auth_init(csv_path);
+    if (st != AUTH_OK)
+        return st;
+
+    /* Mode fichier : base + journal relus une fois, réécrits une fois. */
+    AuthStore file;
+    memset(&file, 0, sizeof(file));
+    st = auth_store_load(&file, csv_path, NULL);
+    if (st == AUTH_OK)
+        st = auth_store_reserve(&file, file.count + count);
+    if (st == AUTH_OK)
+        st = auth_batch_prepare(&file, users, count, &file.users[file.count], out_index);
+    if (st == AUTH_OK)
+        st = auth_save_all(csv_path, file.users, file.count + count);
+    auth_store_free(&file);
+    return st;
+}
+
+/**
+ * @brief Vérifie actif + mot de passe d'un utilisateur déjà trouvé.
+ */
+static AuthStatus auth_check_user(const AuthUser *u,
+                                  const char *password,
+                                  AuthUser *out_user)
+{
+    if (!u->active)
+        return AUTH_ERR_INVALID; /* Compte inactif. */
+    if (strcmp(u->password, password) != 0)
+        return AUTH_ERR_INVALID; /* Mauvais mot de passe. */
+    if (out_user)
+        *out_user = *u;
+    return AUTH_OK;
+}
+
 AuthStatus auth_authenticate(const char *csv_path,
                              const char *username,
                              const char *password,
@@ -256,10 +1130,22 @@ AuthStatus auth_authenticate(const char *csv_path,
     if (!csv_path || !username || !password)
         return AUTH_ERR_INVALID;
 
+    auth_lock_shared();
+    if (auth_store_covers(csv_path))
+    {
+        size_t     pos = auth_store_find(&g_store, username);
+        AuthStatus st  = pos == AUTH_STORE_NONE
+                         ? AUTH_ERR_NOTFOUND
+                         : auth_check_user(&g_store.users[pos], password, out_user);
+        auth_unlock_shared();
+        return st;
+    }
+    auth_unlock_shared();
+
     AuthUser *users = NULL;
     size_t    count = 0;
 
-    AuthStatus st = auth_list_users(csv_path, &users, &count);
+    AuthStatus st = auth_read_file(csv_path, &users, &count);
     if (st != AUTH_OK)
         return st;
 
@@ -267,25 +1153,9 @@ AuthStatus auth_authenticate(const char *csv_path,
     {
         if (strcmp(users[i].username, username) == 0)
         {
-            if (!users[i].active)
-            {
-                auth_free_user_list(users);
-                return AUTH_ERR_INVALID; /* Compte inactif. */
-            }
-            if (strcmp(users[i].password, password) == 0)
-            {
-                if (out_user)
-                {
-                    *out_user = users[i];
-                }
-                auth_free_user_list(users);
-                return AUTH_OK;
-            }
-            else
-            {
-                auth_free_user_list(users);
-                return AUTH_ERR_INVALID; /* Mauvais mot de passe. */
-            }
+            st = auth_check_user(&users[i], password, out_user);
+            auth_free_user_list(users);
+            return st;
         }
     }
 
@@ -293,6 +1163,41 @@ AuthStatus auth_authenticate(const char *csv_path,
     return AUTH_ERR_NOTFOUND;
 }
 
+/**
+ * @brief Modification en place dans le store ; restaure l'ancienne valeur
+ *        si elle ne peut pas être persistée.
+ */
+static AuthStatus auth_store_update(const char *username,
+                                    const char *old_password,
+                                    const char *new_password,
+                                    int active)
+{
+    size_t pos = auth_store_find(&g_store, username);
+    if (pos == AUTH_STORE_NONE)
+        return AUTH_ERR_NOTFOUND;
+
+    AuthUser *u      = &g_store.users[pos];
+    AuthUser  before = *u;
+
+    if (new_password)
+    {
+        if (old_password && strcmp(u->password, old_password) != 0)
+            return AUTH_ERR_INVALID;
+        strncpy(u->password, new_password, AUTH_MAX_PASSWORD);
+        u->password[AUTH_MAX_PASSWORD] = '\0';
+    }
+    else
+    {
+        u->active = active ? 1 : 0;
+    }
+
+    AuthStatus st = auth_store_persist(new_password ? 'P' : 'A', u, 1,
+                                       g_store.users, g_store.count);
+    if (st != AUTH_OK)
+        *u = before;
+    return st;
+}
+
 AuthStatus auth_change_password(const char *csv_path,
                                 const char *username,
                                 const char *old_password,
@@ -301,10 +1206,19 @@ AuthStatus auth_change_password(const char *csv_path,
     if (!csv_path || !username || !new_password)
         return AUTH_ERR_INVALID;
 
+    auth_lock_exclusive();
+    if (auth_store_covers(csv_path))
+    {
+        AuthStatus st = auth_store_update(username, old_password, new_password, 0);
+        auth_unlock_exclusive();
+        return st;
+    }
+    auth_unlock_exclusive();
+
     AuthUser *users = NULL;
     size_t    count = 0;
 
-    AuthStatus st = auth_list_users(csv_path, &users, &count);
+    AuthStatus st = auth_read_file(csv_path, &users, &count);
     if (st != AUTH_OK)
         return st;
 
@@ -348,10 +1262,19 @@ AuthStatus auth_set_active(const char *csv_path,
     if (!csv_path || !username)
         return AUTH_ERR_INVALID;
 
+    auth_lock_exclusive();
+    if (auth_store_covers(csv_path))
+    {
+        AuthStatus st = auth_store_update(username, NULL, NULL, active);
+        auth_unlock_exclusive();
+        return st;
+    }
+    auth_unlock_exclusive();
+
     AuthUser *users = NULL;
     size_t    count = 0;
 
-    AuthStatus st = auth_list_users(csv_path, &users, &count);
+    AuthStatus st = auth_read_file(csv_path, &users, &count);
     if (st != AUTH_OK)
         return st;
 
@@ -377,4 +1300,3 @@ AuthStatus auth_set_active(const char *csv_path,
     auth_free_user_list(users);
     return st;
 }
-
@@ -81,6 +81,30 @@ AuthStatus auth_register_user(const char *csv_path,
                               const char *password,
                               const char *role);
 
+/**
+ * @brief Inscrit un lot d'utilisateurs en une seule opération (tout ou rien).
+ *
+ * Les doublons (avec les comptes existants ou à l'intérieur du lot) sont
+ * détectés en une passe ; si une entrée est refusée, aucun compte n'est
+ * créé. Sinon tous les comptes sont persistés d'un coup (un seul ajout au
+ * journal en mode journalisé, une seule réécriture du CSV sinon).
+ * Le champ `active` des entrées est ignoré : les comptes sont créés actifs.
+ *
+ * @param csv_path  Chemin du fichier CSV des utilisateurs.
+ * @param users     Comptes à créer (identifiant, mot de passe, rôle).
+ * @param count     Nombre de comptes.
+ * @param out_index Si non NULL, reçoit la position de l'entrée refusée en
+ *                  cas d'AUTH_ERR_EXISTS ou d'AUTH_ERR_INVALID.
+ * @return AUTH_OK si tous les comptes ont été ajoutés,
+ *         AUTH_ERR_EXISTS si un identifiant existe déjà ou est répété,
+ *         AUTH_ERR_INVALID si une entrée a un champ vide,
+ *         AUTH_ERR_IO ou AUTH_ERR_FORMAT en cas de problème de fichier.
+ */
+AuthStatus auth_register_users_batch(const char *csv_path,
+                                     const AuthUser *users,
+                                     size_t count,
+                                     size_t *out_index);
+
 /**
  * @brief Authentifie un utilisateur à partir de l'identifiant et du mot de passe.
  *
@@ -153,5 +177,65 @@ AuthStatus auth_list_users(const char *csv_path,
  */
 void auth_free_user_list(AuthUser *users);
 
+/* =========================================================
+ * STORE RESIDENT (optionnel)
+ * ========================================================= */
+
+/**
+ * @brief Charge le CSV une seule fois en mémoire et l'indexe par identifiant.
+ *
+ * Tant que le store est ouvert, toutes les fonctions `auth_*` appelées avec
+ * le même `csv_path` passent par la table de hachage en mémoire :
+ * `auth_authenticate()` devient O(1) et ne fait plus aucun appel système,
+ * les modifications mettent à jour la mémoire puis persistent le fichier.
+ * Les appels sur un autre chemin continuent de lire le fichier directement.
+ *
+ * Rappeler la fonction recharge le store (éventuellement sur un autre fichier).
+ *
+ * @param csv_path Chemin du fichier CSV des utilisateurs.
+ * @return AUTH_OK si le store est chargé,
+ *         AUTH_ERR_IO ou AUTH_ERR_FORMAT si le fichier est illisible.
+ */
+AuthStatus auth_store_open(const char *csv_path);
+
+/**
+ * @brief Libère le store résident ; les appels suivants relisent le fichier.
+ *
+ * Attend la fin d'une éventuelle compaction en cours.
+ */
+void auth_store_close(void);
+
+/**
+ * @brief Active ou désactive le mode journalisé du store.
+ *
+ * En mode journalisé, chaque modification (inscription, mot de passe,
+ * activation) ajoute une seule ligne au fichier `<csv_path>.journal` au lieu
+ * de réécrire tout le CSV. Au chargement (store ou lecture fichier), le
+ * journal est rejoué sur le CSV : le dernier enregistrement d'un identifiant
+ * l'emporte. Quand le journal dépasse la taille de la base, une compaction
+ * est lancée en arrière-plan (voir `auth_store_compact()`).
+ *
+ * Désactiver le mode replie immédiatement le journal dans le CSV.
+ *
+ * @param enabled 1 pour activer, 0 pour revenir à la réécriture complète.
+ * @return AUTH_OK si succès,
+ *         AUTH_ERR_INVALID si le store n'est pas ouvert,
+ *         AUTH_ERR_IO si le journal ou le CSV ne peut pas être écrit.
+ */
+AuthStatus auth_store_set_journal(int enabled);
+
+/**
+ * @brief Replie le journal dans un nouveau CSV (écrit à côté puis renommé).
+ *
+ * Les logins et les modifications continuent pendant l'écriture ; seules les
+ * lignes ajoutées entre-temps restent dans le journal. Sans effet si le mode
+ * journalisé n'est pas actif.
+ *
+ * @return AUTH_OK si succès (ou rien à faire),
+ *         AUTH_ERR_INVALID si le store n'est pas ouvert,
+ *         AUTH_ERR_IO en cas d'erreur de fichier (le journal reste intact).
+ */
+AuthStatus auth_store_compact(void);
+
 #endif /* AUTH_H */
 
@@ -0,0 +1,453 @@
+/**
+ * @file auth_scan.c
+ * @brief Implémentation du lecteur projeté et vectorisé de users.csv.
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L /* open/fstat/mmap en -std=c99 */
+#endif
+
+#include "auth_scan.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define AUTH_SCAN_X86 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/** Taille d'un bloc analysé d'un coup (un bit par octet dans le masque). */
+#define AUTH_SCAN_BLOCK 64
+
+/* =========================================================
+ * MASQUES DE SEPARATEURS
+ * Chaque variante renvoie, pour 64 octets, un bit à 1 par ';' ou '\n'.
+ * ========================================================= */
+
+typedef uint64_t (*AuthScanMaskFn)(const char *p);
+
+static inline uint64_t auth_scan_mask_scalar(const char *p)
+{
+    uint64_t m = 0;
+    for (int i = 0; i < AUTH_SCAN_BLOCK; ++i)
+    {
+        if (p[i] == ';' || p[i] == '\n')
+            m |= (uint64_t)1 << i;
+    }
+    return m;
+}
+
+#ifdef AUTH_SCAN_X86
+__attribute__((target("sse2")))
+static inline uint64_t auth_scan_mask_sse2(const char *p)
+{
+    const __m128i semi = _mm_set1_epi8(';');
+    const __m128i nl   = _mm_set1_epi8('\n');
+    uint64_t m = 0;
+
+    for (int i = 0; i < AUTH_SCAN_BLOCK; i += 16)
+    {
+        __m128i v  = _mm_loadu_si128((const __m128i *)(p + i));
+        __m128i eq = _mm_or_si128(_mm_cmpeq_epi8(v, semi), _mm_cmpeq_epi8(v, nl));
+        m |= (uint64_t)(uint16_t)_mm_movemask_epi8(eq) << i;
+    }
+    return m;
+}
+
+__attribute__((target("avx2")))
+static inline uint64_t auth_scan_mask_avx2(const char *p)
+{
+    const __m256i semi = _mm256_set1_epi8(';');
+    const __m256i nl   = _mm256_set1_epi8('\n');
+
+    __m256i lo = _mm256_loadu_si256((const __m256i *)p);
+    __m256i hi = _mm256_loadu_si256((const __m256i *)(p + 32));
+    __m256i el = _mm256_or_si256(_mm256_cmpeq_epi8(lo, semi), _mm256_cmpeq_epi8(lo, nl));
+    __m256i eh = _mm256_or_si256(_mm256_cmpeq_epi8(hi, semi), _mm256_cmpeq_epi8(hi, nl));
+
+    return (uint64_t)(uint32_t)_mm256_movemask_epi8(el)
+         | (uint64_t)(uint32_t)_mm256_movemask_epi8(eh) << 32;
+}
+#endif
+
+static AuthScanMaskFn g_mask_fn;
+static const char    *g_mask_name;
+
+/**
+ * @brief Choisit une fois pour toutes la meilleure variante disponible.
+ */
+static AuthScanMaskFn auth_scan_select(void)
+{
+    if (g_mask_fn)
+        return g_mask_fn;
+
+#ifdef AUTH_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        g_mask_name = "avx2";
+        return g_mask_fn = auth_scan_mask_avx2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        g_mask_name = "sse2";
+        return g_mask_fn = auth_scan_mask_sse2;
+    }
+#endif
+    g_mask_name = "scalaire";
+    return g_mask_fn = auth_scan_mask_scalar;
+}
+
+const char *auth_scan_backend(void)
+{
+    auth_scan_select();
+    return g_mask_name;
+}
+
+/* =========================================================
+ * DECOUPAGE EN LIGNES
+ * ========================================================= */
+
+/**
+ * @brief État du découpage : seules les positions des 3 premiers ';' de la
+ *        ligne en cours sont retenues (le 4e champ s'arrête de lui-même au
+ *        premier caractère non numérique).
+ */
+typedef struct
+{
+    AuthScan   *scan;
+    size_t      cap;
+    const char *line;      /**< Début de la ligne en cours. */
+    const char *semi[3];   /**< Positions des 3 premiers ';'. */
+    int         nb_semi;
+} AuthScanState;
+
+/**
+ * @brief Valeur de "actif" : vraie dès qu'un chiffre non nul apparaît dans
+ *        le nombre en tête du champ (même résultat que `atoi(...) != 0`).
+ */
+static inline int auth_scan_active(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+    if (p < end && (*p == '+' || *p == '-'))
+        ++p;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p)
+    {
+        if (*p != '0')
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Ferme la ligne terminée en `end` (position du '\n' ou fin du fichier).
+ */
+static inline AuthStatus auth_scan_end_line(AuthScanState *st, const char *end)
+{
+    const char *line = st->line;
+    int         nb   = st->nb_semi;
+
+    st->nb_semi = 0;
+    if (end > line && end[-1] == '\r')
+        --end;
+    if (nb == 0 && end == line)
+        return AUTH_OK; /* Ligne vide. */
+    if (nb < 3)
+        return AUTH_ERR_FORMAT;
+
+    const char *active = st->semi[2] + 1;
+    size_t      ulen   = (size_t)(st->semi[0] - line);
+    size_t      plen   = (size_t)(st->semi[1] - st->semi[0] - 1);
+    size_t      rlen   = (size_t)(st->semi[2] - st->semi[1] - 1);
+
+    if (ulen == 0 || plen == 0 || rlen == 0 || active >= end || *active == ';'
+        || ulen > UINT16_MAX || plen > UINT16_MAX || rlen > UINT16_MAX)
+        return AUTH_ERR_FORMAT;
+
+    AuthScan *scan = st->scan;
+    if (scan->count == st->cap)
+    {
+        size_t new_cap = st->cap * 2;
+        AuthUserView *tmp = (AuthUserView *)realloc(scan->users, new_cap * sizeof(AuthUserView));
+        if (!tmp)
+            return AUTH_ERR_IO;
+        scan->users = tmp;
+        st->cap     = new_cap;
+    }
+
+    AuthUserView *v = &scan->users[scan->count++];
+    v->line         = line;
+    v->username_len = (uint16_t)ulen;
+    v->password_len = (uint16_t)plen;
+    v->role_len     = (uint16_t)rlen;
+    v->active       = (uint8_t)auth_scan_active(active, end);
+    return AUTH_OK;
+}
+
+/**
+ * @brief Rang du bit à 1 le plus faible de `m` (non nul).
+ */
+static inline unsigned auth_scan_ctz64(uint64_t m)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long i;
+    _BitScanForward64(&i, m);
+    return (unsigned)i;
+#elif defined(_MSC_VER)
+    unsigned long i;
+    if ((uint32_t)m)
+    {
+        _BitScanForward(&i, (unsigned long)(uint32_t)m);
+        return (unsigned)i;
+    }
+    _BitScanForward(&i, (unsigned long)(m >> 32));
+    return (unsigned)i + 32;
+#else
+    return (unsigned)__builtin_ctzll(m);
+#endif
+}
+
+/**
+ * @brief Traite le séparateur situé en `p`.
+ */
+static inline AuthStatus auth_scan_delim(AuthScanState *st, const char *p)
+{
+    if (*p == ';')
+    {
+        if (st->nb_semi < 3)
+            st->semi[st->nb_semi++] = p;
+        return AUTH_OK;
+    }
+
+    AuthStatus s = auth_scan_end_line(st, p);
+    st->line = p + 1;
+    return s;
+}
+
+/**
+ * @brief Corps de la boucle de découpage, instancié une fois par variante de
+ *        masque pour que celui-ci soit intégré à la boucle (pas d'appel
+ *        indirect par bloc, état gardé en registres).
+ */
+#define AUTH_SCAN_SPLIT_BODY(mask_fn)                                          \
+    for (; pos + AUTH_SCAN_BLOCK <= size; pos += AUTH_SCAN_BLOCK)              \
+    {                                                                          \
+        uint64_t m = mask_fn(data + pos);                                      \
+        while (m)                                                              \
+        {                                                                      \
+            AuthStatus s = auth_scan_delim(st, data + pos + auth_scan_ctz64(m)); \
+            if (s != AUTH_OK)                                                  \
+                return s;                                                      \
+            m &= m - 1;                                                        \
+        }                                                                      \
+    }                                                                          \
+    return AUTH_OK;
+
+typedef AuthStatus (*AuthScanBlocksFn)(AuthScanState *st, const char *data,
+                                       size_t size, size_t pos);
+
+static AuthStatus auth_scan_blocks_scalar(AuthScanState *st, const char *data,
+                                          size_t size, size_t pos)
+{
+    AUTH_SCAN_SPLIT_BODY(auth_scan_mask_scalar)
+}
+
+#ifdef AUTH_SCAN_X86
+__attribute__((target("sse2")))
+static AuthStatus auth_scan_blocks_sse2(AuthScanState *st, const char *data,
+                                        size_t size, size_t pos)
+{
+    AUTH_SCAN_SPLIT_BODY(auth_scan_mask_sse2)
+}
+
+__attribute__((target("avx2")))
+static AuthStatus auth_scan_blocks_avx2(AuthScanState *st, const char *data,
+                                        size_t size, size_t pos)
+{
+    AUTH_SCAN_SPLIT_BODY(auth_scan_mask_avx2)
+}
+#endif
+
+/**
+ * @brief Découpe tout le tampon `scan->data` en vues.
+ */
+static AuthStatus auth_scan_split(AuthScan *scan)
+{
+    AuthScanMaskFn   mask_fn = auth_scan_select();
+    AuthScanBlocksFn blocks  = auth_scan_blocks_scalar;
+    AuthScanState    st;
+    const char      *data = scan->data;
+    size_t           size = scan->size;
+    size_t           tail = size - size % AUTH_SCAN_BLOCK;
+
+#ifdef AUTH_SCAN_X86
+    if (mask_fn == auth_scan_mask_avx2)
+        blocks = auth_scan_blocks_avx2;
+    else if (mask_fn == auth_scan_mask_sse2)
+        blocks = auth_scan_blocks_sse2;
+#endif
+
+    memset(&st, 0, sizeof(st));
+    st.scan = scan;
+    st.line = data;
+    st.cap  = size / 24 + 1; /* ~24 octets par ligne au minimum en pratique */
+
+    scan->users = (AuthUserView *)malloc(st.cap * sizeof(AuthUserView));
+    if (!scan->users)
+        return AUTH_ERR_IO;
+
+    AuthStatus s = blocks(&st, data, size, 0);
+    if (s != AUTH_OK)
+        return s;
+
+    for (size_t pos = tail; pos < size; ++pos)
+    {
+        if (data[pos] == ';' || data[pos] == '\n')
+        {
+            s = auth_scan_delim(&st, data + pos);
+            if (s != AUTH_OK)
+                return s;
+        }
+    }
+
+    /* Dernière ligne sans '\n' final. */
+    if (st.line < data + size)
+        return auth_scan_end_line(&st, data + size);
+    return AUTH_OK;
+}
+
+/* =========================================================
+ * PROJECTION DU FICHIER
+ * ========================================================= */
+
+AuthStatus auth_scan_open(const char *csv_path, AuthScan *out)
+{
+    if (!csv_path || !out)
+        return AUTH_ERR_INVALID;
+
+    memset(out, 0, sizeof(*out));
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(csv_path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return AUTH_ERR_IO;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return AUTH_ERR_IO;
+    }
+    out->file = file;
+    out->size = (size_t)size.QuadPart;
+
+    if (out->size > 0)
+    {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (!mapping)
+        {
+            auth_scan_close(out);
+            return AUTH_ERR_IO;
+        }
+        out->mapping = mapping;
+        out->data    = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!out->data)
+        {
+            auth_scan_close(out);
+            return AUTH_ERR_IO;
+        }
+    }
+#else
+    int fd = open(csv_path, O_RDONLY);
+    if (fd < 0)
+        return AUTH_ERR_IO;
+
+    struct stat sb;
+    if (fstat(fd, &sb) != 0)
+    {
+        close(fd);
+        return AUTH_ERR_IO;
+    }
+    out->size = (size_t)sb.st_size;
+
+    if (out->size > 0)
+    {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE; /* Lecture intégrale : préchargement en un appel. */
+#endif
+        void *p = mmap(NULL, out->size, PROT_READ, flags, fd, 0);
+        if (p == MAP_FAILED)
+        {
+            close(fd);
+            out->size = 0;
+            return AUTH_ERR_IO;
+        }
+        posix_madvise(p, out->size, POSIX_MADV_SEQUENTIAL);
+        out->data = (const char *)p;
+    }
+    close(fd); /* La projection reste valide après fermeture. */
+#endif
+
+    if (out->size == 0)
+        return AUTH_OK;
+
+    AuthStatus st = auth_scan_split(out);
+    if (st != AUTH_OK)
+        auth_scan_close(out);
+    return st;
+}
+
+void auth_scan_close(AuthScan *scan)
+{
+    if (!scan)
+        return;
+
+    free(scan->users);
+#ifdef _WIN32
+    if (scan->data)
+        UnmapViewOfFile(scan->data);
+    if (scan->mapping)
+        CloseHandle((HANDLE)scan->mapping);
+    if (scan->file)
+        CloseHandle((HANDLE)scan->file);
+#else
+    if (scan->data)
+        munmap((void *)scan->data, scan->size);
+#endif
+    memset(scan, 0, sizeof(*scan));
+}
+
+/**
+ * @brief Copie un champ dans un tampon de `max` caractères + '\0'.
+ */
+static void auth_scan_copy_field(const char *src, size_t len, char *dst, size_t max)
+{
+    size_t n = len < max ? len : max;
+    memcpy(dst, src, n);
+    dst[n] = '\0';
+}
+
+void auth_scan_copy_user(const AuthUserView *view, AuthUser *out)
+{
+    auth_scan_copy_field(view->line, view->username_len, out->username, AUTH_MAX_USERNAME);
+    auth_scan_copy_field(AUTH_VIEW_PASSWORD(view), view->password_len, out->password, AUTH_MAX_PASSWORD);
+    auth_scan_copy_field(AUTH_VIEW_ROLE(view), view->role_len, out->role, AUTH_MAX_ROLE);
+    out->active = view->active;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file auth_scan.h
+ * @brief Lecture rapide de users.csv : fichier projeté en mémoire et
+ *        recherche vectorisée des séparateurs ';' et '\n'.
+ *
+ * Le fichier est projeté (mmap / MapViewOfFile) puis parcouru par blocs de
+ * 64 octets : chaque bloc donne un masque des positions de ';' et '\n'
+ * (AVX2 ou SSE2 selon le processeur, boucle scalaire sinon). Les champs ne
+ * sont pas copiés : chaque utilisateur est décrit par une vue (début de
+ * ligne + longueurs des champs, 16 octets) dans la projection, valable
+ * jusqu'à `auth_scan_close()`.
+ *
+ * Même format et mêmes règles que `auth.c` : 4 champs au moins par ligne,
+ * champs supplémentaires ignorés, CRLF accepté, lignes vides ignorées.
+ */
+
+#ifndef AUTH_SCAN_H
+#define AUTH_SCAN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "auth.h"
+
+/**
+ * @brief Utilisateur décrit par une vue dans le fichier projeté.
+ *
+ * Les trois champs sont contigus dans la ligne, séparés par un ';' :
+ * identifiant en `line`, mot de passe juste après, puis rôle. Aucun n'est
+ * terminé par '\0' ; utiliser les longueurs ou `auth_scan_copy_user()`.
+ */
+typedef struct
+{
+    const char *line;          /**< Début de la ligne (= identifiant). */
+    uint16_t    username_len;
+    uint16_t    password_len;
+    uint16_t    role_len;
+    uint8_t     active;        /**< 1 si actif, 0 sinon (même règle que atoi). */
+} AuthUserView;
+
+/** Début du mot de passe d'une vue. */
+#define AUTH_VIEW_PASSWORD(v) ((v)->line + (v)->username_len + 1)
+
+/** Début du rôle d'une vue. */
+#define AUTH_VIEW_ROLE(v) (AUTH_VIEW_PASSWORD(v) + (v)->password_len + 1)
+
+/**
+ * @brief Résultat d'un parcours : projection + tableau de vues.
+ */
+typedef struct
+{
+    const char   *data;   /**< Début de la projection (NULL si fichier vide). */
+    size_t        size;   /**< Taille du fichier en octets. */
+    AuthUserView *users;  /**< Vues, dans l'ordre du fichier. */
+    size_t        count;
+    void         *file;   /**< Handles Win32 (fichier, projection), sinon NULL. */
+    void         *mapping;
+} AuthScan;
+
+/**
+ * @brief Projette le CSV et découpe toutes ses lignes en vues.
+ *
+ * @param csv_path Chemin du fichier CSV des utilisateurs.
+ * @param out      Résultat, à libérer avec `auth_scan_close()` si AUTH_OK.
+ * @return AUTH_OK si succès,
+ *         AUTH_ERR_IO si le fichier ne peut pas être ouvert ou projeté,
+ *         AUTH_ERR_FORMAT si une ligne a moins de 4 champs, un champ vide
+ *         ou un champ de plus de 65535 octets.
+ */
+AuthStatus auth_scan_open(const char *csv_path, AuthScan *out);
+
+/**
+ * @brief Libère les vues et la projection.
+ *
+ * @param scan Résultat de `auth_scan_open()` (peut être à zéro).
+ */
+void auth_scan_close(AuthScan *scan);
+
+/**
+ * @brief Copie une vue dans un `AuthUser` (champs tronqués comme strncpy).
+ *
+ * @param view Vue source.
+ * @param out  Utilisateur rempli en sortie.
+ */
+void auth_scan_copy_user(const AuthUserView *view, AuthUser *out);
+
+/**
+ * @brief Nom de la variante de recherche utilisée ("avx2", "sse2", "scalaire").
+ */
+const char *auth_scan_backend(void);
+
+#endif /* AUTH_SCAN_H */
@@ -0,0 +1,131 @@
+/**
+ * @file bench_auth_scan.c
+ * @brief Compare l'ancien parseur de users.csv (fgets + strtok + strncpy)
+ *        au lecteur projeté et vectorisé de auth_scan.c.
+ *
+ * Génère un CSV de N lignes, le parse avec chaque méthode (meilleur de 3
+ * passes, cache disque chaud) et affiche le débit et le rapport de vitesse.
+ *
+ * Compilation :
+ * gcc -std=c99 -O2 -I.. bench_auth_scan.c ../auth_scan.c -o bench_auth_scan
+ *
+ * Usage : bench_auth_scan [nb_lignes=2000000] [fichier=bench_users.csv]
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L /* clock_gettime en -std=c99 */
+#endif
+
+#include "auth_scan.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#define NB_PASSES 3
+
+static double maintenant(void)
+{
+#ifdef _WIN32
+    LARGE_INTEGER f, c;
+    QueryPerformanceFrequency(&f);
+    QueryPerformanceCounter(&c);
+    return (double)c.QuadPart / (double)f.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+/* Copie de l'ancien chemin de auth_list_users(), pour référence. */
+static size_t parse_ancien(const char *path, AuthUser **out)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+
+    AuthUser *list = NULL;
+    size_t used = 0, cap = 0;
+    char line[512];
+
+    while (fgets(line, sizeof(line), f)) {
+        size_t len = strlen(line);
+        while (len > 0 && (line[len-1] == '\n' || line[len-1] == '\r'))
+            line[--len] = '\0';
+
+        char *username = strtok(line, ";");
+        char *password = strtok(NULL, ";");
+        char *role     = strtok(NULL, ";");
+        char *active_s = strtok(NULL, ";");
+        if (!username || !password || !role || !active_s) break;
+
+        AuthUser u;
+        strncpy(u.username, username, AUTH_MAX_USERNAME);
+        u.username[AUTH_MAX_USERNAME] = '\0';
+        strncpy(u.password, password, AUTH_MAX_PASSWORD);
+        u.password[AUTH_MAX_PASSWORD] = '\0';
+        strncpy(u.role, role, AUTH_MAX_ROLE);
+        u.role[AUTH_MAX_ROLE] = '\0';
+        u.active = atoi(active_s) ? 1 : 0;
+
+        if (used == cap) {
+            cap = cap ? cap * 2 : 8;
+            list = (AuthUser *)realloc(list, cap * sizeof(AuthUser));
+        }
+        list[used++] = u;
+    }
+    fclose(f);
+    *out = list;
+    return used;
+}
+
+int main(int argc, char **argv)
+{
+    size_t      n    = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 2000000;
+    const char *path = argc > 2 ? argv[2] : "bench_users.csv";
+
+    FILE *f = fopen(path, "w");
+    if (!f) { printf("Impossible de creer %s\n", path); return 1; }
+    for (size_t i = 0; i < n; i++)
+        fprintf(f, "electeur%zu;mdp%zu;%s;%d\n", i, i * 7919u, i % 1000 ? "votant" : "admin", i % 17 != 0);
+    fclose(f);
+
+    double best_ancien = 1e9, best_scan = 1e9;
+    size_t nb_ancien = 0, nb_scan = 0;
+
+    for (int pass = 0; pass < NB_PASSES; pass++) {
+        AuthUser *list = NULL;
+        double t0 = maintenant();
+        nb_ancien = parse_ancien(path, &list);
+        double t1 = maintenant();
+        free(list);
+        if (t1 - t0 < best_ancien) best_ancien = t1 - t0;
+
+        AuthScan scan;
+        t0 = maintenant();
+        if (auth_scan_open(path, &scan) != AUTH_OK) { printf("auth_scan_open a echoue\n"); return 1; }
+        t1 = maintenant();
+        nb_scan = scan.count;
+        auth_scan_close(&scan);
+        if (t1 - t0 < best_scan) best_scan = t1 - t0;
+    }
+
+    if (nb_ancien != nb_scan) {
+        printf("ERREUR : %zu lignes (ancien) != %zu lignes (scan)\n", nb_ancien, nb_scan);
+        return 1;
+    }
+
+    printf("lignes            : %zu\n", n);
+    printf("variante scan     : %s\n", auth_scan_backend());
+    printf("ancien (fgets)    : %8.2f ms  %8.1f Mlignes/s\n", best_ancien * 1e3, n / best_ancien / 1e6);
+    printf("auth_scan (mmap)  : %8.2f ms  %8.1f Mlignes/s\n", best_scan * 1e3, n / best_scan / 1e6);
+    printf("acceleration      : x%.1f\n", best_ancien / best_scan);
+
+    remove(path);
+    return 0;
+}
@@ -0,0 +1,424 @@
+/**
+ * @file bench_reseau.c
+ * @brief Banc d'essai en boucle locale des backends reseau Linux :
+ *        boucle bloquante d'origine, epoll et io_uring.
+ *
+ * Chaque backend est lance dans un processus fils sur son propre port, avec
+ * des etapes de session factices (pas de users.csv ni de sauvegarde) pour ne
+ * mesurer que le cout reseau. Le generateur de charge garde S sessions
+ * ouvertes en parallele (AUTH, lecture de la liste, VOTE, lecture de la
+ * reponse) jusqu'a en avoir termine N, comme les kiosques a l'ouverture.
+ *
+ * Compilation :
+ * gcc -std=c99 -O2 -I.. bench_reseau.c ../reseau_epoll.c ../reseau_uring.c ../reseau_commun.c \
+ *     ../protocole.c -o bench_reseau
+ *
+ * Usage : bench_reseau [sessions=20000] [simultanees=1000] [reflexion_ms=0]
+ *   reflexion_ms : delai entre la reception de la liste et l'envoi du vote.
+ */
+
+#define _GNU_SOURCE
+
+#include "diffusion.h"
+#include "session.h"
+#include "reseau_epoll.h"
+#include "reseau_uring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#define PORT_BASE  9870
+#define PIED_LISTE "---------------------------\n"
+
+/* =========================================================
+ * ETAPES DE SESSION FACTICES
+ * ========================================================= */
+ProfilSession sessionVerifierCompte(const char *username, const char *password)
+{
+    (void)username;
+    (void)password;
+    return PROFIL_VOTANT;
+}
+
+int sessionAuthentifier(const char *requete, char *username)
+{
+    char cmd[16], password[AUTH_MAX_PASSWORD + 1];
+    return sscanf(requete, "%15s %64s %64s", cmd, username, password) == 3
+           && strcmp(cmd, "AUTH") == 0;
+}
+
+static const char TEXTE_LISTE[] =
+    "\n--- LISTE DES CANDIDATS ---\n[1] Alice\n[2] Bob\n[0] VOTE BLANC\n" PIED_LISTE;
+static const unsigned char TRAME_LISTE[] = {
+    0, 0, 0, 23, PROTO_CANDIDATS, 0, 0, 0, 1,
+    0, 0, 0, 1, 5, 'A', 'l', 'i', 'c', 'e',
+    0, 0, 0, 2, 3, 'B', 'o', 'b'
+};
+static ListeCandidats listeBench = {
+    1, TEXTE_LISTE, sizeof(TEXTE_LISTE) - 1, TRAME_LISTE, sizeof(TRAME_LISTE), 1
+};
+
+const ListeCandidats *sessionPrendreListe(void)
+{
+    return &listeBench;   /* jamais republiee : pas de comptage */
+}
+
+void sessionRendreListe(const ListeCandidats *liste)
+{
+    (void)liste;
+}
+
+int sessionEnregistrerVote(const char *username, int idElecteur, int idCandidat)
+{
+    (void)username;
+    (void)idElecteur;
+    (void)idCandidat;
+    return 1;
+}
+
+int sessionVoterLot(const ProtoVote *votes, int nb, unsigned char *resultats)
+{
+    (void)votes;
+    memset(resultats, 0xFF, ((size_t)nb + 7) / 8);
+    return nb;
+}
+
+int sessionVoter(const char *username, const char *requete)
+{
+    (void)username;
+    return strncmp(requete, "VOTE ", 5) == 0;
+}
+
+int sessionLireVote(const char *requete, int *idElecteur, int *idCandidat)
+{
+    *idElecteur = *idCandidat = -1;
+    return strncmp(requete, "VOTE ", 5) == 0;
+}
+
+/* Pas de file de fins : les backends gardent les votes bloquants ci-dessus */
+SessionFins *sessionFinsCreer(void)
+{
+    return NULL;
+}
+
+int sessionFinsDescripteur(const SessionFins *f)
+{
+    (void)f;
+    return -1;
+}
+
+SessionVote *sessionFinsRelever(SessionFins *f)
+{
+    (void)f;
+    return NULL;
+}
+
+void sessionFinsPublier(SessionFins *f)
+{
+    (void)f;
+}
+
+SessionVote *sessionSoumettreVote(SessionFins *f, void *session, const char *username,
+                                  int idElecteur, int idCandidat)
+{
+    (void)f; (void)session; (void)username; (void)idElecteur; (void)idCandidat;
+    return NULL;
+}
+
+SessionVote *sessionSoumettreLot(SessionFins *f, void *session, const ProtoVote *votes, int nb)
+{
+    (void)f; (void)session; (void)votes; (void)nb;
+    return NULL;
+}
+
+void sessionVoteLiberer(SessionVote *v)
+{
+    (void)v;
+}
+
+/* Pas d'observateur dans ce banc : un abonnement est refuse (ferme) */
+int diffusionAbonner(Socket s, int periodeMs)
+{
+    (void)s; (void)periodeMs;
+    return 0;
+}
+
+/* =========================================================
+ * BOUCLE BLOQUANTE D'ORIGINE (un client a la fois)
+ * ========================================================= */
+static int serveurBloquant(unsigned short port)
+{
+    int un = 1;
+    struct sockaddr_in addr;
+    int ecoute = socket(AF_INET, SOCK_STREAM, 0);
+
+    setsockopt(ecoute, SOL_SOCKET, SO_REUSEADDR, &un, sizeof(un));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port        = htons(port);
+    if (bind(ecoute, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(ecoute, SOMAXCONN) < 0)
+        return 1;
+
+    while (1) {
+        char buffer[SESSION_TAILLE_MESSAGE];
+        char username[AUTH_MAX_USERNAME + 1];
+        int  client = accept(ecoute, NULL, NULL);
+        if (client < 0) continue;
+
+        ssize_t n = recv(client, buffer, sizeof(buffer) - 1, 0);
+        if (n > 0) {
+            buffer[n] = '\0';
+            if (!sessionAuthentifier(buffer, username)) {
+                send(client, "AUTH_FAIL", 9, MSG_NOSIGNAL);
+            } else {
+                send(client, "AUTH_OK", 7, MSG_NOSIGNAL);
+                send(client, listeBench.texte, listeBench.lenTexte, MSG_NOSIGNAL);
+                n = recv(client, buffer, sizeof(buffer) - 1, 0);
+                if (n > 0) {
+                    buffer[n] = '\0';
+                    if (sessionVoter(username, buffer))
+                        send(client, "OK", 2, MSG_NOSIGNAL);
+                    else
+                        send(client, "ERREUR", 6, MSG_NOSIGNAL);
+                }
+            }
+        }
+        close(client);
+    }
+    return 0;
+}
+
+/* =========================================================
+ * GENERATEUR DE CHARGE
+ * ========================================================= */
+typedef enum { C_CONNEXION, C_LISTE, C_REFLEXION, C_REPONSE } EtatClient;
+
+typedef struct Client {
+    int            fd;
+    EtatClient     etat;
+    char           recu[SESSION_TAILLE_MESSAGE];
+    size_t         lu;
+    int            numero;
+    double         debut;
+    double         echeance;      /* envoi du vote apres reflexion */
+    struct Client *suivant;       /* file d'attente de reflexion (FIFO) */
+} Client;
+
+static double maintenant(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int demarrerClient(int ep, Client *c, unsigned short port, int numero)
+{
+    struct sockaddr_in addr;
+    struct epoll_event ev;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = htons(port);
+
+    c->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (c->fd < 0) return 0;
+    if (connect(c->fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        close(c->fd);
+        return 0;
+    }
+    c->etat   = C_CONNEXION;
+    c->lu     = 0;
+    c->numero = numero;
+    c->debut  = maintenant();
+    ev.events   = EPOLLIN | EPOLLOUT | EPOLLET;
+    ev.data.ptr = c;
+    epoll_ctl(ep, EPOLL_CTL_ADD, c->fd, &ev);
+    return 1;
+}
+
+static void envoyerTout(int fd, const char *msg)
+{
+    size_t len = strlen(msg);
+    while (len > 0) {
+        ssize_t n = send(fd, msg, len, MSG_NOSIGNAL);
+        if (n <= 0) return;   /* tampon noyau vide : jamais plein pour ces tailles */
+        msg += n;
+        len -= (size_t)n;
+    }
+}
+
+/* Renvoie 1 quand la session est terminee (pair ferme), -1 sur erreur. */
+static int lireClient(Client *c)
+{
+    while (1) {
+        ssize_t n = recv(c->fd, c->recu + c->lu, sizeof(c->recu) - 1 - c->lu, 0);
+        if (n > 0) {
+            c->lu += (size_t)n;
+            c->recu[c->lu] = '\0';
+            if (c->lu == sizeof(c->recu) - 1) return -1;
+        } else if (n == 0) {
+            return 1;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;
+        } else if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+static int compareDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Joue `total` sessions, `simultanees` a la fois ; renvoie le nombre de succes. */
+static int chargeClients(unsigned short port, int total, int simultanees, int reflexionMs,
+                         double *latences)
+{
+    int     ep = epoll_create1(0);
+    Client *clients = (Client *)calloc((size_t)simultanees, sizeof(Client));
+    Client *fileTete = NULL, *fileQueue = NULL;
+    struct epoll_event evs[256];
+    int lances = 0, finis = 0, ok = 0;
+
+    for (int i = 0; i < simultanees && lances < total; i++)
+        if (demarrerClient(ep, &clients[i], port, lances)) lances++;
+
+    while (finis < lances) {
+        int delai = -1;
+        if (fileTete) {
+            delai = (int)((fileTete->echeance - maintenant()) * 1000.0) + 1;
+            if (delai < 0) delai = 0;
+        }
+        int n = epoll_wait(ep, evs, 256, delai);
+
+        /* Votes dont la reflexion est terminee */
+        double t = maintenant();
+        while (fileTete && fileTete->echeance <= t) {
+            Client *c = fileTete;
+            fileTete = c->suivant;
+            if (!fileTete) fileQueue = NULL;
+            c->etat = C_REPONSE;
+            c->lu   = 0;
+            envoyerTout(c->fd, "VOTE 1 1");
+        }
+
+        for (int i = 0; i < n; i++) {
+            Client *c = (Client *)evs[i].data.ptr;
+            int fin = 0;
+
+            if (c->etat == C_CONNEXION && (evs[i].events & EPOLLOUT)) {
+                char msg[64];
+                snprintf(msg, sizeof(msg), "AUTH v%d mdp", c->numero);
+                c->etat = C_LISTE;
+                envoyerTout(c->fd, msg);
+            }
+            if (evs[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                int r = lireClient(c);
+                if (c->etat == C_LISTE && strstr(c->recu, PIED_LISTE)) {
+                    if (reflexionMs > 0) {
+                        c->etat     = C_REFLEXION;
+                        c->echeance = maintenant() + reflexionMs / 1000.0;
+                        c->suivant  = NULL;
+                        if (fileQueue) fileQueue->suivant = c; else fileTete = c;
+                        fileQueue = c;
+                    } else {
+                        c->etat = C_REPONSE;
+                        c->lu   = 0;
+                        envoyerTout(c->fd, "VOTE 1 1");
+                        r = lireClient(c);
+                    }
+                }
+                if (r != 0 && c->etat != C_REFLEXION) {
+                    if (r > 0 && c->etat == C_REPONSE && strcmp(c->recu, "OK") == 0) {
+                        latences[ok++] = maintenant() - c->debut;
+                    }
+                    fin = 1;
+                }
+            }
+            if (fin) {
+                close(c->fd);
+                finis++;
+                if (lances < total && demarrerClient(ep, c, port, lances)) lances++;
+            }
+        }
+    }
+    free(clients);
+    close(ep);
+    return ok;
+}
+
+static void attendrePort(unsigned short port)
+{
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = htons(port);
+    for (int essai = 0; essai < 200; essai++) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        int r  = connect(fd, (struct sockaddr*)&addr, sizeof(addr));
+        close(fd);
+        if (r == 0) return;
+        usleep(10000);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int total       = argc > 1 ? atoi(argv[1]) : 20000;
+    int simultanees = argc > 2 ? atoi(argv[2]) : 1000;
+    int reflexionMs = argc > 3 ? atoi(argv[3]) : 0;
+    static const char *noms[] = { "bloquant", "epoll", "io_uring" };
+    double *latences = (double *)malloc((size_t)total * sizeof(double));
+
+    signal(SIGPIPE, SIG_IGN);
+    printf("sessions=%d simultanees=%d reflexion=%d ms\n", total, simultanees, reflexionMs);
+    printf("%-10s %10s %12s %10s %10s\n", "backend", "reussies", "sessions/s", "p50 ms", "p99 ms");
+
+    for (int k = 0; k < 3; k++) {
+        unsigned short port = (unsigned short)(PORT_BASE + k);
+        pid_t pid = fork();
+        if (pid == 0) {
+            int fd = open("/dev/null", O_WRONLY);
+            if (fd >= 0) { dup2(fd, 1); close(fd); }   /* bandeaux des serveurs */
+            if (k == 0) _exit(serveurBloquant(port));
+            if (k == 1) _exit(serveurEpoll(port, 65536, 60000));
+            _exit(serveurUring(port, 65536, 60000) < 0 ? 2 : 1);
+        }
+        attendrePort(port);
+
+        int etat = 0;
+        if (waitpid(pid, &etat, WNOHANG) == pid) {
+            printf("%-10s indisponible\n", noms[k]);
+            continue;
+        }
+
+        double t0 = maintenant();
+        int    ok = chargeClients(port, total, simultanees, reflexionMs, latences);
+        double t1 = maintenant();
+        kill(pid, SIGKILL);
+        waitpid(pid, &etat, 0);
+
+        qsort(latences, (size_t)ok, sizeof(double), compareDouble);
+        printf("%-10s %10d %12.0f %10.2f %10.2f\n", noms[k], ok, ok / (t1 - t0),
+               ok ? latences[ok / 2] * 1e3 : 0.0,
+               ok ? latences[(size_t)(ok * 0.99)] * 1e3 : 0.0);
+    }
+    free(latences);
+    return 0;
+}
@@ -0,0 +1,375 @@
+/**
+ * @file bench_serveur.c
+ * @brief Micro-bancs des fonctions chaudes du serveur, a plusieurs tailles
+ *        de liste electorale : chargement, authentification, bulletin,
+ *        votes, instantane, exports.
+ *
+ * Chaque taille tourne dans son propre processus (le programme se relance
+ * avec -n taille), dans un repertoire bench_serveur_<taille> vide : l'etat
+ * du serveur (tables, ecrivain de fond, applicateur des votes) ne se
+ * remet pas a zero autrement. La base de depart (users.csv et instantane)
+ * est ecrite directement, sans passer par l'import.
+ *
+ * Une operation est repetee par lots doubles jusqu'a durer DUREE_MIN_US
+ * (au moins une fois) ; chaque ligne donne ns/op, allocations/op (malloc,
+ * calloc, realloc de tout le processus, fils de fond compris ; glibc
+ * seulement, "-" ailleurs) et octets ecrits/op. Les messages du serveur
+ * sont envoyes vers le peripherique nul.
+ *
+ * Le journal des votes n'est pas force sur disque (PIVOTE_FSYNC=jamais)
+ * sauf si PIVOTE_FSYNC est deja defini : on mesure le code, pas le disque.
+ *
+ * Compilation : cmake -DPIVOTE_BENCH=ON (cible bench_serveur), ou
+ * gcc -std=gnu99 -O2 -I.. bench_serveur.c ../FONCTIONS_PIVOTE_SERVEUR_V2.c ../auth.c \
+ *     ../auth_scan.c ../decompte.c ../file_votes.c ../instantane.c ../journal_votes.c \
+ *     ../plateforme.c ../protocole.c ../reseau_commun.c ../reseau_epoll.c \
+ *     ../reseau_uring.c ../table_electeurs.c -lpthread -o bench_serveur
+ *
+ * Usage : bench_serveur [taille...]   (defaut : 1000 100000 10000000)
+ */
+
+#include "serveur.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if defined(_WIN32)
+#include <direct.h>
+#include <io.h>
+#define creerRepertoire(c)     _mkdir(c)
+#define changerRepertoire(c)   _chdir(c)
+#define supprimerRepertoire(c) _rmdir(c)
+#define dupliquerFd(fd)        _dup(fd)
+#define ouvrirFd(fd, m)        _fdopen((fd), (m))
+#define numeroFd(f)            _fileno(f)
+#define definirEnv(s)          _putenv(s)
+#define PERIPHERIQUE_NUL       "NUL"
+#else
+#define creerRepertoire(c)     mkdir((c), 0755)
+#define changerRepertoire(c)   chdir(c)
+#define supprimerRepertoire(c) rmdir(c)
+#define dupliquerFd(fd)        dup(fd)
+#define ouvrirFd(fd, m)        fdopen((fd), (m))
+#define numeroFd(f)            fileno(f)
+#define definirEnv(s)          putenv(s)
+#define PERIPHERIQUE_NUL       "/dev/null"
+#endif
+
+#define DUREE_MIN_US   200000   /* duree minimale d'une mesure */
+#define NB_CANDIDATS   8
+#define NB_LOGINS      4096     /* logins pre-formates pour l'authentification */
+
+/* =========================================================
+ * 1. COMPTAGE DES ALLOCATIONS
+ * ========================================================= */
+/*
+ * glibc : l'executable remplace malloc, calloc et realloc (pour tout le
+ * processus) par des versions qui comptent puis appellent l'allocateur de
+ * la glibc ; free reste le sien.
+ */
+#if defined(__GLIBC__)
+extern void *__libc_malloc(size_t n);
+extern void *__libc_calloc(size_t nb, size_t taille);
+extern void *__libc_realloc(void *p, size_t n);
+
+static volatile long nbAllocations = 0;
+
+void *malloc(size_t n)
+{
+    atomiqueIncrementer(&nbAllocations);
+    return __libc_malloc(n);
+}
+
+void *calloc(size_t nb, size_t taille)
+{
+    atomiqueIncrementer(&nbAllocations);
+    return __libc_calloc(nb, taille);
+}
+
+void *realloc(void *p, size_t n)
+{
+    atomiqueIncrementer(&nbAllocations);
+    return __libc_realloc(p, n);
+}
+
+static long allocations(void) { return nbAllocations; }
+#else
+static long allocations(void) { return -1; }
+#endif
+
+/* =========================================================
+ * 2. MESURE
+ * ========================================================= */
+typedef struct {
+    long      ops;
+    long      echecs;
+    long long us;
+    long      allocations;   /* -1 : non mesure */
+} Mesure;
+
+/* Une operation d'indice i ; renvoie 1 si elle a reussi. */
+typedef int (*OperationBench)(long i);
+
+static FILE *rapport;   /* stdout d'origine ; stdout va au peripherique nul */
+static long  taille;
+
+static Mesure mesurer(OperationBench op, long maxOps)
+{
+    Mesure    m   = {0, 0, 0, -1};
+    long      lot = 1;
+    long      a0  = allocations();
+    long long t0  = maintenantUs();
+
+    while (m.ops < maxOps) {
+        if (lot > maxOps - m.ops) lot = maxOps - m.ops;
+        for (long k = 0; k < lot; k++)
+            if (!op(m.ops + k)) m.echecs++;
+        m.ops += lot;
+        m.us   = maintenantUs() - t0;
+        if (m.us >= DUREE_MIN_US) break;
+        lot *= 2;
+    }
+    if (a0 >= 0) m.allocations = allocations() - a0;
+    return m;
+}
+
+static void afficher(const char *operation, const Mesure *m, double octetsParOp)
+{
+    char allocs[32] = "-";
+    long ops        = m->ops > 0 ? m->ops : 1;
+
+    if (m->allocations >= 0) snprintf(allocs, sizeof(allocs), "%.2f", (double)m->allocations / ops);
+    fprintf(rapport, "%-10ld %-24s %9ld %14.0f %11s %12.0f %7ld\n", taille, operation, m->ops,
+            m->us * 1000.0 / ops, allocs, octetsParOp, m->echecs);
+    fflush(rapport);
+}
+
+static long long tailleFichier(const char *chemin)
+{
+    struct stat st;
+    return stat(chemin, &st) == 0 ? (long long)st.st_size : 0;
+}
+
+/* =========================================================
+ * 3. OPERATIONS
+ * ========================================================= */
+static char logins[NB_LOGINS][32];
+static char mdps[NB_LOGINS][32];
+static long votesFaits;
+
+/* Electeur k : id k + 1, login bench<id>, mot de passe mdp<id>. */
+static void formaterCompte(long k, char *login, char *mdp)
+{
+    if (login) snprintf(login, 32, "bench%ld", k + 1);
+    if (mdp)   snprintf(mdp, 32, "mdp%ld", k + 1);
+}
+
+static int opCharger(long i)
+{
+    (void)i;
+    chargerDonnees();
+    return electeurs.nb == (int)taille;
+}
+
+static int opStoreOpen(long i)
+{
+    (void)i;
+    return auth_store_open(CSV_PATH) == AUTH_OK;
+}
+
+static int opAuth(long i)
+{
+    int k = (int)(i % NB_LOGINS);
+    return auth_authenticate(CSV_PATH, logins[k], mdps[k], NULL) == AUTH_OK;
+}
+
+static int opListe(long i)
+{
+    (void)i;
+    publierListeCandidats();
+    return 1;
+}
+
+static int opVote(long i)
+{
+    char login[32];
+    formaterCompte(i, login, NULL);
+    votesFaits = i + 1;
+    return sessionEnregistrerVote(login, (int)i + 1, candidats[i % NB_CANDIDATS].id);
+}
+
+/* Meme electeur une seconde fois : validation seule, vote refuse. */
+static int opVoteRefuse(long i)
+{
+    char login[32];
+    formaterCompte(i, login, NULL);
+    return !sessionEnregistrerVote(login, (int)i + 1, candidats[i % NB_CANDIDATS].id);
+}
+
+static int opSauvegarder(long i)
+{
+    (void)i;
+    return sauvegarderDonnees();
+}
+
+static int opExporter(long i)
+{
+    (void)i;
+    exporterVersExcel();
+    return 1;
+}
+
+static int opRapport(long i)
+{
+    (void)i;
+    genererRapportFinal();
+    return 1;
+}
+
+/* =========================================================
+ * 4. UNE TAILLE DE LISTE ELECTORALE
+ * ========================================================= */
+static const char *fichiersBench[] = {
+    CSV_PATH, FICHIER_INSTANTANE, FICHIER_INSTANTANE INSTANTANE_SUFFIXE_PREC,
+    FICHIER_JOURNAL, FICHIER_JOURNAL JOURNAL_SUFFIXE_PREC,
+    FICHIER_EXCEL, FICHIER_JSON, FICHIER_RAPPORT
+};
+
+static void nettoyer(void)
+{
+    for (size_t k = 0; k < sizeof(fichiersBench) / sizeof(fichiersBench[0]); k++)
+        remove(fichiersBench[k]);
+}
+
+/* users.csv et instantane de `taille` electeurs, NB_CANDIDATS candidats, vote ouvert. */
+static int ecrireBase(void)
+{
+    static InstantaneScrutin s;
+    TableElecteurs           t;
+    char                     login[32], mdp[32], nom[32];
+    FILE                    *f = fopen(CSV_PATH, "w");
+    int                      ok;
+
+    if (!f) return 0;
+    memset(&t, 0, sizeof(t));
+    ok = tableElecteursReserver(&t, (int)taille, (size_t)taille * 32);
+    for (long k = 0; k < taille && ok; k++) {
+        formaterCompte(k, login, mdp);
+        snprintf(nom, sizeof(nom), "Votant%ld", k + 1);
+        ok = fprintf(f, "%s;%s;votant;1\n", login, mdp) > 0
+          && tableElecteursAjouter(&t, (int)k + 1, nom, login) >= 0;
+    }
+    if (fclose(f) != 0) ok = 0;
+
+    memset(&s, 0, sizeof(s));
+    s.voteOuvert  = 1;
+    s.nbCandidats = NB_CANDIDATS;
+    for (int c = 0; c < NB_CANDIDATS; c++) {
+        s.idCandidat[c] = 101 + c;
+        snprintf(s.nomCandidat[c], INSTANTANE_NOM, "Candidat %c", 'A' + c);
+    }
+    ok = ok && instantaneEcrire(FICHIER_INSTANTANE, &s, &t);
+    tableElecteursLiberer(&t);
+    return ok;
+}
+
+static int executerTaille(void)
+{
+    char   repertoire[64];
+    Mesure m;
+
+    snprintf(repertoire, sizeof(repertoire), "bench_serveur_%ld", taille);
+    creerRepertoire(repertoire);
+    if (changerRepertoire(repertoire) != 0) {
+        fprintf(stderr, "Repertoire %s inaccessible.\n", repertoire);
+        return 1;
+    }
+    nettoyer();
+    if (!ecrireBase()) {
+        fprintf(stderr, "Base de %ld electeurs impossible a ecrire.\n", taille);
+        nettoyer();
+        return 1;
+    }
+    for (int k = 0; k < NB_LOGINS; k++)
+        formaterCompte((long)((unsigned long)k * 2654435761UL % (unsigned long)taille),
+                       logins[k], mdps[k]);
+
+    /* Demarrage : comme main() du serveur, sans l'ecran administrateur */
+    auth_init(CSV_PATH);
+    m = mesurer(opAuth, 1L << 30);
+    afficher("auth_authenticate/csv", &m, 0);
+    m = mesurer(opStoreOpen, 1);
+    afficher("auth_store_open", &m, 0);
+    m = mesurer(opAuth, 1L << 30);
+    afficher("auth_authenticate/store", &m, 0);
+    m = mesurer(opCharger, 1);
+    afficher("chargerDonnees", &m, 0);
+
+    /* Bulletin : texte et trame, reconstruits a chaque publication */
+    m = mesurer(opListe, 1L << 30);
+    const ListeCandidats *l = sessionPrendreListe();
+    afficher("publierListeCandidats", &m, l ? (double)(l->lenTexte + l->lenTrame) : 0);
+    sessionRendreListe(l);
+
+    long long journal0 = tailleFichier(FICHIER_JOURNAL);
+    m = mesurer(opVote, taille);
+    afficher("vote", &m, (double)(tailleFichier(FICHIER_JOURNAL) - journal0) / (m.ops ? m.ops : 1));
+    m = mesurer(opVoteRefuse, votesFaits);
+    afficher("vote/deja_vote", &m, 0);
+
+    m = mesurer(opSauvegarder, 1L << 30);
+    afficher("sauvegarderDonnees", &m, (double)tailleFichier(FICHIER_INSTANTANE));
+
+    long long exports = 0;
+    m = mesurer(opExporter, 1L << 30);
+    exports = tailleFichier(FICHIER_EXCEL) + tailleFichier(FICHIER_JSON)
+            + tailleFichier(FICHIER_RAPPORT);
+    afficher("exporterVersExcel", &m, (double)exports);
+    m = mesurer(opRapport, 1L << 30);
+    afficher("genererRapportFinal", &m, (double)exports);
+
+    nettoyer();
+    changerRepertoire("..");
+    supprimerRepertoire(repertoire);
+    return 0;
+}
+
+/* =========================================================
+ * 5. POINT D'ENTREE
+ * ========================================================= */
+int main(int argc, char **argv)
+{
+    static char fsync[] = "PIVOTE_FSYNC=jamais";
+    static const long defaut[] = { 1000L, 100000L, 10000000L };
+
+    if (!getenv("PIVOTE_FSYNC")) definirEnv(fsync);
+
+    /* Processus fils : une taille */
+    if (argc == 3 && strcmp(argv[1], "-n") == 0) {
+        taille = atol(argv[2]);
+        if (taille <= 0 || taille > 2000000000L) return 2;
+        fflush(stdout);
+        rapport = ouvrirFd(dupliquerFd(numeroFd(stdout)), "w");
+        if (!rapport || !freopen(PERIPHERIQUE_NUL, "w", stdout)) return 1;
+        return executerTaille();
+    }
+
+    printf("%-10s %-24s %9s %14s %11s %12s %7s\n",
+           "taille", "operation", "ops", "ns/op", "allocs/op", "octets/op", "echecs");
+    fflush(stdout);
+
+    int nb  = argc > 1 ? argc - 1 : (int)(sizeof(defaut) / sizeof(defaut[0]));
+    int ret = 0;
+    for (int k = 0; k < nb; k++) {
+        char commande[1024];
+        long n = argc > 1 ? atol(argv[k + 1]) : defaut[k];
+        snprintf(commande, sizeof(commande), "\"%s\" -n %ld", argv[0], n);
+        if (system(commande) != 0) {
+            fprintf(stderr, "Taille %ld : echec.\n", n);
+            ret = 1;
+        }
+    }
+    return ret;
+}
@@ -0,0 +1,546 @@
+/**
+ * @file pivote_bench.c
+ * @brief Generateur de charge sans saisie : N votants synthetiques contre un
+ *        vrai serveur PIVOTE, avec les fonctions du client (client_protocole.h).
+ *
+ * Chaque session fait le parcours d'un kiosque : connexion (et HELLO),
+ * AUTH, reception de la liste, VOTE, reception de la reponse. C threads
+ * enchainent les N sessions ; avec -r, la session k doit demarrer a
+ * t0 + k / debit. La duree totale d'une session se compte depuis ce depart
+ * prevu et non depuis son depart reel : si le serveur ralentit et que les
+ * sessions prennent du retard, l'attente apparait dans les latences au lieu
+ * d'etre masquee par un debit qui baisse.
+ *
+ * Avec -o, des observateurs (compte -a "login:mdp", role observateur)
+ * s'abonnent aux resultats avant le premier vote et les suivent pendant
+ * tout le banc : le rapport donne les trames recues et leur retard sur la
+ * fin des votes (temps pour voir le decompte final).
+ *
+ * Le rapport (stdout) est un objet JSON d'une ligne, a archiver pour suivre
+ * les regressions ; un resume lisible part sur stderr.
+ *
+ * Liste electorale : les electeurs premierId .. premierId + N - 1, avec les
+ * logins et mots de passe des formats -l / -m. `pivote-bench -g fichier -n N`
+ * ecrit ce CSV (id;nom;login;password) pour l'option 13 du serveur. Un
+ * electeur ne vote qu'une fois : relancer le banc demande un nouveau scrutin
+ * ou un autre -i.
+ *
+ * Compilation : cible pivote-bench du CMakeLists.txt, ou
+ * gcc -std=gnu99 -O2 -I.. pivote_bench.c ../client_protocole.c ../plateforme.c \
+ *     ../protocole.c -lpthread -o pivote-bench
+ *
+ * Usage : pivote-bench [-h hote] [-p port] [-n sessions] [-c simultanees]
+ *                      [-r sessions/s] [-i premierId] [-l format_login]
+ *                      [-m format_mdp] [-d delai_ms] [-t] [-g fichier]
+ *                      [-o observateurs] [-a login:mdp]
+ *   -t : protocole texte, sans HELLO (votants seulement).
+ */
+
+#include "auth.h"
+#include "client_protocole.h"
+#include "plateforme.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_CANDIDATS 256
+
+/* =========================================================
+ * 1. PHASES ET ERREURS
+ * ========================================================= */
+enum { PHASE_CONNEXION, PHASE_AUTH, PHASE_LISTE, PHASE_VOTE, PHASE_TOTAL, NB_PHASES };
+
+static const char *nomsPhases[NB_PHASES] = { "connexion", "auth", "liste", "vote", "total" };
+
+/* Issue d'une session ; REUSSIE ou l'etape qui a echoue */
+enum {
+    REUSSIE,
+    ERR_CONNEXION,     /* connect() ou HELLO */
+    ERR_AUTH_REFUS,    /* AUTH_FAIL : compte absent du serveur */
+    ERR_AUTH_COUPURE,  /* connexion perdue avant la reponse a AUTH */
+    ERR_LISTE,         /* liste incomplete */
+    ERR_VOTE_REFUS,    /* ERREUR : deja vote, scrutin ferme... */
+    ERR_VOTE_COUPURE,  /* connexion perdue avant la reponse au vote */
+    NB_ISSUES
+};
+
+static const char *nomsErreurs[NB_ISSUES] = {
+    "", "connexion", "authRefusee", "authCoupee", "liste", "voteRefuse", "voteCoupe"
+};
+
+/* =========================================================
+ * 2. PARAMETRES ET ETAT PARTAGE
+ * ========================================================= */
+typedef struct {
+    const char *hote;
+    int         port;
+    int         sessions;
+    int         simultanees;
+    double      debit;          /* sessions/s ; 0 : sans cadence */
+    int         premierId;
+    const char *formatLogin;
+    const char *formatMdp;
+    long        delaiMs;        /* delai de reception par socket */
+    int         texte;
+    const char *fichierListe;
+    int         observateurs;
+    const char *compteObservateur;   /* "login:mdp" */
+} Parametres;
+
+/* Suivi d'un observateur ; ecrit par son thread, lu par main() a la fin */
+typedef struct {
+    volatile long      etat;         /* 0 : en cours, 1 : abonne, 2 : coupe,
+                                        -1 : echec                             */
+    volatile long      depart;       /* votants au premier decompte            */
+    volatile long      vus;          /* votants vus depuis le depart           */
+    volatile long long tVus;         /* us : quand `vus` a atteint sa valeur    */
+    volatile long      bulletins, complets, deltas;
+} Observateur;
+
+typedef struct {
+    Parametres    p;
+    long long     t0;          /* depart du banc, en us */
+    volatile long prochaine;   /* sessions deja prises par les threads */
+
+    /* Une case par session : pas de verrou pendant la mesure */
+    long long    *latences[NB_PHASES];   /* us ; -1 : phase non atteinte */
+    signed char  *issues;
+    signed char  *modesTrames;
+
+    Observateur  *obs;
+    volatile long prochainObs;
+
+    Section       cs;
+    Condition     cvFini;
+    int           threadsFinis;
+    int           obsPrets;      /* abonnes ou en echec */
+} Banc;
+
+/* =========================================================
+ * 3. SESSION D'UN VOTANT
+ * ========================================================= */
+/* Joue la session k et note ses latences ; renvoie son issue. */
+static int jouerSession(Banc *b, int k, long long depart)
+{
+    SessionClient s;
+    char          login[AUTH_MAX_USERNAME + 1];
+    char          mdp[AUTH_MAX_PASSWORD + 1];
+    int           ids[MAX_CANDIDATS];
+    long long     t = maintenantUs(), t1;   /* phases : depuis le depart reel */
+    int           r, nb;
+
+    clientInit(&s);
+
+    /* Connexion et negociation */
+    if (!clientConnecter(&s, b->p.hote, (unsigned short)b->p.port)) {
+        clientFermer(&s);
+        return ERR_CONNEXION;
+    }
+    socketDelaiReception(s.sock, b->p.delaiMs);
+    if (!b->p.texte) {
+        if (!clientNegocier(&s, b->p.hote, (unsigned short)b->p.port)) {
+            clientFermer(&s);
+            return ERR_CONNEXION;
+        }
+        if (!s.modeTrames) socketDelaiReception(s.sock, b->p.delaiMs);
+    }
+    b->modesTrames[k] = (signed char)s.modeTrames;
+    t1 = maintenantUs();
+    b->latences[PHASE_CONNEXION][k] = t1 - t;
+    t = t1;
+
+    /* AUTH */
+    snprintf(login, sizeof(login), b->p.formatLogin, b->p.premierId + k);
+    snprintf(mdp, sizeof(mdp), b->p.formatMdp, b->p.premierId + k);
+    r = clientAuthentifier(&s, login, mdp);
+    if (r != 1) {
+        clientFermer(&s);
+        return r == 0 ? ERR_AUTH_REFUS : ERR_AUTH_COUPURE;
+    }
+    t1 = maintenantUs();
+    b->latences[PHASE_AUTH][k] = t1 - t;
+    t = t1;
+
+    /* Liste des candidats */
+    nb = clientRecevoirListe(&s, NULL, 0, ids, MAX_CANDIDATS);
+    if (nb < 0) {
+        clientFermer(&s);
+        return ERR_LISTE;
+    }
+    t1 = maintenantUs();
+    b->latences[PHASE_LISTE][k] = t1 - t;
+    t = t1;
+
+    /* VOTE : candidats a tour de role, blanc s'il n'y en a pas */
+    if (nb > MAX_CANDIDATS) nb = MAX_CANDIDATS;
+    if (!clientEnvoyerVote(&s, b->p.premierId + k, nb > 0 ? ids[k % nb] : 0)) {
+        clientFermer(&s);
+        return ERR_VOTE_COUPURE;
+    }
+    r = clientRecevoirConfirmation(&s);
+    clientFermer(&s);
+    if (r != 1) return r == 0 ? ERR_VOTE_REFUS : ERR_VOTE_COUPURE;
+    t1 = maintenantUs();
+    b->latences[PHASE_VOTE][k] = t1 - t;
+    b->latences[PHASE_TOTAL][k] = t1 - depart;
+    return REUSSIE;
+}
+
+static void threadVotant(void *arg)
+{
+    Banc *b = (Banc *)arg;
+
+    while (1) {
+        int k = (int)atomiqueIncrementer(&b->prochaine) - 1;
+        if (k >= b->p.sessions) break;
+
+        /* Depart prevu : cadence fixe, ou tout de suite sans -r */
+        long long depart = maintenantUs();
+        if (b->p.debit > 0) {
+            long long prevu = b->t0 + (long long)(k * 1000000.0 / b->p.debit);
+            if (prevu > depart) {
+                dormirMs((long)((prevu - depart) / 1000));
+                while (maintenantUs() < prevu) {}
+            }
+            depart = prevu;
+        }
+        b->issues[k] = (signed char)jouerSession(b, k, depart);
+    }
+
+    sectionEntrer(&b->cs);
+    b->threadsFinis++;
+    conditionReveiller(&b->cvFini);
+    sectionQuitter(&b->cs);
+}
+
+/* =========================================================
+ * 4. OBSERVATEURS
+ * ========================================================= */
+/* Connexion, AUTH et SUBSCRIBE ; renvoie 1 au premier decompte recu. */
+static int abonnerObservateur(Banc *b, SessionClient *s, ClientResultats *r)
+{
+    char login[AUTH_MAX_USERNAME + 1], mdp[AUTH_MAX_PASSWORD + 1];
+    const char *sep = strchr(b->p.compteObservateur, ':');
+
+    if (!sep) return 0;
+    snprintf(login, sizeof(login), "%.*s", (int)(sep - b->p.compteObservateur),
+             b->p.compteObservateur);
+    snprintf(mdp, sizeof(mdp), "%s", sep + 1);
+
+    if (!clientConnecter(s, b->p.hote, (unsigned short)b->p.port)
+        || !clientNegocier(s, b->p.hote, (unsigned short)b->p.port)
+        || !socketDelaiReception(s->sock, b->p.delaiMs)
+        || clientAuthentifier(s, login, mdp) != 1
+        || clientRecevoirListe(s, NULL, 0, NULL, 0) < 0
+        || !clientAbonner(s, 0))
+        return 0;
+    while (r->version == 0)
+        if (clientSuivreResultats(s, r) != 1) return 0;
+    return 1;
+}
+
+/* Suit les resultats jusqu'a la coupure (fin du processus, ou delai -d sans rien). */
+static void threadObservateur(void *arg)
+{
+    Banc            *b = (Banc *)arg;
+    Observateur     *o = &b->obs[atomiqueIncrementer(&b->prochainObs) - 1];
+    SessionClient    s;
+    ClientResultats *r = (ClientResultats *)calloc(1, sizeof(*r));
+
+    clientInit(&s);
+    int ok = r && abonnerObservateur(b, &s, r);
+    if (ok) o->depart = r->votants;
+    o->etat = ok ? 1 : -1;
+    sectionEntrer(&b->cs);
+    b->obsPrets++;
+    conditionReveiller(&b->cvFini);
+    sectionQuitter(&b->cs);
+
+    while (ok) {
+        o->bulletins = r->bulletins;
+        o->complets  = r->complets;
+        o->deltas    = r->deltas;
+        if (r->votants - o->depart != o->vus) {
+            o->tVus = maintenantUs();
+            barriereMemoire();
+            o->vus = r->votants - o->depart;
+        }
+        ok = clientSuivreResultats(&s, r) == 1;
+    }
+    if (o->etat == 1) o->etat = 2;   /* coupe avant la fin du banc */
+    clientFermer(&s);
+    free(r);
+}
+
+/*
+ * Attend (au plus le delai -d) que chaque observateur ait vu les `votes`
+ * du banc, puis rend le retard de chacun sur `tFin` dans `retards` (us,
+ * -1 s'il ne les a pas vus) ; renvoie le nombre d'observateurs a jour.
+ */
+static int attendreObservateurs(Banc *b, long votes, long long tFin, long long *retards)
+{
+    int n = b->p.observateurs, aJour = 0;
+
+    while (1) {
+        aJour = 0;
+        for (int i = 0; i < n; i++)
+            if (b->obs[i].etat == 1 && b->obs[i].vus >= votes) aJour++;
+        if (aJour == n || maintenantUs() - tFin > b->p.delaiMs * 1000LL) break;
+        dormirMs(5);
+    }
+    barriereMemoire();
+    for (int i = 0; i < n; i++) {
+        const Observateur *o = &b->obs[i];
+        retards[i] = (o->etat == 1 && o->vus >= votes)
+                   ? (o->tVus > tFin ? o->tVus - tFin : 0) : -1;
+    }
+    return aJour;
+}
+
+/* =========================================================
+ * 5. RAPPORT
+ * ========================================================= */
+static int comparerLL(const void *a, const void *b)
+{
+    long long x = *(const long long *)a, y = *(const long long *)b;
+    return (x > y) - (x < y);
+}
+
+/* Rang le plus proche : la plus petite valeur >= a une fraction `q` des mesures */
+static double centileMs(const long long *tri, int n, double q)
+{
+    int i = (int)(q * n + 0.999999) - 1;
+    if (n == 0) return 0.0;
+    if (i < 0) i = 0;
+    if (i >= n) i = n - 1;
+    return tri[i] / 1000.0;
+}
+
+/* Observateurs : trames recues et retard sur la fin des votes. */
+static void rapporterObservateurs(Banc *b, int aJour, long long *retards)
+{
+    int  n = b->p.observateurs, abonnes = 0, m = 0;
+    long bulletins = 0, complets = 0, deltas = 0;
+
+    for (int i = 0; i < n; i++) {
+        abonnes   += b->obs[i].etat > 0;
+        bulletins += b->obs[i].bulletins;
+        complets  += b->obs[i].complets;
+        deltas    += b->obs[i].deltas;
+        if (retards[i] >= 0) retards[m++] = retards[i];
+    }
+    qsort(retards, (size_t)m, sizeof(long long), comparerLL);
+
+    double p50 = centileMs(retards, m, 0.50), p99 = centileMs(retards, m, 0.99);
+    double max = m ? retards[m - 1] / 1000.0 : 0.0;
+    printf(",\"observateurs\":{\"demandes\":%d,\"abonnes\":%d,\"aJour\":%d,"
+           "\"bulletins\":%ld,\"complets\":%ld,\"deltas\":%ld,"
+           "\"retardFinal\":{\"p50Ms\":%.3f,\"p99Ms\":%.3f,\"maxMs\":%.3f}}",
+           n, abonnes, aJour, bulletins, complets, deltas, p50, p99, max);
+    fprintf(stderr, "observateurs : %d/%d a jour, %ld deltas, %ld complets, %ld bulletins ; "
+            "retard final p50 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+            aJour, n, deltas, complets, bulletins, p50, p99, max);
+}
+
+static void rapporter(Banc *b, double dureeS, int aJour, long long *retards)
+{
+    int n = b->p.sessions;
+    int compte[NB_ISSUES] = {0};
+    int trames = 0;
+
+    for (int k = 0; k < n; k++) {
+        compte[b->issues[k]]++;
+        trames += b->modesTrames[k];
+    }
+
+    printf("{\"sessions\":%d,\"simultanees\":%d,\"debitCible\":%.1f,\"protocole\":\"%s\","
+           "\"sessionsTrames\":%d,\"dureeS\":%.3f,\"reussies\":%d,\"debit\":%.1f,\"phases\":{",
+           n, b->p.simultanees, b->p.debit, b->p.texte ? "texte" : "auto", trames, dureeS,
+           compte[REUSSIE], dureeS > 0 ? compte[REUSSIE] / dureeS : 0.0);
+    fprintf(stderr, "%d sessions en %.2f s : %d reussies, %.1f sessions/s\n",
+            n, dureeS, compte[REUSSIE], dureeS > 0 ? compte[REUSSIE] / dureeS : 0.0);
+    fprintf(stderr, "%-10s %8s %10s %10s %10s %10s\n",
+            "phase", "mesures", "p50 ms", "p99 ms", "p999 ms", "max ms");
+
+    for (int ph = 0; ph < NB_PHASES; ph++) {
+        long long *v = b->latences[ph];
+        int        m = 0;
+
+        /* Mesures valides en tete, puis tri sur place (le tableau ne sert plus) */
+        for (int k = 0; k < n; k++)
+            if (v[k] >= 0) v[m++] = v[k];
+        qsort(v, (size_t)m, sizeof(long long), comparerLL);
+
+        double p50 = centileMs(v, m, 0.50), p99 = centileMs(v, m, 0.99);
+        double p999 = centileMs(v, m, 0.999), max = m ? v[m - 1] / 1000.0 : 0.0;
+        printf("%s\"%s\":{\"mesures\":%d,\"p50Ms\":%.3f,\"p99Ms\":%.3f,\"p999Ms\":%.3f,"
+               "\"maxMs\":%.3f}", ph ? "," : "", nomsPhases[ph], m, p50, p99, p999, max);
+        fprintf(stderr, "%-10s %8d %10.2f %10.2f %10.2f %10.2f\n",
+                nomsPhases[ph], m, p50, p99, p999, max);
+    }
+
+    printf("},\"erreurs\":{");
+    for (int i = 1; i < NB_ISSUES; i++) {
+        printf("%s\"%s\":%d", i > 1 ? "," : "", nomsErreurs[i], compte[i]);
+        if (compte[i]) fprintf(stderr, "erreurs %-12s %d\n", nomsErreurs[i], compte[i]);
+    }
+    printf("}");
+    if (b->p.observateurs > 0) rapporterObservateurs(b, aJour, retards);
+    printf("}\n");
+}
+
+/* =========================================================
+ * 6. LISTE ELECTORALE
+ * ========================================================= */
+/* Ecrit le CSV id;nom;login;password a importer cote serveur (option 13). */
+static int genererListe(const Parametres *p)
+{
+    FILE *f = fopen(p->fichierListe, "w");
+    char  login[AUTH_MAX_USERNAME + 1], mdp[AUTH_MAX_PASSWORD + 1];
+
+    if (!f) {
+        fprintf(stderr, "Impossible d'ecrire %s.\n", p->fichierListe);
+        return 0;
+    }
+    fprintf(f, "id;nom;login;password\n");
+    for (int k = 0; k < p->sessions; k++) {
+        snprintf(login, sizeof(login), p->formatLogin, p->premierId + k);
+        snprintf(mdp, sizeof(mdp), p->formatMdp, p->premierId + k);
+        fprintf(f, "%d;Votant %d;%s;%s\n", p->premierId + k, p->premierId + k, login, mdp);
+    }
+    fclose(f);
+    fprintf(stderr, "%d electeurs ecrits dans %s.\n", p->sessions, p->fichierListe);
+    return 1;
+}
+
+/* =========================================================
+ * 7. POINT D'ENTREE
+ * ========================================================= */
+static void usage(void)
+{
+    fprintf(stderr,
+            "Usage : pivote-bench [-h hote] [-p port] [-n sessions] [-c simultanees]\n"
+            "                     [-r sessions/s] [-i premierId] [-l format_login]\n"
+            "                     [-m format_mdp] [-d delai_ms] [-t] [-g fichier]\n"
+            "                     [-o observateurs] [-a login:mdp]\n");
+}
+
+static int lireParametres(int argc, char **argv, Parametres *p)
+{
+    p->hote         = "127.0.0.1";
+    p->port         = 8888;
+    p->sessions     = 1000;
+    p->simultanees  = 50;
+    p->debit        = 0;
+    p->premierId    = 1;
+    p->formatLogin  = "bench%d";
+    p->formatMdp    = "mdp%d";
+    p->delaiMs      = 10000;
+    p->texte        = 0;
+    p->fichierListe = NULL;
+    p->observateurs = 0;
+    p->compteObservateur = "observateur:observateur";
+
+    for (int i = 1; i < argc; i++) {
+        const char *o = argv[i];
+        if (strcmp(o, "-t") == 0) {
+            p->texte = 1;
+            continue;
+        }
+        if (o[0] != '-' || o[1] == '\0' || o[2] != '\0' || i + 1 >= argc) return 0;
+        const char *v = argv[++i];
+        switch (o[1]) {
+            case 'h': p->hote         = v;           break;
+            case 'p': p->port         = atoi(v);     break;
+            case 'n': p->sessions     = atoi(v);     break;
+            case 'c': p->simultanees  = atoi(v);     break;
+            case 'r': p->debit        = atof(v);     break;
+            case 'i': p->premierId    = atoi(v);     break;
+            case 'l': p->formatLogin  = v;           break;
+            case 'm': p->formatMdp    = v;           break;
+            case 'd': p->delaiMs      = atol(v);     break;
+            case 'g': p->fichierListe = v;           break;
+            case 'o': p->observateurs = atoi(v);     break;
+            case 'a': p->compteObservateur = v;      break;
+            default:  return 0;
+        }
+    }
+    return p->port > 0 && p->port < 65536 && p->sessions > 0 && p->simultanees > 0
+           && p->debit >= 0 && p->delaiMs > 0 && p->observateurs >= 0
+           && !(p->observateurs > 0 && p->texte);
+}
+
+int main(int argc, char **argv)
+{
+    Banc b;
+    int  ok = 1;
+
+    memset(&b, 0, sizeof(b));
+    if (!lireParametres(argc, argv, &b.p)) {
+        usage();
+        return 2;
+    }
+    if (b.p.fichierListe) return genererListe(&b.p) ? 0 : 1;
+    if (b.p.simultanees > b.p.sessions) b.p.simultanees = b.p.sessions;
+
+    for (int ph = 0; ph < NB_PHASES; ph++) {
+        b.latences[ph] = (long long *)malloc((size_t)b.p.sessions * sizeof(long long));
+        if (!b.latences[ph]) ok = 0;
+        else for (int k = 0; k < b.p.sessions; k++) b.latences[ph][k] = -1;
+    }
+    b.issues      = (signed char *)calloc((size_t)b.p.sessions, 1);
+    b.modesTrames = (signed char *)calloc((size_t)b.p.sessions, 1);
+    b.obs         = (Observateur *)calloc((size_t)b.p.observateurs + 1, sizeof(Observateur));
+    long long *retards = (long long *)malloc(((size_t)b.p.observateurs + 1) * sizeof(long long));
+    if (!ok || !b.issues || !b.modesTrames || !b.obs || !retards) {
+        fprintf(stderr, "Memoire insuffisante.\n");
+        return 1;
+    }
+    if (!socketsInit()) {
+        fprintf(stderr, "Initialisation des sockets echouee.\n");
+        return 1;
+    }
+
+    sectionInit(&b.cs);
+    conditionInit(&b.cvFini);
+
+    /* Observateurs abonnes avant le premier vote */
+    int obsLances = 0;
+    for (int i = 0; i < b.p.observateurs; i++)
+        obsLances += threadLancer(threadObservateur, &b);
+    sectionEntrer(&b.cs);
+    while (b.obsPrets < obsLances)
+        conditionAttendre(&b.cvFini, &b.cs, ATTENTE_INFINIE);
+    sectionQuitter(&b.cs);
+
+    b.t0 = maintenantUs();
+
+    int lances = 0;
+    for (int i = 0; i < b.p.simultanees; i++)
+        lances += threadLancer(threadVotant, &b);
+    if (lances == 0) {
+        fprintf(stderr, "Aucun thread lance.\n");
+        return 1;
+    }
+
+    sectionEntrer(&b.cs);
+    while (b.threadsFinis < lances)
+        conditionAttendre(&b.cvFini, &b.cs, ATTENTE_INFINIE);
+    sectionQuitter(&b.cs);
+
+    long long tFin    = maintenantUs();
+    long      reussies = 0;
+    int       aJour    = 0;
+    for (int k = 0; k < b.p.sessions; k++) reussies += b.issues[k] == REUSSIE;
+    if (b.p.observateurs > 0) aJour = attendreObservateurs(&b, reussies, tFin, retards);
+
+    rapporter(&b, (tFin - b.t0) / 1e6, aJour, retards);
+    socketsFin();
+
+    for (int ph = 0; ph < NB_PHASES; ph++) free(b.latences[ph]);
+    free(b.issues);
+    free(b.modesTrames);
+    free(retards);
+    return 0;
+}
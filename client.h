@@ -2,22 +2,21 @@
  * @file client.h
  * @brief Signatures des fonctions du CLIENT PIVOTE V2 (votant).
  *
- * Compilation (MinGW / Code::Blocks, C99) :
- * gcc -std=c99 -Wall client_impl.c client_main.c -o client.exe -lws2_32
+ * Compilation (Windows ou Linux, C99) : cmake -S . -B build && cmake --build build
+ * (cible pivote-client), ou le projet Code::Blocks Pivoteclient2.0.cbp.
  */
 
 #ifndef CLIENT_H
 #define CLIENT_H
 
-#include <winsock2.h>
-#include <windows.h>
 #include <stddef.h>
+#include "plateforme.h"
+#include "client_protocole.h"
 
 /* =========================================================
  * CONSTANTES
  * ========================================================= */
-#define PORT   8888
-#define BUFFER 2048
+#define PORT 8888
 
 /* =========================================================
  * 1. HELPERS CONSOLE
@@ -39,42 +38,52 @@ void lire_ligne(const char *invite, char *buffer, size_t taille);
  * 2. CONNEXION RESEAU
  * ========================================================= */
 /**
- * @brief Initialise Winsock et cree la socket TCP.
- * @param sock Pointeur vers la socket a initialiser (sortie).
+ * @brief Initialise les sockets (socketsInit) et la session, encore sans socket.
+ * @param s Session a initialiser (sortie).
  * @return 1 si succes, 0 si erreur.
  */
-int initialiserSocket(SOCKET *sock);
+int initialiserSocket(SessionClient *s);
 
 /**
  * @brief Demande l'IP du serveur a l'utilisateur et etablit la connexion.
- * @param sock Socket deja creee.
+ * @param s Session initialisee par initialiserSocket().
  * @param server_ip Buffer ou stocker l'IP saisie (taille >= 50).
  * @return 1 si connecte, 0 si echec.
  */
-int connecterAuServeur(SOCKET sock, char *server_ip);
+int connecterAuServeur(SessionClient *s, char *server_ip);
+
+/**
+ * @brief Negocie le protocole trame (HELLO / HELLO_OK, voir protocole.h).
+ * Un ancien serveur ne comprend pas HELLO et coupe la connexion : le
+ * client se reconnecte alors et garde le protocole texte.
+ * @param s         Session connectee ; sa socket est remplacee en cas de reconnexion.
+ * @param server_ip IP saisie par connecterAuServeur().
+ * @return 1 si la session peut continuer, 0 si la reconnexion a echoue.
+ */
+int negocierProtocole(SessionClient *s, const char *server_ip);
 
 /* =========================================================
  * 3. AUTHENTIFICATION
  * ========================================================= */
 /**
  * @brief Gere la boucle d'authentification (3 tentatives max).
- * Envoie "AUTH <username> <password>" et attend "AUTH_OK".
+ * Envoie "AUTH <username> <password>" (ou la trame AUTH) et attend "AUTH_OK".
  * Affiche le message mot de passe oublie uniquement en cas d'echec.
- * @param sock     Socket connectee au serveur.
+ * @param s        Session connectee au serveur.
  * @param username Buffer ou stocker le login saisi (taille >= 65).
  * @param password Buffer ou stocker le mot de passe saisi (taille >= 65).
  * @return 1 si authentifie, 0 si toutes les tentatives epuisees.
  */
-int authentifier(SOCKET sock, char *username, char *password);
+int authentifier(SessionClient *s, char *username, char *password);
 
 /* =========================================================
  * 4. VOTE
  * ========================================================= */
 /**
  * @brief Recoit et affiche la liste des candidats envoyee par le serveur.
- * @param sock Socket connectee au serveur.
+ * @param s Session connectee au serveur.
  */
-void recevoirListeCandidats(SOCKET sock);
+void recevoirListeCandidats(SessionClient *s);
 
 /**
  * @brief Boucle de saisie du vote avec confirmation.
@@ -84,26 +93,26 @@ void recevoirListeCandidats(SOCKET sock);
 void saisirVote(int *idE, int *idC);
 
 /**
- * @brief Envoie le vote au serveur au format "VOTE <idE> <idC>".
- * @param sock Socket connectee au serveur.
+ * @brief Envoie le vote au serveur au format "VOTE <idE> <idC>" (ou la trame VOTE).
+ * @param s    Session connectee au serveur.
  * @param idE  ID de l'electeur.
  * @param idC  ID du candidat choisi.
  */
-void envoyerVote(SOCKET sock, int idE, int idC);
+void envoyerVote(SessionClient *s, int idE, int idC);
 
 /**
  * @brief Recoit et affiche la confirmation finale du vote.
- * @param sock Socket connectee au serveur.
+ * @param s Session connectee au serveur.
  */
-void recevoirConfirmationVote(SOCKET sock);
+void recevoirConfirmationVote(SessionClient *s);
 
 /* =========================================================
  * 5. NETTOYAGE
  * ========================================================= */
 /**
- * @brief Ferme la socket et nettoie Winsock.
- * @param sock Socket a fermer.
+ * @brief Ferme la session et libere les sockets (socketsFin).
+ * @param s Session a fermer.
  */
-void fermerConnexion(SOCKET sock);
+void fermerConnexion(SessionClient *s);
 
 #endif /* CLIENT_H */
@@ -0,0 +1,309 @@
+/**
+ * @file client_protocole.c
+ * @brief Echanges d'une session votant (voir client_protocole.h).
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L /* pthread_rwlock_t en -std=c99 */
+#endif
+
+#include "client_protocole.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PIED_LISTE_TEXTE "VOTE BLANC\n---"
+
+/* =========================================================
+ * ENVOI ET RECEPTION
+ * ========================================================= */
+/* Envoie tout le tampon, meme si send() ne prend qu'une partie. */
+static int envoyerTout(Socket sock, const char *data, size_t len)
+{
+    while (len > 0) {
+        int n = send(sock, data, (int)len, 0);
+        if (n <= 0) return 0;
+        data += n;
+        len  -= (size_t)n;
+    }
+    return 1;
+}
+
+/* Envoie les trames preparees dans `t` puis libere le tampon. */
+static int envoyerTrames(Socket sock, ProtoTampon *t)
+{
+    int ok = envoyerTout(sock, (const char *)t->data + t->debut, protoTamponTaille(t));
+    protoTamponLiberer(t);
+    return ok;
+}
+
+/*
+ * Lit la trame suivante, en recevant autant de fois que necessaire.
+ * Renvoie 1 si une trame est lue, 0 si la connexion est coupee,
+ * -1 si le flux n'est pas une suite de trames.
+ */
+static int lireTrame(SessionClient *s, ProtoTrame *trame)
+{
+    while (1) {
+        int r = protoExtraire(&s->reception, trame);
+        if (r != 0) return r;
+
+        unsigned char *zone = protoTamponReserver(&s->reception, CLIENT_TAMPON);
+        if (!zone) return 0;
+        int len = recv(s->sock, (char *)zone, CLIENT_TAMPON, 0);
+        if (len <= 0) return 0;
+        protoTamponValider(&s->reception, (size_t)len);
+    }
+}
+
+/* Ajoute `chaine` a `texte` (taille `taille`, deja `*n` octets), tronquee si besoin. */
+static void ajouterTexte(char *texte, size_t taille, size_t *n, const char *chaine)
+{
+    if (!texte) return;
+    while (*chaine && *n + 1 < taille) texte[(*n)++] = *chaine++;
+    texte[*n] = '\0';
+}
+
+/* =========================================================
+ * SESSION
+ * ========================================================= */
+void clientInit(SessionClient *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->sock = SOCKET_INVALIDE;
+}
+
+int clientConnecter(SessionClient *s, const char *ip, unsigned short port)
+{
+    struct sockaddr_in addr;
+
+    s->sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (s->sock == SOCKET_INVALIDE) return 0;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = inet_addr(ip);
+    addr.sin_port        = htons(port);
+    return connect(s->sock, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+}
+
+int clientNegocier(SessionClient *s, const char *ip, unsigned short port)
+{
+    ProtoTampon hello = {0};
+    ProtoTrame  trame;
+    int         version;
+
+    if (protoEcrireHello(&hello, PROTO_HELLO, PROTO_VERSION)
+        && envoyerTrames(s->sock, &hello)
+        && lireTrame(s, &trame) == 1
+        && trame.opcode == PROTO_HELLO_OK
+        && protoLireHello(&trame, &version))
+    {
+        s->modeTrames = 1;
+        return 1;
+    }
+
+    /* Ancien serveur : il a pris HELLO pour un AUTH rate et a ferme */
+    protoTamponLiberer(&s->reception);
+    socketFermer(s->sock);
+    s->modeTrames = 0;
+    return clientConnecter(s, ip, port);
+}
+
+int clientAuthentifier(SessionClient *s, const char *username, const char *password)
+{
+    char send_buffer[CLIENT_TAMPON];
+    char recv_buffer[CLIENT_TAMPON];
+    int  len;
+
+    if (s->modeTrames) {
+        ProtoTampon envoi = {0};
+        ProtoTrame  trame;
+        if (!protoEcrireAuth(&envoi, username, password) || !envoyerTrames(s->sock, &envoi))
+            return -1;
+        if (lireTrame(s, &trame) != 1) return -1;
+        if (trame.opcode == PROTO_AUTH_OK)   return 1;
+        if (trame.opcode == PROTO_AUTH_FAIL) return 0;
+        return -1;
+    }
+
+    /* Envoi "AUTH <username> <password>" */
+    snprintf(send_buffer, sizeof(send_buffer), "AUTH %s %s", username, password);
+    if (!envoyerTout(s->sock, send_buffer, strlen(send_buffer))) return -1;
+
+    /* Lecture reponse ; la liste peut arriver dans le meme segment */
+    len = recv(s->sock, recv_buffer, CLIENT_TAMPON - 1, 0);
+    if (len <= 0) return -1;
+    recv_buffer[len] = '\0';
+
+    if (strncmp(recv_buffer, "AUTH_OK", 7) != 0) return 0;
+    strcpy(s->resteTexte, recv_buffer + 7);
+    return 1;
+}
+
+int clientRecevoirListe(SessionClient *s, char *texte, size_t taille, int *ids, int maxIds)
+{
+    size_t n  = 0;
+    int    nb = 0;
+
+    if (texte && taille > 0) texte[0] = '\0';
+
+    if (s->modeTrames) {
+        ProtoTrame   trame;
+        ProtoLecteur l;
+        char         nom[256];
+        char         ligne[300];
+
+        if (lireTrame(s, &trame) != 1 || trame.opcode != PROTO_CANDIDATS) return -1;
+        ajouterTexte(texte, taille, &n, "\n--- LISTE DES CANDIDATS ---\n");
+        protoLecteur(&trame, &l);
+        protoLireI32(&l);   /* version du bulletin */
+        while (l.reste > 0) {
+            int id = (int)protoLireI32(&l);
+            protoLireChaine(&l, nom, sizeof(nom));
+            if (!protoLecteurOk(&l)) break;
+            snprintf(ligne, sizeof(ligne), "[%d] %s\n", id, nom);
+            ajouterTexte(texte, taille, &n, ligne);
+            if (ids && nb < maxIds) ids[nb] = id;
+            nb++;
+        }
+        ajouterTexte(texte, taille, &n, "[0] VOTE BLANC\n---------------------------\n");
+        return nb;
+    }
+
+    /* Texte : complete ce qui est arrive avec "AUTH_OK" jusqu'au pied de liste */
+    char   recv_buffer[CLIENT_TAMPON];
+    size_t lu = strlen(s->resteTexte);
+    memcpy(recv_buffer, s->resteTexte, lu + 1);
+    s->resteTexte[0] = '\0';
+    while (!strstr(recv_buffer, PIED_LISTE_TEXTE) && lu < CLIENT_TAMPON - 1) {
+        int len = recv(s->sock, recv_buffer + lu, (int)(CLIENT_TAMPON - 1 - lu), 0);
+        if (len <= 0) break;
+        lu += (size_t)len;
+        recv_buffer[lu] = '\0';
+    }
+    if (texte && taille > 0) {
+        strncpy(texte, recv_buffer, taille - 1);
+        texte[taille - 1] = '\0';
+    }
+    if (!strstr(recv_buffer, PIED_LISTE_TEXTE)) return -1;
+
+    /* Une ligne "[id] nom" par candidat, puis "[0] VOTE BLANC" */
+    for (const char *p = strstr(recv_buffer, "\n["); p; p = strstr(p + 1, "\n[")) {
+        const char *fin = strchr(p + 2, ']');
+        int         id;
+        if (!fin || sscanf(p + 2, "%d", &id) != 1 || strncmp(fin, "] VOTE BLANC", 12) == 0)
+            continue;
+        if (ids && nb < maxIds) ids[nb] = id;
+        nb++;
+    }
+    return nb;
+}
+
+int clientEnvoyerVote(SessionClient *s, int idE, int idC)
+{
+    if (s->modeTrames) {
+        ProtoTampon envoi = {0};
+        return protoEcrireVote(&envoi, idE, idC) && envoyerTrames(s->sock, &envoi);
+    }
+
+    char send_buffer[CLIENT_TAMPON];
+    /* Format : "VOTE <idElecteur> <idCandidat>" */
+    snprintf(send_buffer, sizeof(send_buffer), "VOTE %d %d", idE, idC);
+    return envoyerTout(s->sock, send_buffer, strlen(send_buffer));
+}
+
+int clientRecevoirConfirmation(SessionClient *s)
+{
+    if (s->modeTrames) {
+        ProtoTrame trame;
+        if (lireTrame(s, &trame) != 1) return -1;
+        return trame.opcode == PROTO_VOTE_OK;
+    }
+
+    char recv_buffer[CLIENT_TAMPON];
+    int len = recv(s->sock, recv_buffer, CLIENT_TAMPON - 1, 0);
+    if (len <= 0) return -1;
+    recv_buffer[len] = '\0';
+    return strcmp(recv_buffer, "OK") == 0;
+}
+
+int clientAbonner(SessionClient *s, int periodeMs)
+{
+    ProtoTampon envoi = {0};
+    return s->modeTrames && protoEcrireAbonnement(&envoi, periodeMs)
+        && envoyerTrames(s->sock, &envoi);
+}
+
+/* Indice du candidat `id` dans le dernier bulletin, -1 s'il n'y est pas. */
+static int indiceCandidat(const ClientResultats *r, int id)
+{
+    for (int i = 0; i < r->nbCandidats; i++)
+        if (r->ids[i] == id) return i;
+    return -1;
+}
+
+/* Nouveau bulletin : les voix des candidats deja connus sont gardees. */
+static int lireBulletin(const ProtoTrame *trame, ClientResultats *r)
+{
+    ProtoLecteur l;
+    int          ids[CLIENT_MAX_CANDIDATS], voix[CLIENT_MAX_CANDIDATS];
+    int          nb = 0;
+
+    protoLecteur(trame, &l);
+    protoLireI32(&l);   /* version du bulletin */
+    while (l.reste > 0 && nb < CLIENT_MAX_CANDIDATS) {
+        ids[nb] = (int)protoLireI32(&l);
+        protoLireChaine(&l, r->noms[nb], CLIENT_NOM);
+        if (!protoLecteurOk(&l)) return -1;
+        int k    = indiceCandidat(r, ids[nb]);
+        voix[nb] = k >= 0 ? r->voix[k] : 0;
+        nb++;
+    }
+    memcpy(r->ids, ids, (size_t)nb * sizeof(int));
+    memcpy(r->voix, voix, (size_t)nb * sizeof(int));
+    r->nbCandidats = nb;
+    r->bulletins++;
+    return 1;
+}
+
+int clientSuivreResultats(SessionClient *s, ClientResultats *r)
+{
+    ProtoTrame     trame;
+    ProtoResultats e;
+    ProtoVoix      voix[CLIENT_MAX_CANDIDATS];
+
+    int lu = lireTrame(s, &trame);
+    if (lu != 1) return lu;
+    if (trame.opcode == PROTO_CANDIDATS) return lireBulletin(&trame, r);
+    if ((trame.opcode != PROTO_RESULTATS && trame.opcode != PROTO_RESULTATS_DELTA)
+        || !protoLireResultats(&trame, &e, voix, CLIENT_MAX_CANDIDATS)
+        || (e.base != 0 && e.base != r->version))
+        return -1;
+
+    if (e.base == 0) {
+        for (int i = 0; i < r->nbCandidats; i++) r->voix[i] = 0;
+        r->complets++;
+    } else {
+        r->deltas++;
+    }
+    for (int k = 0; k < e.nb; k++) {
+        int i = indiceCandidat(r, voix[k].idCandidat);
+        if (i >= 0) r->voix[i] = voix[k].voix;   /* bulletin en route sinon */
+    }
+    r->version    = e.version;
+    r->voteOuvert = e.voteOuvert;
+    r->inscrits   = e.inscrits;
+    r->votants    = e.votants;
+    r->blancs     = e.blancs;
+    return 1;
+}
+
+void clientFermer(SessionClient *s)
+{
+    protoTamponLiberer(&s->reception);
+    if (s->sock != SOCKET_INVALIDE) socketFermer(s->sock);
+    s->sock          = SOCKET_INVALIDE;
+    s->modeTrames    = 0;
+    s->resteTexte[0] = '\0';
+}
@@ -0,0 +1,122 @@
+/**
+ * @file client_protocole.h
+ * @brief Echanges d'une session votant avec le serveur, sans saisie ni
+ *        affichage : HELLO, AUTH, liste des candidats, VOTE ; ou, pour un
+ *        observateur, SUBSCRIBE et resultats en direct.
+ *
+ * Le client interactif (client.h) et le generateur de charge
+ * (bench/pivote_bench.c) passent tous deux par ces fonctions. Tout l'etat
+ * d'une connexion est dans SessionClient : plusieurs sessions peuvent
+ * tourner en parallele, une par thread.
+ *
+ * Les deux protocoles du serveur sont geres (protocole.h) : trames si le
+ * serveur repond a HELLO, texte sinon ("AUTH <login> <mdp>", liste,
+ * "VOTE <idE> <idC>", "OK" / "ERREUR").
+ */
+
+#ifndef CLIENT_PROTOCOLE_H
+#define CLIENT_PROTOCOLE_H
+
+#include <stddef.h>
+#include "plateforme.h"
+#include "protocole.h"
+
+#define CLIENT_TAMPON        2048   /* octets demandes par recv() */
+#define CLIENT_MAX_CANDIDATS 128    /* = MAX_CANDIDATS du serveur  */
+#define CLIENT_NOM           256    /* chaine trame : 255 octets au plus */
+
+typedef struct {
+    Socket      sock;
+    int         modeTrames;   /* 1 : trames (HELLO accepte), 0 : texte */
+    /*
+     * Octets recus mais pas encore consommes : trame incomplete, ou debut
+     * de liste arrive colle a "AUTH_OK" en mode texte.
+     */
+    ProtoTampon reception;
+    char        resteTexte[CLIENT_TAMPON];
+} SessionClient;
+
+/** Resultats suivis par un observateur, tenus a jour par clientSuivreResultats(). */
+typedef struct {
+    long version;        /* 0 : rien recu */
+    int  voteOuvert;
+    long inscrits;
+    long votants;        /* bulletins, blancs compris */
+    long blancs;
+    int  nbCandidats;    /* du dernier bulletin recu  */
+    int  ids[CLIENT_MAX_CANDIDATS];
+    char noms[CLIENT_MAX_CANDIDATS][CLIENT_NOM];
+    int  voix[CLIENT_MAX_CANDIDATS];
+    long bulletins;      /* trames recues, par type   */
+    long complets;
+    long deltas;
+} ClientResultats;
+
+/** Session vide, sans socket. */
+void clientInit(SessionClient *s);
+
+/**
+ * @brief Ouvre une connexion TCP vers `ip`:`port` (socketsInit() deja fait).
+ * @return 1 si connecte, 0 sinon.
+ */
+int clientConnecter(SessionClient *s, const char *ip, unsigned short port);
+
+/**
+ * @brief Negocie le protocole trame (HELLO / HELLO_OK). Un ancien serveur
+ *        ne comprend pas HELLO et coupe la connexion : la session se
+ *        reconnecte alors et garde le protocole texte.
+ * @return 1 si la session peut continuer, 0 si la reconnexion a echoue.
+ */
+int clientNegocier(SessionClient *s, const char *ip, unsigned short port);
+
+/**
+ * @brief Envoie AUTH et attend la reponse.
+ * @return 1 si accepte, 0 si refuse, -1 si la connexion est perdue.
+ */
+int clientAuthentifier(SessionClient *s, const char *username, const char *password);
+
+/**
+ * @brief Recoit la liste des candidats qui suit AUTH_OK.
+ * @param texte  Recoit la liste telle qu'affichee par le client (NULL :
+ *               pas de texte).
+ * @param ids    Recoit les identifiants des candidats, sans le vote blanc
+ *               (NULL : ignores).
+ * @param maxIds Capacite de `ids`.
+ * @return Nombre de candidats (au-dela de maxIds compris), -1 si la liste
+ *         n'est pas arrivee en entier.
+ */
+int clientRecevoirListe(SessionClient *s, char *texte, size_t taille, int *ids, int maxIds);
+
+/**
+ * @brief Envoie le vote de l'electeur `idE` pour `idC` (0 : blanc).
+ * @return 1 si envoye, 0 sinon.
+ */
+int clientEnvoyerVote(SessionClient *s, int idE, int idC);
+
+/**
+ * @brief Attend la reponse au vote.
+ * @return 1 si enregistre, 0 si refuse, -1 si la connexion est perdue.
+ */
+int clientRecevoirConfirmation(SessionClient *s);
+
+/**
+ * @brief Abonne la session (compte observateur, protocole trame) aux
+ *        resultats en direct, a la place du vote.
+ * @param periodeMs Intervalle minimal entre deux mises a jour (0 : celui
+ *                  du serveur).
+ * @return 1 si envoye, 0 sinon (connexion perdue ou protocole texte).
+ */
+int clientAbonner(SessionClient *s, int periodeMs);
+
+/**
+ * @brief Attend la trame suivante de la diffusion et l'applique a `r`
+ *        (a zero au depart) : bulletin, resultats complets ou delta.
+ * @return 1 si `r` est a jour, 0 si la connexion est perdue, -1 si le
+ *         flux est invalide (dont un delta qui ne suit pas `r->version`).
+ */
+int clientSuivreResultats(SessionClient *s, ClientResultats *r);
+
+/** Ferme la socket et libere les tampons ; la session peut resservir. */
+void clientFermer(SessionClient *s);
+
+#endif /* CLIENT_PROTOCOLE_H */
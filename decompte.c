@@ -0,0 +1,275 @@
+/**
+ * @file decompte.c
+ * @brief Decompte des voix par tranches (voir decompte.h).
+ */
+
+#include "decompte.h"
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define ALIGNE_CACHE    __declspec(align(64))
+#define LOCAL_THREAD    __declspec(thread)
+#else
+#define ALIGNE_CACHE    __attribute__((aligned(64)))
+#define LOCAL_THREAD    __thread
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DECOMPTE_X86 1
+#endif
+
+/* Alignee : la taille d'une tranche est arrondie a un multiple de 64 octets */
+typedef struct ALIGNE_CACHE {
+    volatile long voix[DECOMPTE_MAX_CANDIDATS];
+    volatile long votants;
+    volatile long blancs;
+} Tranche;
+
+static Tranche          tranches[DECOMPTE_TRANCHES];
+static volatile long    prochaineTranche = 0;
+static LOCAL_THREAD int trancheThread    = -1;
+
+/* =========================================================
+ * OPERATIONS ATOMIQUES
+ * ========================================================= */
+#if defined(_MSC_VER)
+static long ajouterRelache(volatile long *p, long v) { return InterlockedExchangeAdd(p, v); }
+static long lireRelache(volatile long *p)            { return *p; }
+static void ecrireRelache(volatile long *p, long v)  { InterlockedExchange(p, v); }
+static DecompteMot ouMot(volatile DecompteMot *p, DecompteMot v)
+{
+    return (DecompteMot)InterlockedOr64((volatile LONG64 *)p, (LONG64)v);
+}
+static void etMot(volatile DecompteMot *p, DecompteMot v)
+{
+    InterlockedAnd64((volatile LONG64 *)p, (LONG64)v);
+}
+#else
+static long ajouterRelache(volatile long *p, long v) { return __atomic_fetch_add(p, v, __ATOMIC_RELAXED); }
+static long lireRelache(volatile long *p)            { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+static void ecrireRelache(volatile long *p, long v)  { __atomic_store_n(p, v, __ATOMIC_RELAXED); }
+static DecompteMot ouMot(volatile DecompteMot *p, DecompteMot v)
+{
+    return __atomic_fetch_or(p, v, __ATOMIC_ACQ_REL);
+}
+static void etMot(volatile DecompteMot *p, DecompteMot v)
+{
+    __atomic_fetch_and(p, v, __ATOMIC_RELEASE);
+}
+#endif
+
+/* Tranche du thread appelant, attribuee a son premier vote. */
+static Tranche *trancheCourante(void)
+{
+    if (trancheThread < 0)
+        trancheThread = (int)((unsigned long)ajouterRelache(&prochaineTranche, 1)
+                              % DECOMPTE_TRANCHES);
+    return &tranches[trancheThread];
+}
+
+/* =========================================================
+ * COMPTEURS
+ * ========================================================= */
+static void compterBulletin(int slot, long n)
+{
+    Tranche *t = trancheCourante();
+    ajouterRelache(&t->votants, n);
+    if (slot < 0 || slot >= DECOMPTE_MAX_CANDIDATS)
+        ajouterRelache(&t->blancs, n);
+    else
+        ajouterRelache(&t->voix[slot], n);
+}
+
+void decompteAjouter(int slot)
+{
+    compterBulletin(slot, 1);
+}
+
+void decompteRetirer(int slot)
+{
+    compterBulletin(slot, -1);
+}
+
+int decompteVoix(int slot)
+{
+    long total = 0;
+    if (slot < 0 || slot >= DECOMPTE_MAX_CANDIDATS) return 0;
+    for (int t = 0; t < DECOMPTE_TRANCHES; t++)
+        total += lireRelache(&tranches[t].voix[slot]);
+    return (int)total;
+}
+
+void decompteFixer(int slot, int voix)
+{
+    if (slot < 0 || slot >= DECOMPTE_MAX_CANDIDATS) return;
+    for (int t = 0; t < DECOMPTE_TRANCHES; t++)
+        ecrireRelache(&tranches[t].voix[slot], t == 0 ? voix : 0);
+}
+
+void decompteFixerBulletins(long votants, long blancs)
+{
+    for (int t = 0; t < DECOMPTE_TRANCHES; t++) {
+        ecrireRelache(&tranches[t].votants, t == 0 ? votants : 0);
+        ecrireRelache(&tranches[t].blancs, t == 0 ? blancs : 0);
+    }
+}
+
+void decompteAgreger(int nbCandidats, DecompteAgregats *a)
+{
+    if (nbCandidats > DECOMPTE_MAX_CANDIDATS) nbCandidats = DECOMPTE_MAX_CANDIDATS;
+    memset(a, 0, sizeof(*a));
+    a->nbCandidats = nbCandidats;
+
+    /* Une passe sur les tranches, une sur les candidats */
+    for (int t = 0; t < DECOMPTE_TRANCHES; t++) {
+        a->votants += lireRelache(&tranches[t].votants);
+        a->blancs  += lireRelache(&tranches[t].blancs);
+        for (int c = 0; c < nbCandidats; c++)
+            a->voix[c] += (int)lireRelache(&tranches[t].voix[c]);
+    }
+    a->total = a->blancs;
+    for (int c = 0; c < nbCandidats; c++) {
+        a->total += a->voix[c];
+        if (a->voix[c] > a->maxVoix) {
+            a->maxVoix  = a->voix[c];
+            a->nbEnTete = 1;
+        } else if (a->voix[c] == a->maxVoix && a->maxVoix > 0) {
+            a->nbEnTete++;
+        }
+    }
+}
+
+/* =========================================================
+ * DRAPEAUX PAR ELECTEUR
+ * ========================================================= */
+#define BIT(slot) ((DecompteMot)1 << ((slot) % 64))
+
+int decompteReserver(volatile DecompteMot *bits, int slot)
+{
+    return !(ouMot(&bits[slot / 64], BIT(slot)) & BIT(slot));
+}
+
+void decompteMarquer(volatile DecompteMot *bits, int slot)
+{
+    ouMot(&bits[slot / 64], BIT(slot));
+}
+
+void decompteLiberer(volatile DecompteMot *bits, int slot)
+{
+    etMot(&bits[slot / 64], ~BIT(slot));
+}
+
+int decompteBit(const volatile DecompteMot *bits, int slot)
+{
+    return (bits[slot / 64] & BIT(slot)) != 0;
+}
+
+/* =========================================================
+ * POPCOUNT
+ * Chaque variante compte les bits de `nb` mots complets.
+ * ========================================================= */
+typedef long (*CompterFn)(const DecompteMot *mots, size_t nb);
+
+static int popcountMot(DecompteMot v)
+{
+    /* Sans instruction dediee : addition par paires, quartets puis octets */
+    v = v - ((v >> 1) & 0x5555555555555555ULL);
+    v = (v & 0x3333333333333333ULL) + ((v >> 2) & 0x3333333333333333ULL);
+    v = (v + (v >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((v * 0x0101010101010101ULL) >> 56);
+}
+
+static long compterScalaire(const DecompteMot *mots, size_t nb)
+{
+    long total = 0;
+    for (size_t i = 0; i < nb; i++) total += popcountMot(mots[i]);
+    return total;
+}
+
+#ifdef DECOMPTE_X86
+__attribute__((target("popcnt")))
+static long compterPopcnt(const DecompteMot *mots, size_t nb)
+{
+    long total = 0;
+    for (size_t i = 0; i < nb; i++) total += __builtin_popcountll(mots[i]);
+    return total;
+}
+
+/* Table de 16 entrees par quartet (vpshufb), sommes par octet puis vpsadbw */
+__attribute__((target("avx2")))
+static long compterAvx2(const DecompteMot *mots, size_t nb)
+{
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                           0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i bas   = _mm256_set1_epi8(0x0F);
+    __m256i       somme = _mm256_setzero_si256();
+    size_t        i     = 0;
+
+    for (; i + 4 <= nb; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(mots + i));
+        __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, bas)),
+                                    _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), bas)));
+        somme = _mm256_add_epi64(somme, _mm256_sad_epu8(c, _mm256_setzero_si256()));
+    }
+    long long parts[4];
+    _mm256_storeu_si256((__m256i *)parts, somme);
+    return (long)(parts[0] + parts[1] + parts[2] + parts[3]) + compterScalaire(mots + i, nb - i);
+}
+
+__attribute__((target("avx512f,avx512vpopcntdq")))
+static long compterAvx512(const DecompteMot *mots, size_t nb)
+{
+    __m512i somme = _mm512_setzero_si512();
+    size_t  i     = 0;
+
+    for (; i + 8 <= nb; i += 8)
+        somme = _mm512_add_epi64(somme, _mm512_popcnt_epi64(_mm512_loadu_si512(mots + i)));
+    return (long)_mm512_reduce_add_epi64(somme) + compterScalaire(mots + i, nb - i);
+}
+#endif
+
+static CompterFn   compterFn;
+static const char *compterNom;
+
+/* Choisit une fois pour toutes la meilleure variante disponible. */
+static CompterFn choisirCompter(void)
+{
+    if (compterFn) return compterFn;
+#ifdef DECOMPTE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512vpopcntdq")) {
+        compterNom = "avx512";
+        return compterFn = compterAvx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        compterNom = "avx2";
+        return compterFn = compterAvx2;
+    }
+    if (__builtin_cpu_supports("popcnt")) {
+        compterNom = "popcnt";
+        return compterFn = compterPopcnt;
+    }
+#endif
+    compterNom = "scalaire";
+    return compterFn = compterScalaire;
+}
+
+const char *decompteBackend(void)
+{
+    choisirCompter();
+    return compterNom;
+}
+
+long decompteCompter(const volatile DecompteMot *bits, int nb)
+{
+    const DecompteMot *mots = (const DecompteMot *)bits;   /* lecture relachee */
+    size_t             complets = (size_t)nb / 64;
+
+    if (nb <= 0) return 0;
+    long total = choisirCompter()(mots, complets);
+    if (nb % 64)
+        total += popcountMot(mots[complets] & (BIT(nb) - 1));
+    return total;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file decompte.h
+ * @brief Decompte des voix du SERVEUR PIVOTE, sans verrou sur le chemin du vote.
+ *
+ * Chaque thread qui compte des voix ecrit dans sa propre tranche de
+ * compteurs (une tranche par thread, attribuee au premier vote, alignee
+ * sur une ligne de cache) : deux workers qui votent en meme temps ne se
+ * disputent jamais la meme ligne. Les increments sont atomiques mais sans
+ * ordre (relaxed) ; la lecture additionne les tranches. Chaque tranche
+ * compte aussi ses bulletins (votants, blancs) : un vote met a jour deux
+ * compteurs de sa tranche, et toutes les statistiques (total, tete,
+ * egalites) se deduisent d'une seule lecture, decompteAgreger(), dont le
+ * cout ne depend que du nombre de candidats.
+ *
+ * Les drapeaux par electeur ("a vote", "blanc") sont des bits, 64 par mot.
+ * Le bit "a vote" est reserve par un OU atomique qui rend l'ancienne
+ * valeur : un seul des votes concurrents d'un meme electeur obtient la
+ * reservation et peut compter sa voix. Participation et votes blancs se
+ * comptent par popcount (POPCNT, AVX2 ou AVX-512 VPOPCNTDQ selon le
+ * processeur, choisi a l'execution).
+ *
+ * Ce module ne depend d'aucune API systeme (hors MSVC : Interlocked*).
+ */
+
+#ifndef DECOMPTE_H
+#define DECOMPTE_H
+
+#include <stddef.h>
+
+#define DECOMPTE_TRANCHES      16    /* threads au-dela : tranches partagees */
+#define DECOMPTE_MAX_CANDIDATS 128   /* = MAX_CANDIDATS (serveur.h)           */
+
+/** Mot d'un ensemble de drapeaux : le bit `slot % 64` du mot `slot / 64`. */
+typedef unsigned long long DecompteMot;
+
+/** Nombre de mots pour `nb` drapeaux. */
+#define DECOMPTE_MOTS(nb) (((size_t)(nb) + 63) / 64)
+
+/** Etat agrege du scrutin, lu en une fois. */
+typedef struct {
+    long votants;        /* bulletins comptes, blancs compris           */
+    long blancs;
+    long total;          /* voix des candidats + blancs                 */
+    int  nbCandidats;
+    int  voix[DECOMPTE_MAX_CANDIDATS];
+    int  maxVoix;        /* 0 si aucun candidat n'a de voix             */
+    int  nbEnTete;       /* candidats a maxVoix (> 1 : egalite)         */
+} DecompteAgregats;
+
+/**
+ * @brief Compte un bulletin : une voix pour le candidat d'indice `slot`
+ * dans candidats[], ou un vote blanc si `slot` est hors de
+ * [0, DECOMPTE_MAX_CANDIDATS[.
+ */
+void decompteAjouter(int slot);
+
+/** Annule un bulletin compte par decompteAjouter() (lot refuse). */
+void decompteRetirer(int slot);
+
+/**
+ * @brief Voix du candidat `slot` : somme des tranches.
+ * Les votes en cours peuvent ne pas encore y figurer.
+ */
+int decompteVoix(int slot);
+
+/**
+ * @brief Fixe les voix d'un candidat (chargement de la sauvegarde).
+ * Aucun vote ne doit etre compte pendant l'appel.
+ */
+void decompteFixer(int slot, int voix);
+
+/** Fixe le nombre de bulletins (chargement), dans les memes conditions. */
+void decompteFixerBulletins(long votants, long blancs);
+
+/**
+ * @brief Lit tous les compteurs en une passe : voix de chaque candidat,
+ *        bulletins, total, score de tete et nombre de candidats a egalite.
+ * Les votes en cours peuvent ne pas encore y figurer.
+ */
+void decompteAgreger(int nbCandidats, DecompteAgregats *a);
+
+/**
+ * @brief Reserve le drapeau `slot` (0 -> 1).
+ * @return 1 si l'appelant l'a obtenu, 0 s'il etait deja leve.
+ */
+int decompteReserver(volatile DecompteMot *bits, int slot);
+
+/** Leve le drapeau `slot` (sans se soucier de son etat). */
+void decompteMarquer(volatile DecompteMot *bits, int slot);
+
+/** Baisse le drapeau `slot` (vote annule). */
+void decompteLiberer(volatile DecompteMot *bits, int slot);
+
+int decompteBit(const volatile DecompteMot *bits, int slot);
+
+/** Nombre de drapeaux leves parmi les `nb` premiers. */
+long decompteCompter(const volatile DecompteMot *bits, int nb);
+
+/** Variante de popcount retenue ("avx512", "avx2", "popcnt" ou "scalaire"). */
+const char *decompteBackend(void);
+
+#endif /* DECOMPTE_H */
@@ -0,0 +1,303 @@
+/**
+ * @file diffusion.c
+ * @brief Diffusion des resultats aux observateurs (voir diffusion.h).
+ */
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L /* pthread_rwlock_t en -std=c99 */
+#endif
+
+#include "diffusion.h"
+#include "protocole.h"
+#include "session.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Abonne {
+    Socket         sock;
+    long long      periodeMs;
+    long long      prochain;       /* pas de mise a jour avant (ms)           */
+    long long      dernierEnvoi;   /* derniers octets acceptes par le noyau   */
+    long           version;        /* resultats mis en file, 0 : aucun        */
+    unsigned long  versionListe;   /* bulletin mis en file, 0 : aucun         */
+    int            listeEnFile;    /* bulletin pas encore parti en entier     */
+    ProtoTampon    sortie;         /* trames pas encore acceptees par le noyau */
+    size_t         resteTrame;     /* octets de la trame entamee, 0 : aucune  */
+    struct Abonne *suiv;
+} Abonne;
+
+/* Derniers resultats lus et leurs trames, construites une fois pour tous */
+typedef struct {
+    SessionResultats      res;
+    long                  version;
+    const ListeCandidats *liste;
+    ProtoTampon           delta;     /* version - 1 -> version, vide si aucun */
+    ProtoTampon           complet;   /* RESULTATS de `version`                */
+} Diffusion;
+
+static Section   csDiffusion;
+static Condition cvArrivee;
+static Abonne   *arrivees       = NULL;   /* confies, pas encore pris en charge */
+static int       nbAbonnes      = 0;      /* arrivees comprises                */
+static int       periodeServeur = 0;      /* 0 : diffusion arretee             */
+
+static long long maintenantMs(void)
+{
+    return maintenantUs() / 1000;
+}
+
+/* =========================================================
+ * 1. RESULTATS
+ * ========================================================= */
+static int memesResultats(const SessionResultats *a, const SessionResultats *b)
+{
+    return a->voteOuvert == b->voteOuvert && a->inscrits == b->inscrits
+        && a->votants == b->votants && a->blancs == b->blancs
+        && a->nbCandidats == b->nbCandidats
+        && memcmp(a->voix, b->voix, (size_t)a->nbCandidats * sizeof(ProtoVoix)) == 0;
+}
+
+/*
+ * Relit le bulletin et le decompte ; si quelque chose a change, passe a la
+ * version suivante et prepare ses deux trames. Memoire insuffisante : la
+ * version precedente reste servie, le tour suivant reessaie.
+ */
+static void actualiser(Diffusion *d)
+{
+    SessionResultats      r;
+    ProtoResultats        e;
+    ProtoVoix             changees[SESSION_MAX_CANDIDATS];
+    const ListeCandidats *liste = sessionPrendreListe();
+
+    if (liste) {
+        sessionRendreListe(d->liste);
+        d->liste = liste;
+    }
+    sessionLireResultats(&r);
+    if (d->version > 0 && memesResultats(&r, &d->res)) return;
+
+    e.version    = d->version + 1;
+    e.voteOuvert = r.voteOuvert;
+    e.inscrits   = r.inscrits;
+    e.votants    = r.votants;
+    e.blancs     = r.blancs;
+
+    /* Delta : voix nouvelles ou changees (un candidat retire impose le complet) */
+    ProtoTampon delta = {0}, complet = {0};
+    int         ok    = 1;
+    if (d->version > 0 && r.nbCandidats >= d->res.nbCandidats) {
+        e.base = d->version;
+        e.nb   = 0;
+        for (int i = 0; i < r.nbCandidats; i++)
+            if (i >= d->res.nbCandidats
+                || r.voix[i].idCandidat != d->res.voix[i].idCandidat
+                || r.voix[i].voix != d->res.voix[i].voix)
+                changees[e.nb++] = r.voix[i];
+        ok = protoEcrireResultats(&delta, &e, changees);
+    }
+    e.base = 0;
+    e.nb   = r.nbCandidats;
+    ok = ok && protoEcrireResultats(&complet, &e, r.voix);
+    if (!ok) {
+        protoTamponLiberer(&delta);
+        protoTamponLiberer(&complet);
+        return;
+    }
+    protoTamponLiberer(&d->delta);
+    protoTamponLiberer(&d->complet);
+    d->delta   = delta;
+    d->complet = complet;
+    d->res     = r;
+    d->version++;
+}
+
+/* =========================================================
+ * 2. ABONNES
+ * ========================================================= */
+/* Longueur totale de la trame qui commence en tete de `t`. */
+static size_t longueurTrame(const ProtoTampon *t)
+{
+    const unsigned char *p = t->data + t->debut;
+    return 4 + (((size_t)p[0] << 24) | ((size_t)p[1] << 16) | ((size_t)p[2] << 8) | p[3]);
+}
+
+/* Envoie ce que le noyau accepte ; renvoie 0 si la connexion est perdue. */
+static int envoyerAbonne(Abonne *a, long long maintenant)
+{
+    while (protoTamponTaille(&a->sortie) > 0) {
+        int n = send(a->sock, (const char *)a->sortie.data + a->sortie.debut,
+                     (int)protoTamponTaille(&a->sortie), 0);
+        if (n <= 0) return n < 0 && socketBloquerait();
+        a->dernierEnvoi = maintenant;
+
+        /* Avance trame par trame pour savoir ou finit celle qui est entamee */
+        size_t reste = (size_t)n;
+        while (reste > 0) {
+            if (a->resteTrame == 0) a->resteTrame = longueurTrame(&a->sortie);
+            size_t k = reste < a->resteTrame ? reste : a->resteTrame;
+            a->sortie.debut += k;
+            a->resteTrame   -= k;
+            reste           -= k;
+        }
+    }
+    protoTamponVider(&a->sortie);
+    a->listeEnFile = 0;
+    return 1;
+}
+
+/* Renvoie 0 si l'observateur a ferme ; ce qu'il envoie est ignore. */
+static int toujoursConnecte(Abonne *a)
+{
+    char bloc[256];
+    int  n = recv(a->sock, bloc, sizeof(bloc), 0);
+    return n > 0 || (n < 0 && socketBloquerait());
+}
+
+/*
+ * La mise a jour precedente n'est pas partie : ne garde que la fin de la
+ * trame entamee, la suivante sera complete.
+ */
+static void abandonnerFile(Abonne *a)
+{
+    a->sortie.fin = a->sortie.debut + a->resteTrame;
+    if (a->listeEnFile) a->versionListe = 0;
+    a->version = 0;
+}
+
+/* Met en file le delta si l'abonne a la version precedente, sinon le complet. */
+static int mettreEnFile(Abonne *a, const Diffusion *d, long long maintenant)
+{
+    int ok = 1;
+
+    if (protoTamponTaille(&a->sortie) == 0) a->dernierEnvoi = maintenant;
+    if (d->liste && a->versionListe != d->liste->version) {
+        ok = protoTamponAjouter(&a->sortie, d->liste->trame, d->liste->lenTrame);
+        a->versionListe = d->liste->version;
+        a->listeEnFile  = 1;
+        a->version      = 0;          /* nouveau bulletin : resultats complets */
+    }
+    if (a->version == d->version - 1 && protoTamponTaille(&d->delta) > 0)
+        ok = ok && protoTamponAjouter(&a->sortie, d->delta.data + d->delta.debut,
+                                      protoTamponTaille(&d->delta));
+    else
+        ok = ok && protoTamponAjouter(&a->sortie, d->complet.data + d->complet.debut,
+                                      protoTamponTaille(&d->complet));
+    a->version = d->version;
+    return ok;
+}
+
+static void fermerAbonne(Abonne *a)
+{
+    socketFermer(a->sock);
+    protoTamponLiberer(&a->sortie);
+    free(a);
+    sectionEntrer(&csDiffusion);
+    nbAbonnes--;
+    sectionQuitter(&csDiffusion);
+}
+
+/* Un tour : envois en attente, puis mise a jour des abonnes dont c'est l'heure. */
+static void servir(Abonne **abonnes, const Diffusion *d, long long maintenant)
+{
+    Abonne **p = abonnes;
+
+    while (*p) {
+        Abonne *a  = *p;
+        int     ok = toujoursConnecte(a) && envoyerAbonne(a, maintenant);
+
+        if (ok && d->version > 0 && maintenant >= a->prochain
+            && (a->version != d->version
+                || (d->liste && a->versionListe != d->liste->version))) {
+            if (protoTamponTaille(&a->sortie) > 0) abandonnerFile(a);   /* en retard */
+            ok = mettreEnFile(a, d, maintenant) && envoyerAbonne(a, maintenant);
+            /* Marge d'une demi-periode : le tour suivant peut arriver un peu tot */
+            a->prochain = maintenant + a->periodeMs - periodeServeur / 2;
+        }
+        if (ok && protoTamponTaille(&a->sortie) > 0
+            && maintenant - a->dernierEnvoi > DIFFUSION_BLOCAGE_MS)
+            ok = 0;
+
+        if (ok) {
+            p = &a->suiv;
+        } else {
+            *p = a->suiv;
+            fermerAbonne(a);
+        }
+    }
+}
+
+/* =========================================================
+ * 3. THREAD DE DIFFUSION
+ * ========================================================= */
+static void threadDiffusion(void *arg)
+{
+    Diffusion d;
+    Abonne   *abonnes = NULL;
+
+    (void)arg;
+    memset(&d, 0, sizeof(d));
+    sectionEntrer(&csDiffusion);
+    while (1) {
+        while (!abonnes && !arrivees)
+            conditionAttendre(&cvArrivee, &csDiffusion, ATTENTE_INFINIE);
+        while (arrivees) {
+            Abonne *a = arrivees;
+            arrivees = a->suiv;
+            a->suiv  = abonnes;
+            abonnes  = a;
+        }
+        sectionQuitter(&csDiffusion);
+
+        actualiser(&d);
+        servir(&abonnes, &d, maintenantMs());
+
+        sectionEntrer(&csDiffusion);
+        if (!arrivees) conditionAttendre(&cvArrivee, &csDiffusion, periodeServeur);
+    }
+}
+
+int diffusionDemarrer(int periodeMs)
+{
+    if (periodeServeur) return 1;
+    if (!socketsInit()) return 0;
+    sectionInit(&csDiffusion);
+    conditionInit(&cvArrivee);
+    periodeServeur = periodeMs > 0 ? periodeMs : 1;
+    if (!threadLancer(threadDiffusion, NULL)) {
+        periodeServeur = 0;
+        return 0;
+    }
+    return 1;
+}
+
+int diffusionAbonner(Socket s, int periodeMs)
+{
+    if (!periodeServeur || !socketNonBloquant(s)) return 0;
+
+    Abonne *a = (Abonne *)calloc(1, sizeof(*a));
+    if (!a) return 0;
+    a->sock      = s;
+    a->periodeMs = periodeMs > periodeServeur ? periodeMs : periodeServeur;
+
+    sectionEntrer(&csDiffusion);
+    if (nbAbonnes >= DIFFUSION_MAX_ABONNES) {
+        sectionQuitter(&csDiffusion);
+        free(a);
+        return 0;
+    }
+    nbAbonnes++;
+    a->suiv  = arrivees;
+    arrivees = a;
+    conditionReveiller(&cvArrivee);
+    sectionQuitter(&csDiffusion);
+    return 1;
+}
+
+int diffusionNbAbonnes(void)
+{
+    if (!periodeServeur) return 0;
+    sectionEntrer(&csDiffusion);
+    int nb = nbAbonnes;
+    sectionQuitter(&csDiffusion);
+    return nb;
+}
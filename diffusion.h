@@ -0,0 +1,59 @@
+/**
+ * @file diffusion.h
+ * @brief Resultats en direct pour les observateurs (presse, partis),
+ *        abonnes par PROTO_SUBSCRIBE (voir protocole.h).
+ *
+ * Un observateur authentifie envoie SUBSCRIBE ; son backend reseau (pool,
+ * epoll, io_uring) finit d'envoyer ses reponses, confie la socket a
+ * diffusionAbonner() et l'oublie. Un seul thread sert ensuite tous les
+ * abonnes, en sockets non bloquantes :
+ *   - a chaque periode, il relit le decompte (sessionLireResultats()) ; si
+ *     quelque chose a change, il construit UNE trame RESULTATS_DELTA (voix
+ *     changees depuis la version precedente) et UNE trame RESULTATS,
+ *     copiees telles quelles chez chaque abonne ;
+ *   - un abonne recoit au plus une mise a jour par periode (la sienne si
+ *     elle est plus longue que celle du serveur) : les changements entre
+ *     deux envois sont fusionnes ;
+ *   - un abonne dont la mise a jour precedente n'est pas encore partie ne
+ *     fait attendre personne : ses trames en attente sont jetees (sauf
+ *     celle deja entamee) et remplacees par un RESULTATS complet. Sa file
+ *     ne depasse donc jamais une trame entamee, un bulletin et des
+ *     resultats ;
+ *   - un abonne qui n'accepte plus rien pendant DIFFUSION_BLOCAGE_MS est
+ *     deconnecte.
+ * Sans abonne, le thread dort : le scrutin n'en supporte aucun cout.
+ */
+
+#ifndef DIFFUSION_H
+#define DIFFUSION_H
+
+#include "plateforme.h"
+
+#define DIFFUSION_MAX_ABONNES 4096
+#define DIFFUSION_BLOCAGE_MS  60000   /* abonne qui ne lit plus : deconnecte */
+
+/**
+ * @brief Lance le thread de diffusion.
+ * @param periodeMs Intervalle minimal entre deux mises a jour d'un abonne.
+ * @return 1 si la diffusion tourne, 0 sinon (les abonnements sont alors
+ *         refuses).
+ */
+int diffusionDemarrer(int periodeMs);
+
+/**
+ * @brief Confie la socket d'un observateur a la diffusion, qui la fermera.
+ *
+ * Il recoit d'abord le bulletin (CANDIDATS) et les resultats complets,
+ * puis les mises a jour. Ce qu'il envoie ensuite est ignore.
+ *
+ * @param periodeMs Intervalle souhaite, au moins celui du serveur (0 : celui
+ *                  du serveur).
+ * @return 1 si la socket est prise, 0 si la diffusion est arretee ou
+ *         pleine (la socket reste a l'appelant).
+ */
+int diffusionAbonner(Socket s, int periodeMs);
+
+/** Abonnes servis, ou en cours de prise en charge. */
+int diffusionNbAbonnes(void);
+
+#endif /* DIFFUSION_H */
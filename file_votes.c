@@ -0,0 +1,147 @@
+/**
+ * @file file_votes.c
+ * @brief File bornee sans verrou (voir file_votes.h).
+ */
+
+#include "file_votes.h"
+#include <stdlib.h>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#endif
+
+struct FileVotesCase {
+    volatile unsigned long long sequence;
+    void                       *element;
+};
+
+/* =========================================================
+ * OPERATIONS ATOMIQUES
+ * ========================================================= */
+typedef unsigned long long Position;
+
+#if defined(_MSC_VER)
+static Position lireAcquis(volatile Position *p)
+{
+    Position v = *p;
+    _ReadWriteBarrier();
+    return v;
+}
+static void publier(volatile Position *p, Position v)
+{
+    _ReadWriteBarrier();
+    *p = v;
+}
+static int echanger(volatile Position *p, Position attendu, Position v)
+{
+    return (Position)InterlockedCompareExchange64((volatile LONG64 *)p, (LONG64)v,
+                                                  (LONG64)attendu) == attendu;
+}
+static void compter(volatile long *p) { InterlockedIncrement(p); }
+#else
+static Position lireAcquis(volatile Position *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static void publier(volatile Position *p, Position v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static int echanger(volatile Position *p, Position attendu, Position v)
+{
+    return __atomic_compare_exchange_n(p, &attendu, v, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+static void compter(volatile long *p) { __atomic_fetch_add(p, 1, __ATOMIC_RELAXED); }
+#endif
+
+/* =========================================================
+ * FILE
+ * ========================================================= */
+int fileVotesInit(FileVotes *f, unsigned long capacite)
+{
+    Position taille = 2;
+    while (taille < capacite) taille *= 2;
+
+    f->cases = (FileVotesCase *)malloc((size_t)taille * sizeof(FileVotesCase));
+    if (!f->cases) return 0;
+    /* Case i libre pour la position i */
+    for (Position i = 0; i < taille; i++) {
+        f->cases[i].sequence = i;
+        f->cases[i].element  = NULL;
+    }
+    f->masque        = taille - 1;
+    f->queue         = 0;
+    f->tete          = 0;
+    f->retraits      = 0;
+    f->profondeurMax = 0;
+    f->pleins        = 0;
+    return 1;
+}
+
+void fileVotesLiberer(FileVotes *f)
+{
+    free(f->cases);
+    f->cases = NULL;
+}
+
+int fileVotesDeposer(FileVotes *f, void *element)
+{
+    Position pos = lireAcquis(&f->queue);
+    for (;;) {
+        FileVotesCase *c   = &f->cases[pos & f->masque];
+        Position       seq = lireAcquis(&c->sequence);
+        long long      ecart = (long long)(seq - pos);
+
+        if (ecart == 0) {
+            /* Case libre pour cette position : on la prend */
+            if (echanger(&f->queue, pos, pos + 1)) {
+                c->element = element;
+                publier(&c->sequence, pos + 1);
+                return 1;
+            }
+            pos = lireAcquis(&f->queue);
+        } else if (ecart < 0) {
+            /* Encore occupee par le tour precedent : file pleine */
+            compter(&f->pleins);
+            return 0;
+        } else {
+            pos = lireAcquis(&f->queue);   /* un autre producteur est passe */
+        }
+    }
+}
+
+int fileVotesRetirer(FileVotes *f, void **elements, int max)
+{
+    Position tete       = f->tete;
+    Position profondeur = lireAcquis(&f->queue) - tete;
+    int      n          = 0;
+
+    if (profondeur > f->profondeurMax) publier(&f->profondeurMax, profondeur);
+    while (n < max) {
+        FileVotesCase *c = &f->cases[tete & f->masque];
+        if (lireAcquis(&c->sequence) != tete + 1) break;   /* vide, ou depot en cours */
+        elements[n++] = c->element;
+        /* Libre pour le tour suivant */
+        publier(&c->sequence, tete + f->masque + 1);
+        tete++;
+    }
+    if (n > 0) {
+        publier(&f->tete, tete);
+        publier(&f->retraits, f->retraits + 1);
+    }
+    return n;
+}
+
+/* Lectures d'un autre thread que le consommateur : instantane approximatif */
+unsigned long long fileVotesProfondeur(const FileVotes *f)
+{
+    FileVotes *g = (FileVotes *)f;
+    Position tete = lireAcquis(&g->tete);   /* avant la queue : jamais au-dela */
+    return lireAcquis(&g->queue) - tete;
+}
+
+void fileVotesMetriques(const FileVotes *f, FileVotesMetriques *m)
+{
+    FileVotes *g = (FileVotes *)f;
+    Position tete    = lireAcquis(&g->tete);
+    m->capacite      = g->masque + 1;
+    m->deposes       = lireAcquis(&g->queue);
+    m->profondeur    = m->deposes - tete;
+    m->profondeurMax = lireAcquis(&g->profondeurMax);
+    m->lots          = lireAcquis(&g->retraits);
+    m->pleins        = g->pleins;
+}
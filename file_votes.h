@@ -0,0 +1,73 @@
+/**
+ * @file file_votes.h
+ * @brief File bornee sans verrou, plusieurs producteurs, un consommateur.
+ *
+ * Les sessions y deposent leurs demandes de vote, l'applicateur des votes
+ * (cote serveur) les retire. Chaque case porte un numero de sequence : un
+ * producteur reserve une position par compare-and-swap sur la queue, remplit
+ * la case puis publie son numero ; le consommateur lit les cases dans
+ * l'ordre, sans operation atomique de lecture-modification-ecriture. Tete,
+ * queue et cases sont sur des lignes de cache distinctes.
+ *
+ * File pleine : le depot echoue et l'appelant decide d'attendre (pression
+ * arriere). Les compteurs (fileVotesMetriques) ne coutent rien aux
+ * producteurs hors file pleine.
+ *
+ * Ce module ne depend d'aucune API systeme (hors MSVC : Interlocked*).
+ */
+
+#ifndef FILE_VOTES_H
+#define FILE_VOTES_H
+
+typedef struct FileVotesCase FileVotesCase;
+
+typedef struct {
+    FileVotesCase      *cases;
+    unsigned long long  masque;            /* capacite - 1 (puissance de 2)  */
+    char                pad0[64];
+    volatile unsigned long long queue;     /* prochaine position a deposer */
+    char                pad1[64];
+    volatile unsigned long long tete;      /* prochaine position a retirer   */
+    volatile unsigned long long retraits;  /* lots retires (consommateur)    */
+    volatile unsigned long long profondeurMax;
+    char                pad2[64];
+    volatile long       pleins;            /* depots refuses, file pleine    */
+} FileVotes;
+
+typedef struct {
+    unsigned long long capacite;
+    unsigned long long profondeur;       /* demandes en attente            */
+    unsigned long long profondeurMax;    /* vue au retrait                 */
+    unsigned long long deposes;          /* depuis l'initialisation        */
+    unsigned long long lots;             /* retraits non vides             */
+    long               pleins;
+} FileVotesMetriques;
+
+/**
+ * @brief Alloue une file d'au moins `capacite` places (arrondie a la
+ *        puissance de 2 superieure).
+ * @return 0 si memoire insuffisante.
+ */
+int fileVotesInit(FileVotes *f, unsigned long capacite);
+
+void fileVotesLiberer(FileVotes *f);
+
+/**
+ * @brief Depose `element` (producteurs, en parallele).
+ * @return 1 si depose, 0 si la file est pleine.
+ */
+int fileVotesDeposer(FileVotes *f, void *element);
+
+/**
+ * @brief Retire au plus `max` elements dans l'ordre de depot (consommateur
+ *        unique).
+ * @return Nombre d'elements retires, 0 si la file est vide.
+ */
+int fileVotesRetirer(FileVotes *f, void **elements, int max);
+
+/** Demandes deposees et pas encore retirees (approximatif pendant un depot). */
+unsigned long long fileVotesProfondeur(const FileVotes *f);
+
+void fileVotesMetriques(const FileVotes *f, FileVotesMetriques *m);
+
+#endif /* FILE_VOTES_H */
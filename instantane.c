@@ -0,0 +1,394 @@
+/**
+ * @file instantane.c
+ * @brief Instantanes binaires de l'etat du serveur (voir instantane.h).
+ */
+
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L   /* open/fstat/mmap/fsync en -std=c99 */
+#endif
+
+#include "instantane.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define INSTANTANE_MAGIC    "PVS1"
+#define INSTANTANE_BOUTISME 0x01020304u
+#define INSTANTANE_TAMPON   (1 << 20)   /* multiple de 8 */
+
+typedef struct {
+    char               magic[4];
+    unsigned int       boutisme;       /* INSTANTANE_BOUTISME vu par l'ecrivain */
+    unsigned long long sequence;
+    unsigned long long taille;         /* fichier complet                       */
+    unsigned long long somme;          /* de tout ce qui suit l'en-tete         */
+    unsigned long long areneTaille;
+    int                voteOuvert;
+    int                nbElecteurs;
+    int                nbCandidats;
+    int                reserve;
+} EnTete;
+
+static size_t arrondi8(size_t n)
+{
+    return (n + 7) & ~(size_t)7;
+}
+
+/*
+ * Somme de Fletcher sur des mots de 64 bits (modulo 2^64) : detecte un
+ * fichier abime ou tronque au prix d'une addition par mot.
+ */
+typedef struct {
+    unsigned long long a, b;
+} Somme;
+
+static void sommer(Somme *s, const unsigned char *p, size_t n)   /* n multiple de 8 */
+{
+    unsigned long long a = s->a, b = s->b, w;
+    for (size_t i = 0; i < n; i += 8) {
+        memcpy(&w, p + i, 8);
+        a += w;
+        b += a;
+    }
+    s->a = a;
+    s->b = b;
+}
+
+static unsigned long long sommeFinale(const Somme *s)
+{
+    return s->a ^ (s->b * 0x9E3779B97F4A7C15ULL);
+}
+
+/* =========================================================
+ * ECRITURE
+ * ========================================================= */
+typedef struct {
+    FILE          *f;
+    unsigned char *tampon;
+    size_t         plein;
+    size_t         total;      /* octets ecrits apres l'en-tete */
+    Somme          somme;
+    int            ok;
+} Ecrivain;
+
+static void vider(Ecrivain *e)
+{
+    if (e->ok && e->plein > 0) {
+        sommer(&e->somme, e->tampon, e->plein);
+        e->ok = fwrite(e->tampon, 1, e->plein, e->f) == e->plein;
+    }
+    e->plein = 0;
+}
+
+static void ecrire(Ecrivain *e, const void *data, size_t n)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    while (n > 0) {
+        size_t k = INSTANTANE_TAMPON - e->plein;
+        if (k > n) k = n;
+        memcpy(e->tampon + e->plein, p, k);
+        e->plein += k;
+        e->total += k;
+        p        += k;
+        n        -= k;
+        if (e->plein == INSTANTANE_TAMPON) vider(e);
+    }
+}
+
+/* Complete la section courante par des zeros jusqu'au multiple de 8. */
+static void aligner(Ecrivain *e)
+{
+    static const unsigned char zeros[8];
+    ecrire(e, zeros, arrondi8(e->total) - e->total);
+}
+
+static void section(Ecrivain *e, const void *data, size_t n)
+{
+    ecrire(e, data, n);
+    aligner(e);
+}
+
+static int forcerDisque(FILE *f)
+{
+    if (fflush(f) != 0) return 0;
+#if defined(_WIN32)
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+static int remplacer(const char *src, const char *dst)
+{
+#if defined(_WIN32)
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(src, dst) == 0;
+#endif
+}
+
+static char *suffixer(const char *chemin, const char *suffixe)
+{
+    char *c = (char *)malloc(strlen(chemin) + strlen(suffixe) + 1);
+    if (c) {
+        strcpy(c, chemin);
+        strcat(c, suffixe);
+    }
+    return c;
+}
+
+int instantaneEcrire(const char *chemin, const InstantaneScrutin *s, const TableElecteurs *t)
+{
+    char    *tmp  = suffixer(chemin, ".tmp");
+    char    *prec = suffixer(chemin, INSTANTANE_SUFFIXE_PREC);
+    EnTete   h;
+    Ecrivain e;
+    size_t   nb   = (size_t)t->nb, nbC = (size_t)s->nbCandidats;
+    size_t   mots = DECOMPTE_MOTS(nb);
+
+    memset(&e, 0, sizeof(e));
+    e.somme.a = 1;
+    e.ok      = tmp && prec;
+    e.tampon  = e.ok ? (unsigned char *)malloc(INSTANTANE_TAMPON) : NULL;
+    e.f       = e.tampon ? fopen(tmp, "wb") : NULL;
+    if (!e.f) {
+        free(e.tampon);
+        free(tmp);
+        free(prec);
+        return 0;
+    }
+
+    /* En-tete provisoire : taille et somme ne sont connues qu'a la fin */
+    memset(&h, 0, sizeof(h));
+    e.ok = fwrite(&h, sizeof(h), 1, e.f) == 1;
+
+    section(&e, s->idCandidat, nbC * sizeof(int));
+    section(&e, s->voix, nbC * sizeof(int));
+    section(&e, s->nomCandidat, nbC * INSTANTANE_NOM);
+    section(&e, t->id, nb * sizeof(*t->id));
+    section(&e, (const void *)t->aVote, mots * sizeof(DecompteMot));
+    section(&e, (const void *)t->blanc, mots * sizeof(DecompteMot));
+    section(&e, t->choix, nb * sizeof(*t->choix));
+    section(&e, t->nom, nb * sizeof(*t->nom));
+    section(&e, t->login, nb * sizeof(*t->login));
+    section(&e, t->arene, t->areneTaille);
+    vider(&e);
+
+    memcpy(h.magic, INSTANTANE_MAGIC, 4);
+    h.boutisme    = INSTANTANE_BOUTISME;
+    h.sequence    = s->sequence;
+    h.taille      = sizeof(h) + e.total;
+    h.somme       = sommeFinale(&e.somme);
+    h.areneTaille = t->areneTaille;
+    h.voteOuvert  = s->voteOuvert;
+    h.nbElecteurs = t->nb;
+    h.nbCandidats = s->nbCandidats;
+    int ok = e.ok && fseek(e.f, 0, SEEK_SET) == 0
+          && fwrite(&h, sizeof(h), 1, e.f) == 1 && forcerDisque(e.f);
+    if (fclose(e.f) != 0) ok = 0;
+
+    /* L'instantane courant devient le precedent ; une coupure entre les
+       deux renommages laisse le precedent et le temporaire, tous deux
+       complets */
+    if (ok) {
+        remplacer(chemin, prec);
+        ok = remplacer(tmp, chemin);
+    }
+    if (!ok) remove(tmp);
+    free(e.tampon);
+    free(tmp);
+    free(prec);
+    return ok;
+}
+
+/* =========================================================
+ * CHARGEMENT
+ * ========================================================= */
+typedef struct {
+    const unsigned char *data;
+    size_t               taille;
+#if defined(_WIN32)
+    HANDLE               fichier;
+    HANDLE               projection;
+#endif
+} Projection;
+
+static void fermerProjection(Projection *p)
+{
+#if defined(_WIN32)
+    if (p->data) UnmapViewOfFile(p->data);
+    if (p->projection) CloseHandle(p->projection);
+    if (p->fichier != INVALID_HANDLE_VALUE) CloseHandle(p->fichier);
+#else
+    if (p->data) munmap((void *)p->data, p->taille);
+#endif
+}
+
+static int projeter(const char *chemin, Projection *p)
+{
+    memset(p, 0, sizeof(*p));
+#if defined(_WIN32)
+    LARGE_INTEGER taille;
+    p->fichier = CreateFileA(chemin, GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (p->fichier == INVALID_HANDLE_VALUE) return 0;
+    if (!GetFileSizeEx(p->fichier, &taille) || taille.QuadPart < (LONGLONG)sizeof(EnTete)) {
+        fermerProjection(p);
+        return 0;
+    }
+    p->taille     = (size_t)taille.QuadPart;
+    p->projection = CreateFileMappingA(p->fichier, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (p->projection)
+        p->data = (const unsigned char *)MapViewOfFile(p->projection, FILE_MAP_READ, 0, 0, 0);
+    if (!p->data) {
+        fermerProjection(p);
+        return 0;
+    }
+#else
+    struct stat sb;
+    int fd = open(chemin, O_RDONLY);
+    if (fd < 0) return 0;
+    if (fstat(fd, &sb) != 0 || (size_t)sb.st_size < sizeof(EnTete)) {
+        close(fd);
+        return 0;
+    }
+    p->taille = (size_t)sb.st_size;
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    flags |= MAP_POPULATE;   /* lu en entier : prechargement en un appel */
+#endif
+    void *m = mmap(NULL, p->taille, PROT_READ, flags, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) return 0;
+    posix_madvise(m, p->taille, POSIX_MADV_SEQUENTIAL);
+    p->data = (const unsigned char *)m;
+#endif
+    return 1;
+}
+
+/* Section suivante de `n` octets ; NULL si elle deborde du fichier. */
+static const unsigned char *lireSection(const Projection *p, size_t *pos, size_t n)
+{
+    const unsigned char *s = p->data + *pos;
+    if (n > p->taille - *pos) return NULL;
+    *pos += arrondi8(n);
+    if (*pos > p->taille) *pos = p->taille;
+    return s;
+}
+
+/*
+ * Verifie puis charge un instantane.
+ * @return 1 si charge, 0 s'il est absent ou invalide, -1 si memoire
+ *         insuffisante.
+ */
+static int chargerFichier(const char *chemin, InstantaneScrutin *s, TableElecteurs *t)
+{
+    Projection p;
+    EnTete     h;
+    Somme      somme = {1, 0};
+
+    if (!projeter(chemin, &p)) return 0;
+    memcpy(&h, p.data, sizeof(h));
+
+    size_t nb   = (size_t)h.nbElecteurs, nbC = (size_t)h.nbCandidats;
+    size_t mots = DECOMPTE_MOTS(nb);
+    int    ok   = memcmp(h.magic, INSTANTANE_MAGIC, 4) == 0
+               && h.boutisme == INSTANTANE_BOUTISME
+               && h.taille == p.taille && (p.taille - sizeof(h)) % 8 == 0
+               && h.nbElecteurs >= 0 && h.nbCandidats >= 0
+               && h.nbCandidats <= DECOMPTE_MAX_CANDIDATS;
+    if (ok) {
+        sommer(&somme, p.data + sizeof(h), p.taille - sizeof(h));
+        ok = sommeFinale(&somme) == h.somme;
+    }
+
+    size_t pos = sizeof(h);
+    const unsigned char *idC = NULL, *voix = NULL, *noms = NULL, *id = NULL, *aVote = NULL,
+                        *blanc = NULL, *choix = NULL, *nom = NULL, *login = NULL, *arene = NULL;
+    if (ok) {
+        idC   = lireSection(&p, &pos, nbC * sizeof(int));
+        voix  = lireSection(&p, &pos, nbC * sizeof(int));
+        noms  = lireSection(&p, &pos, nbC * INSTANTANE_NOM);
+        id    = lireSection(&p, &pos, nb * sizeof(*t->id));
+        aVote = lireSection(&p, &pos, mots * sizeof(DecompteMot));
+        blanc = lireSection(&p, &pos, mots * sizeof(DecompteMot));
+        choix = lireSection(&p, &pos, nb * sizeof(*t->choix));
+        nom   = lireSection(&p, &pos, nb * sizeof(*t->nom));
+        login = lireSection(&p, &pos, nb * sizeof(*t->login));
+        arene = lireSection(&p, &pos, (size_t)h.areneTaille);
+        ok    = idC && voix && noms && id && aVote && blanc && choix && nom && login && arene
+             && pos == p.taille
+             && (h.areneTaille == 0 || arene[h.areneTaille - 1] == '\0');
+    }
+    if (!ok) {
+        fermerProjection(&p);
+        return 0;
+    }
+
+    tableElecteursTronquer(t, 0);
+    if (!tableElecteursReserver(t, (int)nb, (size_t)h.areneTaille)) {
+        fermerProjection(&p);
+        return -1;
+    }
+    if (nb > 0) {   /* table vide : colonnes non allouees */
+        memcpy(t->id, id, nb * sizeof(*t->id));
+        memcpy((void *)t->aVote, aVote, mots * sizeof(DecompteMot));
+        memcpy((void *)t->blanc, blanc, mots * sizeof(DecompteMot));
+        memcpy(t->choix, choix, nb * sizeof(*t->choix));
+        memcpy(t->nom, nom, nb * sizeof(*t->nom));
+        memcpy(t->login, login, nb * sizeof(*t->login));
+    }
+    if (h.areneTaille > 0) memcpy(t->arene, arene, (size_t)h.areneTaille);
+    t->nb          = (int)nb;
+    t->areneTaille = (size_t)h.areneTaille;
+
+    s->sequence    = h.sequence;
+    s->voteOuvert  = h.voteOuvert;
+    s->nbCandidats = h.nbCandidats;
+    memcpy(s->idCandidat, idC, nbC * sizeof(int));
+    memcpy(s->voix, voix, nbC * sizeof(int));
+    memcpy(s->nomCandidat, noms, nbC * INSTANTANE_NOM);
+    for (size_t j = 0; j < nbC; j++) s->nomCandidat[j][INSTANTANE_NOM - 1] = '\0';
+
+    fermerProjection(&p);
+    return 1;
+}
+
+int instantaneCharger(const char *chemin, InstantaneScrutin *s, TableElecteurs *t)
+{
+    int r = chargerFichier(chemin, s, t);
+    if (r != 0) return r;
+
+    char *prec = suffixer(chemin, INSTANTANE_SUFFIXE_PREC);
+    if (!prec) return -1;
+    r = chargerFichier(prec, s, t);
+    free(prec);
+    return r;
+}
+
+static int existe(const char *chemin)
+{
+#if defined(_WIN32)
+    return GetFileAttributesA(chemin) != INVALID_FILE_ATTRIBUTES;
+#else
+    struct stat sb;
+    return stat(chemin, &sb) == 0;
+#endif
+}
+
+int instantanePresent(const char *chemin)
+{
+    char *prec = suffixer(chemin, INSTANTANE_SUFFIXE_PREC);
+    int   r    = existe(chemin) || !prec || existe(prec);
+    free(prec);
+    return r;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file instantane.h
+ * @brief Instantanes binaires de l'etat du SERVEUR PIVOTE.
+ *
+ * Un instantane contient tout l'etat du scrutin : table des electeurs
+ * (colonnes de table_electeurs.h telles qu'en memoire), candidats et leurs
+ * voix. Il porte la sequence du journal des votes (journal_votes.h) qu'il
+ * couvre : au demarrage, on charge l'instantane puis on ne rejoue que les
+ * votes a partir de cette sequence.
+ *
+ * Le fichier est l'image des colonnes, dans le boutisme de la machine,
+ * chaque section alignee sur 8 octets : le chargement projette le fichier
+ * en memoire (mmap / MapViewOfFile), verifie la somme de controle et copie
+ * chaque colonne d'un bloc, sans rien analyser. Un instantane ecrit par
+ * une machine d'un autre boutisme est refuse.
+ *
+ * L'ecriture passe par un fichier temporaire force sur disque puis
+ * renomme ; l'instantane remplace devient `chemin` INSTANTANE_SUFFIXE_PREC.
+ * Le chargement prend le plus recent des deux qui soit valide.
+ *
+ * L'appelant serialise les appels et empeche toute modification de la
+ * table pendant l'ecriture (cote serveur : l'ecrivain de fond, qui ecrit
+ * sa propre copie des tables).
+ */
+
+#ifndef INSTANTANE_H
+#define INSTANTANE_H
+
+#include "decompte.h"
+#include "table_electeurs.h"
+
+#define INSTANTANE_NOM           50        /* = Candidat.nom (serveur.h) */
+#define INSTANTANE_SUFFIXE_PREC  ".prec"
+
+/** Etat du scrutin hors electeurs. */
+typedef struct {
+    unsigned long long sequence;     /* premier vote du journal non couvert */
+    int                voteOuvert;
+    int                nbCandidats;
+    int                idCandidat[DECOMPTE_MAX_CANDIDATS];
+    int                voix[DECOMPTE_MAX_CANDIDATS];
+    char               nomCandidat[DECOMPTE_MAX_CANDIDATS][INSTANTANE_NOM];
+} InstantaneScrutin;
+
+/**
+ * @brief Ecrit un instantane de `s` et `t` dans `chemin`.
+ * @return 1 si le nouvel instantane est en place, 0 sinon (les precedents
+ *         restent intacts).
+ */
+int instantaneEcrire(const char *chemin, const InstantaneScrutin *s, const TableElecteurs *t);
+
+/**
+ * @brief Charge le plus recent instantane valide (`chemin`, sinon sa
+ *        version precedente) : remplace le contenu de `t`.
+ * @return 1 si un instantane est charge, 0 si aucun n'est lisible (`s` et
+ *         `t` inchanges), -1 si memoire insuffisante (`t` est alors vide).
+ */
+int instantaneCharger(const char *chemin, InstantaneScrutin *s, TableElecteurs *t);
+
+/**
+ * @brief Dit si un instantane a deja ete ecrit : `chemin` ou sa version
+ *        precedente existe, lisible ou non. Quand instantaneCharger()
+ *        renvoie 0 alors qu'un instantane est present, il est abime : le
+ *        journal des votes ne doit pas etre rejoue sur une autre base.
+ * @return 1 si present (ou memoire insuffisante pour le verifier), 0 sinon.
+ */
+int instantanePresent(const char *chemin);
+
+#endif /* INSTANTANE_H */
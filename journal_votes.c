@@ -0,0 +1,400 @@
+/**
+ * @file journal_votes.c
+ * @brief Journal des votes (voir journal_votes.h).
+ */
+
+#if !defined(_WIN32)
+#define _GNU_SOURCE   /* clock_gettime, fsync, ftruncate */
+#endif
+
+#include "journal_votes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <io.h>
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#endif
+
+#define JOURNAL_MAGIC        "PVJ1"
+#define JOURNAL_VERSION      1
+#define JOURNAL_ENTETE       16
+#define JOURNAL_ENREGISTREMENT 20
+#define JOURNAL_LOT_MAX      256    /* enregistrements encodes par fwrite */
+
+static FILE              *fichier;
+static char              *cheminJournal;
+static JournalSync        politique;
+static int                periode;
+static long long          derniereSync;  /* horlogeMs() du dernier fsync    */
+static int                enAttente;     /* ajouts pas encore forces sur disque */
+static unsigned long long premier;     /* sequence du premier enregistrement */
+static unsigned long long sequence;    /* sequence du prochain              */
+
+/* =========================================================
+ * ENCODAGE
+ * ========================================================= */
+static unsigned long tableCrc[256];
+
+static void initCrc(void)
+{
+    if (tableCrc[1]) return;
+    for (unsigned long n = 0; n < 256; n++) {
+        unsigned long c = n;
+        for (int k = 0; k < 8; k++)
+            c = (c & 1) ? 0xEDB88320UL ^ (c >> 1) : c >> 1;
+        tableCrc[n] = c;
+    }
+}
+
+/* CRC-32 (polynome IEEE, celui de zip et d'Ethernet) */
+static unsigned long crc32(const unsigned char *p, size_t n)
+{
+    unsigned long c = 0xFFFFFFFFUL;
+    while (n--) c = tableCrc[(c ^ *p++) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFUL;
+}
+
+static void ecrireU32(unsigned char *p, unsigned long v)
+{
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static unsigned long lireU32(const unsigned char *p)
+{
+    return (unsigned long)p[0] | ((unsigned long)p[1] << 8)
+         | ((unsigned long)p[2] << 16) | ((unsigned long)p[3] << 24);
+}
+
+static void ecrireU64(unsigned char *p, unsigned long long v)
+{
+    ecrireU32(p, (unsigned long)(v & 0xFFFFFFFFUL));
+    ecrireU32(p + 4, (unsigned long)(v >> 32));
+}
+
+static unsigned long long lireU64(const unsigned char *p)
+{
+    return (unsigned long long)lireU32(p) | ((unsigned long long)lireU32(p + 4) << 32);
+}
+
+static void encoder(unsigned char *p, const JournalVote *v)
+{
+    ecrireU32(p, v->slot);
+    ecrireU32(p + 4, (unsigned long)(unsigned int)v->idCandidat);
+    ecrireU64(p + 8, (unsigned long long)v->horodatage);
+    ecrireU32(p + 16, crc32(p, 16));
+}
+
+/* 0 si le CRC est faux */
+static int decoder(const unsigned char *p, JournalVote *v)
+{
+    if (lireU32(p + 16) != crc32(p, 16)) return 0;
+    v->slot       = (unsigned int)lireU32(p);
+    v->idCandidat = (int)(unsigned int)lireU32(p + 4);
+    v->horodatage = (long long)lireU64(p + 8);
+    return 1;
+}
+
+/* =========================================================
+ * FICHIER
+ * ========================================================= */
+long long journalMaintenant(void)
+{
+#if defined(_WIN32)
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    unsigned long long t = ((unsigned long long)ft.dwHighDateTime << 32) | ft.dwLowDateTime;
+    return (long long)((t - 116444736000000000ULL) / 10000);   /* 1601 -> 1970, 100 ns -> ms */
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+/* Horloge monotone en ms, pour la periode : insensible aux reglages de l'heure */
+static long long horlogeMs(void)
+{
+#if defined(_WIN32)
+    return (long long)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+/* Vide les tampons de `f` puis attend que le disque ait tout recu. */
+static int forcerDisque(FILE *f)
+{
+    if (fflush(f) != 0) return 0;
+#if defined(_WIN32)
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+/* Remplace `dst` par `src` (renommage atomique). */
+static int remplacer(const char *src, const char *dst)
+{
+#if defined(_WIN32)
+    return MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return rename(src, dst) == 0;
+#endif
+}
+
+static char *suffixer(const char *chemin, const char *suffixe)
+{
+    char *c = (char *)malloc(strlen(chemin) + strlen(suffixe) + 1);
+    if (c) {
+        strcpy(c, chemin);
+        strcat(c, suffixe);
+    }
+    return c;
+}
+
+static int tronquer(FILE *f, long taille)
+{
+    if (fflush(f) != 0) return 0;
+#if defined(_WIN32)
+    return _chsize(_fileno(f), taille) == 0;
+#else
+    return ftruncate(fileno(f), (off_t)taille) == 0;
+#endif
+}
+
+/* Cree un journal vide qui commence a `debut`, ouvert en ecriture. */
+static FILE *creer(const char *chemin, unsigned long long debut)
+{
+    unsigned char e[JOURNAL_ENTETE];
+    FILE *f = fopen(chemin, "wb");
+    if (!f) return NULL;
+    setvbuf(f, NULL, _IONBF, 0);   /* voir journalOuvrir() */
+    memcpy(e, JOURNAL_MAGIC, 4);
+    ecrireU32(e + 4, JOURNAL_VERSION);
+    ecrireU64(e + 8, debut);
+    if (fwrite(e, 1, sizeof(e), f) != sizeof(e) || !forcerDisque(f)) {
+        fclose(f);
+        return NULL;
+    }
+    return f;
+}
+
+/*
+ * Lit l'en-tete et les enregistrements valides de `chemin` ; ceux a partir
+ * de la sequence `depuis` sont passes a `appliquer` et comptes dans
+ * `*appliques`.
+ * @param debut Recoit la sequence du premier enregistrement (inchange si
+ *              le journal est absent ou vide).
+ * @return Taille de la partie valide (0 : journal absent ou vide),
+ *         -1 si le fichier n'est pas un journal de votes ou si sa taille
+ *         ne peut pas etre lue.
+ */
+static long lire(const char *chemin, unsigned long long depuis,
+                 JournalAppliquer appliquer, void *ctx, long *appliques,
+                 unsigned long long *debut, long *nb, long *tailleFichier)
+{
+    unsigned char e[JOURNAL_ENREGISTREMENT];
+    JournalVote   v;
+    FILE *f = fopen(chemin, "rb");
+
+    *nb = 0;
+    *tailleFichier = 0;
+    if (!f) return 0;
+    /* Sans la taille, une fin interrompue ne serait pas tronquee */
+    if (fseek(f, 0, SEEK_END) != 0 || (*tailleFichier = ftell(f)) < 0) {
+        fclose(f);
+        return -1;
+    }
+    rewind(f);
+
+    /* Un en-tete incomplet : coupure pendant la creation, journal vide */
+    if (fread(e, 1, JOURNAL_ENTETE, f) != JOURNAL_ENTETE) {
+        fclose(f);
+        return 0;
+    }
+    if (memcmp(e, JOURNAL_MAGIC, 4) != 0 || lireU32(e + 4) != JOURNAL_VERSION) {
+        fclose(f);
+        return -1;
+    }
+    *debut = lireU64(e + 8);
+
+    while (fread(e, 1, JOURNAL_ENREGISTREMENT, f) == JOURNAL_ENREGISTREMENT
+           && decoder(e, &v)) {
+        if (*debut + (unsigned long long)*nb >= depuis) {
+            if (appliquer) appliquer(&v, ctx);
+            (*appliques)++;
+        }
+        (*nb)++;
+    }
+    fclose(f);
+    return JOURNAL_ENTETE + *nb * JOURNAL_ENREGISTREMENT;
+}
+
+long journalOuvrir(const char *chemin, unsigned long long depuis,
+                   JournalSync sync, int periodeMs,
+                   JournalAppliquer appliquer, void *ctx)
+{
+    long               nb, tailleFichier, appliques = 0;
+    unsigned long long debut = 0;
+    int                verifier = depuis != JOURNAL_DEPUIS_DEBUT;
+
+    journalFermer();
+    initCrc();
+    if (!verifier) depuis = 0;
+
+    /* Segment precedent : ferme une fois pour toutes, lu tel quel */
+    char *prec = suffixer(chemin, JOURNAL_SUFFIXE_PREC);
+    long  lu   = prec ? lire(prec, depuis, appliquer, ctx, &appliques,
+                             &debut, &nb, &tailleFichier) : -1;
+    free(prec);
+    if (lu < 0) return -1;
+
+    /* Chaque segment doit reprendre ou s'arrete ce qui precede (l'instantane,
+       puis le segment precedent) : sinon des votes manquent au rejeu */
+    unsigned long long attendu = depuis;
+    if (lu > 0) {
+        if (verifier && debut > attendu) return -1;
+        if (debut + (unsigned long long)nb > attendu) attendu = debut + (unsigned long long)nb;
+    }
+
+    premier = attendu;   /* journal absent : on numerote apres l'instantane */
+    long valide = lire(chemin, depuis, appliquer, ctx, &appliques,
+                       &premier, &nb, &tailleFichier);
+    if (valide < 0) return -1;
+    if (valide > 0 && verifier && premier > attendu) return -1;
+
+    if (valide == 0) {
+        fichier = creer(chemin, premier);
+    } else {
+        fichier = fopen(chemin, "r+b");
+        /* Sans tampon stdio : ce qui n'est pas ecrit au retour de fwrite ne
+           peut plus partir plus tard (votes refuses) */
+        if (fichier) setvbuf(fichier, NULL, _IONBF, 0);
+        /* Enregistrement interrompu en fin de fichier : on repart derriere
+           le dernier valide */
+        if (fichier && tailleFichier > valide
+            && (!tronquer(fichier, valide) || !forcerDisque(fichier))) {
+            fclose(fichier);
+            fichier = NULL;
+        }
+        if (fichier) fseek(fichier, 0, SEEK_END);
+    }
+    if (!fichier) return -1;
+
+    cheminJournal = (char *)malloc(strlen(chemin) + 1);
+    if (!cheminJournal) {
+        journalFermer();
+        return -1;
+    }
+    strcpy(cheminJournal, chemin);
+    politique    = sync;
+    periode      = periodeMs;
+    derniereSync = horlogeMs();
+    enAttente    = 0;
+    sequence     = premier + (unsigned long long)nb;
+    return appliques;
+}
+
+int journalActif(void)
+{
+    return fichier != NULL;
+}
+
+int journalAjouter(const JournalVote *v, int nb)
+{
+    unsigned char tampon[JOURNAL_LOT_MAX * JOURNAL_ENREGISTREMENT];
+    if (!fichier) return 0;
+
+    long avant = ftell(fichier);
+    int  ok    = avant >= 0;
+    for (int k = 0; ok && k < nb; k += JOURNAL_LOT_MAX) {
+        int n = nb - k < JOURNAL_LOT_MAX ? nb - k : JOURNAL_LOT_MAX;
+        for (int j = 0; j < n; j++)
+            encoder(tampon + (size_t)j * JOURNAL_ENREGISTREMENT, &v[k + j]);
+        ok = fwrite(tampon, JOURNAL_ENREGISTREMENT, (size_t)n, fichier) == (size_t)n;
+    }
+    if (ok) {
+        long long maintenant = horlogeMs();
+        if (politique == JOURNAL_SYNC_TOUJOURS
+            || (politique == JOURNAL_SYNC_PERIODIQUE && maintenant - derniereSync >= periode)) {
+            ok = forcerDisque(fichier);
+            derniereSync = maintenant;
+            enAttente    = 0;
+        } else {
+            ok = fflush(fichier) == 0;
+            if (ok && politique == JOURNAL_SYNC_PERIODIQUE) enAttente = 1;
+        }
+    }
+    if (ok) {
+        sequence += (unsigned long long)nb;
+        return 1;
+    }
+
+    /* Des votes refuses ne doivent pas reapparaitre au prochain demarrage */
+    clearerr(fichier);
+    if (avant < 0 || !tronquer(fichier, avant) || fseek(fichier, avant, SEEK_SET) != 0) {
+        fclose(fichier);
+        fichier = NULL;
+    }
+    return 0;
+}
+
+long journalSynchroniser(void)
+{
+    if (!fichier || !enAttente) return -1;
+    long long ecoule = horlogeMs() - derniereSync;
+    if (ecoule < periode) return (long)(periode - ecoule);
+    derniereSync = horlogeMs();
+    if (forcerDisque(fichier)) {
+        enAttente = 0;
+        return -1;
+    }
+    return periode;   /* nouvel essai a la periode suivante */
+}
+
+int journalTourner(void)
+{
+    if (!cheminJournal) return 0;
+    if (fichier) {
+        if (enAttente) forcerDisque(fichier);   /* la periode ne le rattrapera plus */
+        fclose(fichier);
+    }
+    fichier   = NULL;
+    enAttente = 0;
+
+    /* Sans segment precedent, seul le dernier instantane permet de repartir */
+    char *prec = suffixer(cheminJournal, JOURNAL_SUFFIXE_PREC);
+    if (prec) remplacer(cheminJournal, prec);
+    free(prec);
+
+    premier = sequence;
+    fichier = creer(cheminJournal, premier);
+    return fichier != NULL;
+}
+
+void journalFermer(void)
+{
+    if (fichier) fclose(fichier);
+    fichier = NULL;
+    free(cheminJournal);
+    cheminJournal = NULL;
+}
+
+unsigned long long journalSequence(void)
+{
+    return sequence;
+}
+
+unsigned long long journalPremier(void)
+{
+    return premier;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file journal_votes.h
+ * @brief Journal des votes du SERVEUR PIVOTE (write-ahead log binaire).
+ *
+ * Chaque vote accepte est ajoute en fin de journal avant d'etre confirme
+ * au client : c'est lui, et non une reecriture de la sauvegarde, qui rend
+ * le vote durable. La sauvegarde complete (instantane.h) ne sert plus que
+ * de base : au demarrage on la relit puis on rejoue la fin du journal.
+ *
+ * Le journal est fait de deux segments : le courant (`chemin`) et le
+ * precedent (`chemin` JOURNAL_SUFFIXE_PREC). Au moment ou l'etat est copie
+ * pour un instantane, journalTourner() fait du courant le precedent
+ * (l'ancien precedent, couvert par l'instantane deja en place, disparait) :
+ * si le dernier instantane est illisible, l'avant-dernier et les deux
+ * segments suffisent.
+ *
+ * Format (entiers petit-boutistes) :
+ *   en-tete      "PVJ1", version (u32), premier numero de sequence (u64)
+ *   enregistrement de 20 octets :
+ *     slot de l'electeur (u32), id du candidat (i32, JOURNAL_BLANC pour un
+ *     vote blanc), horodatage en ms depuis 1970 (i64), CRC-32 des 16
+ *     octets qui precedent (u32)
+ * Le numero de sequence d'un enregistrement est celui de l'en-tete plus
+ * son rang. Un enregistrement incomplet ou dont le CRC est faux marque la
+ * fin du journal (ecriture interrompue) : il est ignore et tronque a
+ * l'ouverture.
+ *
+ * Le journal ne decrit que des votes, rejoues comme un premier vote de
+ * l'electeur : rejouer un vote deja present dans la base est sans effet.
+ *
+ * L'appelant serialise les appels (verrouFichiers, cote serveur). Ce module
+ * ne depend que de la bibliotheque C (et de _commit, MoveFileExA sous
+ * Windows).
+ */
+
+#ifndef JOURNAL_VOTES_H
+#define JOURNAL_VOTES_H
+
+#include <limits.h>
+
+#define JOURNAL_BLANC        INT_MIN   /* id de candidat d'un vote blanc */
+#define JOURNAL_SUFFIXE_PREC ".prec"   /* segment precedent              */
+#define JOURNAL_DEPUIS_DEBUT (~0ULL)   /* journalOuvrir() : tout rejouer */
+
+/** Quand forcer le journal sur disque (fsync / _commit). */
+typedef enum {
+    JOURNAL_SYNC_TOUJOURS,     /* a chaque ajout : un vote confirme est sur disque */
+    JOURNAL_SYNC_PERIODIQUE,   /* au plus une fois par periode ; une panne du
+                                  systeme peut perdre la derniere periode       */
+    JOURNAL_SYNC_JAMAIS        /* le systeme decide ; survit a un arret du
+                                  serveur, pas a une panne du systeme           */
+} JournalSync;
+
+typedef struct {
+    unsigned int slot;         /* slot de l'electeur (table_electeurs.h) */
+    int          idCandidat;   /* JOURNAL_BLANC : vote blanc             */
+    long long    horodatage;   /* ms depuis 1970                         */
+} JournalVote;
+
+typedef void (*JournalAppliquer)(const JournalVote *v, void *ctx);
+
+/**
+ * @brief Rejoue les deux segments du journal `chemin` puis ouvre le
+ *        courant en ajout (le cree s'il n'existe pas).
+ *
+ * @param depuis    Premiere sequence a rejouer (celles d'avant sont dans
+ *                  l'instantane charge). JOURNAL_DEPUIS_DEBUT : tout le
+ *                  journal, la base couvrant ce qui le precede quel qu'en
+ *                  soit le debut (ancienne sauvegarde texte).
+ * @param appliquer Appele pour chaque enregistrement rejoue, dans l'ordre.
+ * @param periodeMs Periode de JOURNAL_SYNC_PERIODIQUE.
+ * @return Nombre d'enregistrements rejoues, -1 si le journal ne peut pas
+ *         etre ouvert, n'est pas un journal de votes, ou commence apres
+ *         `depuis` (segment perdu : des votes manqueraient). Il est alors
+ *         laisse tel quel, et des enregistrements ont pu etre appliques.
+ */
+long journalOuvrir(const char *chemin, unsigned long long depuis,
+                   JournalSync sync, int periodeMs,
+                   JournalAppliquer appliquer, void *ctx);
+
+/** 1 si le journal est ouvert. */
+int journalActif(void);
+
+/**
+ * @brief Ajoute `nb` votes, puis force le journal sur disque selon la
+ *        politique choisie.
+ * @return 1 si les votes sont ecrits, 0 sinon : le journal est alors
+ *         ramene a son etat precedent, ou ferme s'il ne peut pas l'etre.
+ */
+int journalAjouter(const JournalVote *v, int nb);
+
+/**
+ * @brief Force sur disque les ajouts laisses en attente par
+ *        JOURNAL_SYNC_PERIODIQUE, une fois leur periode ecoulee : a appeler
+ *        quand les ajouts cessent, sans quoi rien ne les synchronise.
+ * @return Delai en ms avant la prochaine echeance, -1 si rien n'attend.
+ */
+long journalSynchroniser(void);
+
+/**
+ * @brief Commence un nouveau segment a journalSequence() ; a appeler quand
+ *        l'etat copie pour un instantane couvre tout le segment courant, et
+ *        qu'un instantane deja en place couvre journalPremier(). La
+ *        numerotation continue.
+ * @return 0 si le segment n'a pas pu etre cree (le journal est alors ferme).
+ */
+int journalTourner(void);
+
+/** Ferme le journal (ajouts suivants refuses jusqu'a journalOuvrir). */
+void journalFermer(void);
+
+/** Numero de sequence du prochain enregistrement. */
+unsigned long long journalSequence(void);
+
+/** Numero de sequence du premier enregistrement du segment courant. */
+unsigned long long journalPremier(void);
+
+/** Heure courante en ms depuis 1970 (pour JournalVote.horodatage). */
+long long journalMaintenant(void);
+
+#endif /* JOURNAL_VOTES_H */
@@ -0,0 +1,334 @@
+/**
+ * @file plateforme.c
+ * @brief Couche systeme, Win32 et POSIX (voir plateforme.h).
+ */
+
+#if !defined(_WIN32)
+#define _GNU_SOURCE   /* clock_gettime, nanosleep, sysconf */
+#endif
+
+#include "plateforme.h"
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(_WIN32)
+#include <conio.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <termios.h>
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+#if defined(_MSC_VER)
+#pragma comment(lib, "ws2_32.lib")
+#endif
+
+/* =========================================================
+ * SOCKETS
+ * ========================================================= */
+int socketsInit(void)
+{
+#if defined(_WIN32)
+    WSADATA wsa;
+    return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+#else
+    signal(SIGPIPE, SIG_IGN);   /* send() vers un pair parti : erreur EPIPE */
+    return 1;
+#endif
+}
+
+void socketsFin(void)
+{
+#if defined(_WIN32)
+    WSACleanup();
+#endif
+}
+
+void socketFermer(Socket s)
+{
+#if defined(_WIN32)
+    closesocket(s);
+#else
+    close(s);
+#endif
+}
+
+int socketDelaiReception(Socket s, long ms)
+{
+#if defined(_WIN32)
+    DWORD delai = (DWORD)ms;
+    return setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, (const char *)&delai, sizeof(delai)) == 0;
+#else
+    struct timeval delai;
+    delai.tv_sec  = ms / 1000;
+    delai.tv_usec = (ms % 1000) * 1000;
+    return setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, &delai, sizeof(delai)) == 0;
+#endif
+}
+
+int socketNonBloquant(Socket s)
+{
+#if defined(_WIN32)
+    u_long un = 1;
+    return ioctlsocket(s, FIONBIO, &un) == 0;
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+int socketBloquerait(void)
+{
+#if defined(_WIN32)
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+/* =========================================================
+ * THREADS ET SYNCHRONISATION
+ * ========================================================= */
+typedef struct {
+    ThreadFonction f;
+    void          *arg;
+} LancementThread;
+
+#if defined(_WIN32)
+static DWORD WINAPI demarrerThread(LPVOID p)
+#else
+static void *demarrerThread(void *p)
+#endif
+{
+    LancementThread l = *(LancementThread *)p;
+    free(p);
+    l.f(l.arg);
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+int threadLancer(ThreadFonction f, void *arg)
+{
+    LancementThread *l = (LancementThread *)malloc(sizeof(LancementThread));
+    if (!l) return 0;
+    l->f   = f;
+    l->arg = arg;
+#if defined(_WIN32)
+    HANDLE h = CreateThread(NULL, 0, demarrerThread, l, 0, NULL);
+    if (h) {
+        CloseHandle(h);
+        return 1;
+    }
+#else
+    pthread_t      t;
+    pthread_attr_t attr;
+    int            ok = pthread_attr_init(&attr) == 0;
+    if (ok) {
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        ok = pthread_create(&t, &attr, demarrerThread, l) == 0;
+        pthread_attr_destroy(&attr);
+    }
+    if (ok) return 1;
+#endif
+    free(l);
+    return 0;
+}
+
+void dormirMs(long ms)
+{
+#if defined(_WIN32)
+    Sleep((DWORD)ms);
+#else
+    struct timespec ts;
+    ts.tv_sec  = ms / 1000;
+    ts.tv_nsec = (ms % 1000) * 1000000L;
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {}
+#endif
+}
+
+long long maintenantUs(void)
+{
+#if defined(_WIN32)
+    LARGE_INTEGER t, f;
+    QueryPerformanceCounter(&t);
+    QueryPerformanceFrequency(&f);
+    return (long long)(t.QuadPart / f.QuadPart * 1000000LL
+                       + t.QuadPart % f.QuadPart * 1000000LL / f.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+#endif
+}
+
+int nbProcesseurs(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwNumberOfProcessors > 0 ? (int)si.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+/*
+ * POSIX : les delais se comptent sur l'horloge monotone (un reglage de
+ * l'heure ne les allonge pas), sauf ou pthread_condattr_setclock manque.
+ */
+#if !defined(_WIN32)
+#if defined(__APPLE__)
+#define HORLOGE_CONDITION CLOCK_REALTIME
+#else
+#define HORLOGE_CONDITION CLOCK_MONOTONIC
+#endif
+
+void conditionInit(Condition *c)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#if !defined(__APPLE__)
+    pthread_condattr_setclock(&attr, HORLOGE_CONDITION);
+#endif
+    pthread_cond_init(c, &attr);
+    pthread_condattr_destroy(&attr);
+}
+#endif
+
+int conditionAttendre(Condition *c, Section *s, long ms)
+{
+#if defined(_WIN32)
+    if (SleepConditionVariableCS(c, s, ms < 0 ? INFINITE : (DWORD)ms)) return 1;
+    return GetLastError() != ERROR_TIMEOUT;
+#else
+    if (ms < 0) return pthread_cond_wait(c, s) == 0;
+
+    struct timespec fin;
+    clock_gettime(HORLOGE_CONDITION, &fin);
+    fin.tv_sec  += ms / 1000;
+    fin.tv_nsec += (ms % 1000) * 1000000L;
+    if (fin.tv_nsec >= 1000000000L) {
+        fin.tv_sec++;
+        fin.tv_nsec -= 1000000000L;
+    }
+    return pthread_cond_timedwait(c, s, &fin) != ETIMEDOUT;
+#endif
+}
+
+/* =========================================================
+ * FICHIERS
+ * ========================================================= */
+int fichierRemplacer(const char *tmp, const char *chemin)
+{
+#if defined(_WIN32)
+    return MoveFileExA(tmp, chemin, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(tmp, chemin) == 0;
+#endif
+}
+
+/* =========================================================
+ * CONSOLE
+ * ========================================================= */
+void consoleInit(unsigned int pageCode)
+{
+#if defined(_WIN32)
+    SetConsoleOutputCP(pageCode);
+    SetConsoleCP(pageCode);
+#else
+    (void)pageCode;
+#endif
+}
+
+#if defined(_WIN32)
+int consoleTouche(void)
+{
+    int touche = _getch();
+
+    /* Les fleches envoient 2 codes : 0 ou 224, puis le code reel */
+    if (touche == 0 || touche == 224) return 0x100 + _getch();
+    return touche == '\r' ? TOUCHE_ENTREE : touche;
+}
+#else
+/*
+ * Un octet de stdin, en mode caractere si c'est un terminal. Lu par stdio,
+ * comme les saisies (scanf, fgets) : rien de ce qu'elles ont deja lu
+ * d'avance n'est perdu.
+ */
+static int lireOctet(void)
+{
+    struct termios avant, brut;
+    int            terminal = tcgetattr(STDIN_FILENO, &avant) == 0;
+
+    fflush(stdout);
+    if (terminal) {
+        brut = avant;
+        brut.c_lflag &= ~(tcflag_t)(ICANON | ECHO);
+        brut.c_cc[VMIN]  = 1;
+        brut.c_cc[VTIME] = 0;
+        tcsetattr(STDIN_FILENO, TCSANOW, &brut);
+    }
+    int c = getchar();
+    if (terminal) tcsetattr(STDIN_FILENO, TCSANOW, &avant);
+    return c == EOF ? TOUCHE_FIN : c;
+}
+
+int consoleTouche(void)
+{
+    int touche = lireOctet();
+
+    /* Fleches : ESC [ A / ESC [ B (ou ESC O A / ESC O B) */
+    if (touche == 0x1b) {
+        int c = lireOctet();
+        if (c == '[' || c == 'O') c = lireOctet();
+        if (c == 'A') return TOUCHE_HAUT;
+        if (c == 'B') return TOUCHE_BAS;
+        return c == TOUCHE_FIN ? TOUCHE_FIN : 0x1b;
+    }
+    return touche == '\n' || touche == '\r' ? TOUCHE_ENTREE : touche;
+}
+#endif
+
+void consoleCouleur(int couleur)
+{
+#if defined(_WIN32)
+    SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), (WORD)couleur);
+#else
+    /* Attribut Windows : bit 0 bleu, 1 vert, 2 rouge, 3 intense ; ANSI :
+       rouge 1, vert 2, bleu 4 */
+    if (couleur == 7) {
+        printf("\033[0m");
+    } else {
+        int ansi = ((couleur & 4) ? 1 : 0) | ((couleur & 2) ? 2 : 0) | ((couleur & 1) ? 4 : 0);
+        printf("\033[%dm", ((couleur & 8) ? 90 : 30) + ansi);
+    }
+    fflush(stdout);
+#endif
+}
+
+void consoleEffacer(void)
+{
+#if defined(_WIN32)
+    system("cls");
+#else
+    printf("\033[H\033[2J");
+    fflush(stdout);
+#endif
+}
+
+void consolePause(void)
+{
+#if defined(_WIN32)
+    system("pause");
+#else
+    printf("Appuyez sur une touche pour continuer...");
+    consoleTouche();
+    printf("\n");
+#endif
+}
@@ -0,0 +1,197 @@
+/**
+ * @file plateforme.h
+ * @brief Couche systeme du SERVEUR et du CLIENT PIVOTE : sockets, threads,
+ *        verrous, attente, console. Implementations Win32 et POSIX.
+ *
+ * Le reste du serveur et du client n'inclut plus <windows.h>, <winsock2.h>
+ * ni <conio.h> : tout passe par ce module, qui se compile tel quel sous
+ * Windows (MinGW, MSVC) et sous Linux ou tout systeme POSIX (pthreads).
+ *
+ * Les verrous, conditions et operations atomiques sont des macros (pas
+ * d'appel en plus sur le chemin du vote) ; le reste est dans plateforme.c.
+ * Les modules autonomes (journal_votes, instantane, decompte, auth...)
+ * gardent leurs propres #if : ils ne dependent pas de celui-ci.
+ *
+ * Console POSIX : les touches sont lues sans echo ni attente de ligne
+ * (termios), les couleurs sont des sequences ANSI. Les textes du serveur
+ * restent en Latin-1 (page 1252 sous Windows).
+ */
+
+#ifndef PLATEFORME_H
+#define PLATEFORME_H
+
+#if defined(_WIN32)
+#include <winsock2.h>
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+/* =========================================================
+ * SOCKETS
+ * ========================================================= */
+#if defined(_WIN32)
+typedef SOCKET Socket;
+#define SOCKET_INVALIDE INVALID_SOCKET
+#else
+typedef int Socket;
+#define SOCKET_INVALIDE (-1)
+#endif
+
+/**
+ * @brief Prepare les sockets (Winsock ; sous POSIX, un pair qui ferme ne
+ *        tue plus le processus par SIGPIPE).
+ * @return 1 si succes, 0 si erreur.
+ */
+int socketsInit(void);
+
+/** Libere ce que socketsInit() a pris. */
+void socketsFin(void);
+
+void socketFermer(Socket s);
+
+/**
+ * @brief Ferme la connexion si rien n'arrive pendant `ms` millisecondes
+ *        (recv() echoue au bout du delai).
+ * @return 1 si succes, 0 si erreur.
+ */
+int socketDelaiReception(Socket s, long ms);
+
+/**
+ * @brief Passe la socket en mode non bloquant : send() et recv() rendent
+ *        la main tout de suite, quitte a ne rien transferer.
+ * @return 1 si succes, 0 si erreur.
+ */
+int socketNonBloquant(Socket s);
+
+/**
+ * @brief Apres un send() ou recv() en echec sur une socket non bloquante :
+ *        1 si l'appel est simplement a refaire plus tard (tampon plein ou
+ *        vide), 0 si la connexion est en erreur.
+ */
+int socketBloquerait(void);
+
+/* =========================================================
+ * THREADS ET SYNCHRONISATION
+ * ========================================================= */
+typedef void (*ThreadFonction)(void *arg);
+
+/**
+ * @brief Lance `f(arg)` dans un thread detache (personne ne l'attend).
+ * @return 1 si le thread est lance, 0 sinon.
+ */
+int threadLancer(ThreadFonction f, void *arg);
+
+/** Suspend le thread appelant pendant `ms` millisecondes. */
+void dormirMs(long ms);
+
+/** Horloge monotone en microsecondes (origine quelconque) : pour mesurer des durees. */
+long long maintenantUs(void);
+
+/** Processeurs en ligne (au moins 1). */
+int nbProcesseurs(void);
+
+#define ATTENTE_INFINIE (-1L)
+
+#if defined(_WIN32)
+/* Verrou lecteurs/ecrivain */
+typedef SRWLOCK Verrou;
+#define VERROU_INIT                SRWLOCK_INIT
+#define verrouPartagePrendre(v)    AcquireSRWLockShared(v)
+#define verrouPartageRendre(v)     ReleaseSRWLockShared(v)
+#define verrouExclusifPrendre(v)   AcquireSRWLockExclusive(v)
+#define verrouExclusifRendre(v)    ReleaseSRWLockExclusive(v)
+
+/* Section critique et condition associee */
+typedef CRITICAL_SECTION   Section;
+typedef CONDITION_VARIABLE Condition;
+#define sectionInit(s)             InitializeCriticalSection(s)
+#define sectionEntrer(s)           EnterCriticalSection(s)
+#define sectionQuitter(s)          LeaveCriticalSection(s)
+#define conditionInit(c)           InitializeConditionVariable(c)
+#define conditionReveiller(c)      WakeConditionVariable(c)
+#define conditionReveillerTout(c)  WakeAllConditionVariable(c)
+
+/* Operations atomiques (barriere complete ; lecture : acquisition) */
+#define atomiqueIncrementer(p)     InterlockedIncrement(p)
+#define atomiqueDecrementer(p)     InterlockedDecrement(p)
+#define atomiqueEchanger(p, v)     InterlockedExchange((p), (v))
+#define atomiqueLire(p)            InterlockedCompareExchange((p), 0, 0)
+#define barriereMemoire()          MemoryBarrier()
+#else
+typedef pthread_rwlock_t Verrou;
+#define VERROU_INIT                PTHREAD_RWLOCK_INITIALIZER
+#define verrouPartagePrendre(v)    pthread_rwlock_rdlock(v)
+#define verrouPartageRendre(v)     pthread_rwlock_unlock(v)
+#define verrouExclusifPrendre(v)   pthread_rwlock_wrlock(v)
+#define verrouExclusifRendre(v)    pthread_rwlock_unlock(v)
+
+typedef pthread_mutex_t Section;
+typedef pthread_cond_t  Condition;
+#define sectionInit(s)             pthread_mutex_init((s), NULL)
+#define sectionEntrer(s)           pthread_mutex_lock(s)
+#define sectionQuitter(s)          pthread_mutex_unlock(s)
+void conditionInit(Condition *c);
+#define conditionReveiller(c)      pthread_cond_signal(c)
+#define conditionReveillerTout(c)  pthread_cond_broadcast(c)
+
+#define atomiqueIncrementer(p)     __atomic_add_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define atomiqueDecrementer(p)     __atomic_sub_fetch((p), 1, __ATOMIC_SEQ_CST)
+#define atomiqueEchanger(p, v)     __atomic_exchange_n((p), (v), __ATOMIC_SEQ_CST)
+#define atomiqueLire(p)            __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define barriereMemoire()          __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/**
+ * @brief Rend la section `s` (tenue par l'appelant), attend un reveil de
+ *        `c` au plus `ms` millisecondes (ATTENTE_INFINIE : sans limite),
+ *        puis reprend la section. Les reveils sans cause sont possibles.
+ * @return 0 si le delai est ecoule, 1 sinon.
+ */
+int conditionAttendre(Condition *c, Section *s, long ms);
+
+/* =========================================================
+ * FICHIERS
+ * ========================================================= */
+/**
+ * @brief Remplace `chemin` par `tmp` (renommage atomique, meme si
+ *        `chemin` existe).
+ * @return 1 si succes, 0 si erreur.
+ */
+int fichierRemplacer(const char *tmp, const char *chemin);
+
+/* =========================================================
+ * CONSOLE
+ * ========================================================= */
+/* Touches speciales rendues par consoleTouche() */
+#define TOUCHE_ENTREE  13
+#define TOUCHE_HAUT    0x148
+#define TOUCHE_BAS     0x150
+#define TOUCHE_FIN     (-1)     /* entree fermee : plus rien a lire */
+
+/**
+ * @brief Prepare la console : page de code `pageCode` sous Windows (1252 :
+ *        Latin-1, 65001 : UTF-8), rien sous POSIX.
+ */
+void consoleInit(unsigned int pageCode);
+
+/**
+ * @brief Attend une touche, sans echo ni Entree.
+ * @return Le caractere, TOUCHE_ENTREE, TOUCHE_HAUT, TOUCHE_BAS ou TOUCHE_FIN.
+ */
+int consoleTouche(void);
+
+/** Couleur du texte, en attribut console Windows (7 : normal, 11 : cyan clair...). */
+void consoleCouleur(int couleur);
+
+/** Efface l'ecran. */
+void consoleEffacer(void);
+
+/** "Appuyez sur une touche" puis attend la touche. */
+void consolePause(void);
+
+#endif /* PLATEFORME_H */
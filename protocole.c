@@ -0,0 +1,379 @@
+/**
+ * @file protocole.c
+ * @brief Codage et reassemblage des trames PIVOTE (voir protocole.h).
+ */
+
+#include "protocole.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* =========================================================
+ * 1. TAMPON
+ * ========================================================= */
+void protoTamponLiberer(ProtoTampon *t)
+{
+    free(t->data);
+    memset(t, 0, sizeof(*t));
+}
+
+void protoTamponVider(ProtoTampon *t)
+{
+    t->debut = t->fin = 0;
+}
+
+size_t protoTamponTaille(const ProtoTampon *t)
+{
+    return t->fin - t->debut;
+}
+
+unsigned char *protoTamponReserver(ProtoTampon *t, size_t n)
+{
+    if (t->cap - t->fin >= n) return t->data + t->fin;
+
+    /* Recupere d'abord la place des trames deja consommees */
+    if (t->debut > 0) {
+        memmove(t->data, t->data + t->debut, t->fin - t->debut);
+        t->fin  -= t->debut;
+        t->debut = 0;
+        if (t->cap - t->fin >= n) return t->data + t->fin;
+    }
+
+    size_t cap = t->cap ? t->cap : 256;
+    while (cap - t->fin < n) cap *= 2;
+    unsigned char *d = (unsigned char *)realloc(t->data, cap);
+    if (!d) return NULL;
+    t->data = d;
+    t->cap  = cap;
+    return t->data + t->fin;
+}
+
+void protoTamponValider(ProtoTampon *t, size_t n)
+{
+    t->fin += n;
+}
+
+int protoTamponAjouter(ProtoTampon *t, const void *data, size_t n)
+{
+    unsigned char *p = protoTamponReserver(t, n);
+    if (!p) return 0;
+    memcpy(p, data, n);
+    t->fin += n;
+    return 1;
+}
+
+/* Longueur annoncee par l'entete en tete du tampon (au moins 4 octets). */
+static unsigned long longueurTrame(const ProtoTampon *t)
+{
+    const unsigned char *p = t->data + t->debut;
+    return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16)
+         | ((unsigned long)p[2] << 8)  |  (unsigned long)p[3];
+}
+
+int protoTramePrete(const ProtoTampon *t)
+{
+    size_t dispo = t->fin - t->debut;
+    if (dispo < 4) return 0;
+    unsigned long len = longueurTrame(t);
+    return len == 0 || len > PROTO_TRAME_MAX || dispo >= 4 + len;
+}
+
+int protoExtraire(ProtoTampon *t, ProtoTrame *trame)
+{
+    size_t dispo = t->fin - t->debut;
+    if (dispo < 4) return 0;
+
+    unsigned long len = longueurTrame(t);
+    if (len == 0 || len > PROTO_TRAME_MAX) return -1;
+    if (dispo < 4 + len) return 0;
+
+    const unsigned char *p = t->data + t->debut;
+    trame->opcode = p[4];
+    trame->champs = p + PROTO_ENTETE;
+    trame->len    = len - 1;
+    t->debut += 4 + len;
+    if (t->debut == t->fin) t->debut = t->fin = 0;   /* la trame reste lisible */
+    return 1;
+}
+
+/* =========================================================
+ * 2. ECRITURE DE TRAMES
+ * ========================================================= */
+int protoOuvrir(ProtoTampon *t, int opcode, size_t *debut)
+{
+    unsigned char *p = protoTamponReserver(t, PROTO_ENTETE);
+    if (!p) return 0;
+    *debut = t->fin;
+    memset(p, 0, 4);
+    p[4] = (unsigned char)opcode;
+    t->fin += PROTO_ENTETE;
+    return 1;
+}
+
+int protoAjouterU8(ProtoTampon *t, unsigned v)
+{
+    unsigned char o = (unsigned char)v;
+    return protoTamponAjouter(t, &o, 1);
+}
+
+int protoAjouterI32(ProtoTampon *t, long v)
+{
+    unsigned long u = (unsigned long)v;
+    unsigned char o[4];
+    o[0] = (unsigned char)(u >> 24);
+    o[1] = (unsigned char)(u >> 16);
+    o[2] = (unsigned char)(u >> 8);
+    o[3] = (unsigned char)u;
+    return protoTamponAjouter(t, o, 4);
+}
+
+int protoAjouterChaine(ProtoTampon *t, const char *s)
+{
+    size_t n = strlen(s);
+    if (n > 255) n = 255;
+    return protoAjouterU8(t, (unsigned)n) && protoTamponAjouter(t, s, n);
+}
+
+void protoFermer(ProtoTampon *t, size_t debut)
+{
+    size_t len = t->fin - debut - 4;
+    unsigned char *p = t->data + debut;
+    p[0] = (unsigned char)(len >> 24);
+    p[1] = (unsigned char)(len >> 16);
+    p[2] = (unsigned char)(len >> 8);
+    p[3] = (unsigned char)len;
+}
+
+int protoEcrireVide(ProtoTampon *t, int opcode)
+{
+    size_t d;
+    if (!protoOuvrir(t, opcode, &d)) return 0;
+    protoFermer(t, d);
+    return 1;
+}
+
+int protoEcrireHello(ProtoTampon *t, int opcode, int version)
+{
+    size_t d;
+    if (!protoOuvrir(t, opcode, &d)
+        || !protoTamponAjouter(t, PROTO_MAGIQUE, 4)
+        || !protoAjouterU8(t, (unsigned)version))
+        return 0;
+    protoFermer(t, d);
+    return 1;
+}
+
+int protoEcrireAuth(ProtoTampon *t, const char *username, const char *password)
+{
+    size_t d;
+    if (!protoOuvrir(t, PROTO_AUTH, &d)
+        || !protoAjouterChaine(t, username)
+        || !protoAjouterChaine(t, password))
+        return 0;
+    protoFermer(t, d);
+    return 1;
+}
+
+int protoEcrireVote(ProtoTampon *t, int idElecteur, int idCandidat)
+{
+    size_t d;
+    if (!protoOuvrir(t, PROTO_VOTE, &d)
+        || !protoAjouterI32(t, idElecteur)
+        || !protoAjouterI32(t, idCandidat))
+        return 0;
+    protoFermer(t, d);
+    return 1;
+}
+
+int protoEcrireLot(ProtoTampon *t, const ProtoVote *votes, int nb)
+{
+    size_t d;
+    if (!protoOuvrir(t, PROTO_VOTEBATCH, &d) || !protoAjouterI32(t, nb)) return 0;
+    for (int k = 0; k < nb; k++)
+        if (!protoAjouterI32(t, votes[k].idElecteur)
+            || !protoAjouterI32(t, votes[k].idCandidat))
+            return 0;
+    protoFermer(t, d);
+    return 1;
+}
+
+int protoEcrireResultatLot(ProtoTampon *t, int nb, const unsigned char *bits)
+{
+    size_t d;
+    if (!protoOuvrir(t, PROTO_VOTEBATCH_OK, &d)
+        || !protoAjouterI32(t, nb)
+        || !protoTamponAjouter(t, bits, ((size_t)nb + 7) / 8))
+        return 0;
+    protoFermer(t, d);
+    return 1;
+}
+
+int protoEcrireAbonnement(ProtoTampon *t, int periodeMs)
+{
+    size_t d;
+    if (!protoOuvrir(t, PROTO_SUBSCRIBE, &d) || !protoAjouterI32(t, periodeMs)) return 0;
+    protoFermer(t, d);
+    return 1;
+}
+
+int protoEcrireResultats(ProtoTampon *t, const ProtoResultats *r, const ProtoVoix *voix)
+{
+    size_t d;
+    if (!protoOuvrir(t, r->base ? PROTO_RESULTATS_DELTA : PROTO_RESULTATS, &d)
+        || !protoAjouterI32(t, r->version)
+        || (r->base && !protoAjouterI32(t, r->base))
+        || !protoAjouterU8(t, r->voteOuvert ? 1u : 0u)
+        || !protoAjouterI32(t, r->inscrits)
+        || !protoAjouterI32(t, r->votants)
+        || !protoAjouterI32(t, r->blancs))
+        return 0;
+    for (int k = 0; k < r->nb; k++)
+        if (!protoAjouterI32(t, voix[k].idCandidat) || !protoAjouterI32(t, voix[k].voix))
+            return 0;
+    protoFermer(t, d);
+    return 1;
+}
+
+/* =========================================================
+ * 3. LECTURE DES CHAMPS
+ * ========================================================= */
+void protoLecteur(const ProtoTrame *trame, ProtoLecteur *l)
+{
+    l->p      = trame->champs;
+    l->reste  = trame->len;
+    l->erreur = 0;
+}
+
+unsigned protoLireU8(ProtoLecteur *l)
+{
+    if (l->erreur || l->reste < 1) {
+        l->erreur = 1;
+        return 0;
+    }
+    l->reste--;
+    return *l->p++;
+}
+
+long protoLireI32(ProtoLecteur *l)
+{
+    if (l->erreur || l->reste < 4) {
+        l->erreur = 1;
+        return 0;
+    }
+    unsigned long u = ((unsigned long)l->p[0] << 24) | ((unsigned long)l->p[1] << 16)
+                    | ((unsigned long)l->p[2] << 8)  |  (unsigned long)l->p[3];
+    l->p     += 4;
+    l->reste -= 4;
+    /* Signe sur 32 bits, quelle que soit la taille de long */
+    return (u & 0x80000000UL) ? -(long)(0xFFFFFFFFUL - u) - 1 : (long)u;
+}
+
+void protoLireChaine(ProtoLecteur *l, char *dst, size_t taille)
+{
+    size_t n = protoLireU8(l);
+    if (l->erreur || n > l->reste || n >= taille) {
+        l->erreur = 1;
+        dst[0] = '\0';
+        return;
+    }
+    memcpy(dst, l->p, n);
+    dst[n] = '\0';
+    l->p     += n;
+    l->reste -= n;
+}
+
+int protoLecteurOk(const ProtoLecteur *l)
+{
+    return !l->erreur;
+}
+
+int protoLireHello(const ProtoTrame *trame, int *version)
+{
+    ProtoLecteur l;
+    protoLecteur(trame, &l);
+    if (l.reste < 4 || memcmp(l.p, PROTO_MAGIQUE, 4) != 0) return 0;
+    l.p     += 4;
+    l.reste -= 4;
+    *version = (int)protoLireU8(&l);
+    return protoLecteurOk(&l);
+}
+
+int protoLireAuth(const ProtoTrame *trame, char *username, size_t tailleU,
+                  char *password, size_t tailleP)
+{
+    ProtoLecteur l;
+    protoLecteur(trame, &l);
+    protoLireChaine(&l, username, tailleU);
+    protoLireChaine(&l, password, tailleP);
+    return protoLecteurOk(&l);
+}
+
+int protoLireVote(const ProtoTrame *trame, int *idElecteur, int *idCandidat)
+{
+    ProtoLecteur l;
+    protoLecteur(trame, &l);
+    *idElecteur = (int)protoLireI32(&l);
+    *idCandidat = (int)protoLireI32(&l);
+    return protoLecteurOk(&l);
+}
+
+int protoNbLot(const ProtoTrame *trame)
+{
+    ProtoLecteur l;
+    protoLecteur(trame, &l);
+    long nb = protoLireI32(&l);
+    if (!protoLecteurOk(&l) || nb < 1 || nb > PROTO_LOT_MAX || l.reste != (size_t)nb * 8)
+        return -1;
+    return (int)nb;
+}
+
+void protoLireLot(const ProtoTrame *trame, ProtoVote *votes)
+{
+    ProtoLecteur l;
+    protoLecteur(trame, &l);
+    int nb = (int)protoLireI32(&l);
+    for (int k = 0; k < nb; k++) {
+        votes[k].idElecteur = (int)protoLireI32(&l);
+        votes[k].idCandidat = (int)protoLireI32(&l);
+    }
+}
+
+int protoLireResultatLot(const ProtoTrame *trame, int *nb, const unsigned char **bits)
+{
+    ProtoLecteur l;
+    protoLecteur(trame, &l);
+    long n = protoLireI32(&l);
+    if (!protoLecteurOk(&l) || n < 0 || n > PROTO_LOT_MAX || l.reste < ((size_t)n + 7) / 8)
+        return 0;
+    *nb   = (int)n;
+    *bits = l.p;
+    return 1;
+}
+
+int protoLireAbonnement(const ProtoTrame *trame, int *periodeMs)
+{
+    ProtoLecteur l;
+    protoLecteur(trame, &l);
+    *periodeMs = (int)protoLireI32(&l);
+    return protoLecteurOk(&l) && *periodeMs >= 0;
+}
+
+int protoLireResultats(const ProtoTrame *trame, ProtoResultats *r,
+                       ProtoVoix *voix, int maxVoix)
+{
+    ProtoLecteur l;
+    protoLecteur(trame, &l);
+    r->version    = protoLireI32(&l);
+    r->base       = trame->opcode == PROTO_RESULTATS_DELTA ? protoLireI32(&l) : 0;
+    r->voteOuvert = (int)protoLireU8(&l);
+    r->inscrits   = protoLireI32(&l);
+    r->votants    = protoLireI32(&l);
+    r->blancs     = protoLireI32(&l);
+    if (!protoLecteurOk(&l) || l.reste % 8 != 0 || l.reste / 8 > (size_t)maxVoix)
+        return 0;
+    r->nb = (int)(l.reste / 8);
+    for (int k = 0; k < r->nb; k++) {
+        voix[k].idCandidat = (int)protoLireI32(&l);
+        voix[k].voix       = (int)protoLireI32(&l);
+    }
+    return 1;
+}
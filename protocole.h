@@ -0,0 +1,255 @@
+/**
+ * @file protocole.h
+ * @brief Protocole trame (version 1) entre le CLIENT et le SERVEUR PIVOTE.
+ *
+ * Le protocole texte d'origine ("AUTH u p", "VOTE e c") suppose qu'un
+ * recv() = un message, ce que TCP ne garantit pas : deux reponses peuvent
+ * arriver collees, une requete peut arriver en deux morceaux. Le protocole
+ * trame delimite chaque message :
+ *
+ *   +------------------+--------+------------------------+
+ *   | longueur (4, BE) | opcode | champs binaires        |
+ *   +------------------+--------+------------------------+
+ *     longueur = 1 + taille des champs (opcode compris)
+ *
+ * Champs : entiers sur 4 octets signes gros-boutistes, chaines precedees
+ * de leur longueur sur 1 octet (sans '\0').
+ *
+ * Negociation : le client ouvre la session par HELLO ("PIVT" + version
+ * maximale geree) ; le serveur repond HELLO_OK avec la version retenue.
+ * La premiere trame commence toujours par un octet nul (longueur < 2^24),
+ * ce qu'aucune requete texte ne fait ("AUTH ...") : le serveur distingue
+ * ainsi les deux protocoles sur le premier octet recu et les anciens
+ * clients continuent de fonctionner. Face a un ancien serveur, le client
+ * recoit "AUTH_FAIL" en texte et se reconnecte en mode texte.
+ *
+ * Enchainement d'une session trame :
+ *   C: HELLO     S: HELLO_OK
+ *   C: AUTH      S: AUTH_OK + CANDIDATS   (ou AUTH_FAIL, 3 essais)
+ *   C: VOTE      S: VOTE_OK ou VOTE_ERREUR, puis fermeture
+ * Un compte "agregateur" (concentrateur de bureau de vote) envoie a la
+ * place des VOTEBATCH, autant qu'il veut sur la meme connexion :
+ *   C: VOTEBATCH S: VOTEBATCH_OK (un bit par vote, 1 = enregistre)
+ * Un compte "observateur" (presse, partis) s'abonne aux resultats ; la
+ * connexion ne sert plus ensuite qu'au serveur :
+ *   C: SUBSCRIBE S: CANDIDATS + RESULTATS, puis un RESULTATS_DELTA (voix
+ *                   changees) a chaque changement, au plus une fois par
+ *                   periode
+ * Un delta ne s'applique qu'aux resultats de version `base` ; un
+ * observateur en retard recoit a la place un RESULTATS complet, precede de
+ * CANDIDATS si le bulletin a change.
+ * Le client peut enchainer ses trames sans attendre les reponses.
+ *
+ * Ce module ne depend d'aucune API systeme (partage client / serveur).
+ */
+
+#ifndef PROTOCOLE_H
+#define PROTOCOLE_H
+
+#include <stddef.h>
+
+#define PROTO_VERSION    1
+#define PROTO_MAGIQUE    "PIVT"
+#define PROTO_ENTETE     5             /* longueur (4) + opcode (1)      */
+#define PROTO_TRAME_MAX  (64 * 1024)   /* longueur maximale acceptee     */
+#define PROTO_LOT_MAX    4096          /* votes par VOTEBATCH            */
+
+typedef enum {
+    PROTO_HELLO           = 0x01, /* C->S "PIVT", u8 version maximale                   */
+    PROTO_HELLO_OK        = 0x02, /* S->C "PIVT", u8 version retenue                    */
+    PROTO_AUTH            = 0x10, /* C->S chaine username, chaine password              */
+    PROTO_AUTH_OK         = 0x11, /* S->C (vide)                                        */
+    PROTO_AUTH_FAIL       = 0x12, /* S->C (vide)                                        */
+    PROTO_CANDIDATS       = 0x13, /* S->C i32 version, {i32 id, chaine nom}*            */
+    PROTO_VOTE            = 0x20, /* C->S i32 idElecteur, i32 idCandidat                */
+    PROTO_VOTE_OK         = 0x21, /* S->C (vide)                                        */
+    PROTO_VOTE_ERREUR     = 0x22, /* S->C (vide)                                        */
+    PROTO_VOTEBATCH       = 0x23, /* C->S i32 n, n x { i32 idE, i32 idC }               */
+    PROTO_VOTEBATCH_OK    = 0x24, /* S->C i32 n, (n + 7) / 8 octets de bits             */
+    PROTO_SUBSCRIBE       = 0x30, /* C->S i32 periode minimale en ms                    */
+    PROTO_RESULTATS       = 0x31, /* S->C i32 version, scrutin, {i32 id, i32 voix}*     */
+    PROTO_RESULTATS_DELTA = 0x32, /* S->C i32 version, i32 base, scrutin, voix changees */
+    PROTO_ERREUR          = 0x7F  /* S->C trame invalide ou inattendue                  */
+} ProtoOpcode;
+
+/**
+ * Tampon d'octets extensible : accumule les octets recus jusqu'a former des
+ * trames completes, ou les trames a envoyer. Les donnees utiles sont
+ * data[debut .. fin[ ; un tampon a zero est vide et n'alloue rien.
+ */
+typedef struct {
+    unsigned char *data;
+    size_t         debut;
+    size_t         fin;
+    size_t         cap;
+} ProtoTampon;
+
+/** Trame extraite ; `champs` pointe dans le tampon d'origine. */
+typedef struct {
+    int                  opcode;
+    const unsigned char *champs;
+    size_t               len;
+} ProtoTrame;
+
+/** Une entree de VOTEBATCH. */
+typedef struct {
+    int idElecteur;
+    int idCandidat;
+} ProtoVote;
+
+/** Voix d'un candidat dans RESULTATS / RESULTATS_DELTA. */
+typedef struct {
+    int idCandidat;
+    int voix;
+} ProtoVoix;
+
+/**
+ * Champs fixes de RESULTATS et RESULTATS_DELTA. "scrutin" ci-dessus :
+ * u8 voteOuvert, i32 inscrits, i32 votants, i32 blancs.
+ */
+typedef struct {
+    long version;      /* croissante, 1 pour la premiere                */
+    long base;         /* delta : version a laquelle il s'applique ;
+                          0 : resultats complets (PROTO_RESULTATS)        */
+    int  voteOuvert;
+    long inscrits;
+    long votants;      /* bulletins, blancs compris                      */
+    long blancs;
+    int  nb;           /* entrees de voix qui suivent                    */
+} ProtoResultats;
+
+/** Curseur de lecture des champs d'une trame. */
+typedef struct {
+    const unsigned char *p;
+    size_t               reste;
+    int                  erreur;   /* 1 si un champ depasse la trame */
+} ProtoLecteur;
+
+/* =========================================================
+ * 1. TAMPON
+ * ========================================================= */
+void protoTamponLiberer(ProtoTampon *t);
+
+/** Vide le tampon sans rendre la memoire. */
+void protoTamponVider(ProtoTampon *t);
+
+/** Nombre d'octets utiles. */
+size_t protoTamponTaille(const ProtoTampon *t);
+
+/**
+ * @brief Garantit `n` octets libres en fin de tampon (pour y recevoir).
+ * @return Adresse ou ecrire, NULL si memoire insuffisante. A confirmer
+ *         par protoTamponValider().
+ */
+unsigned char *protoTamponReserver(ProtoTampon *t, size_t n);
+
+/** Confirme `n` octets ecrits a l'adresse rendue par protoTamponReserver(). */
+void protoTamponValider(ProtoTampon *t, size_t n);
+
+/** Copie `n` octets en fin de tampon ; 0 si memoire insuffisante. */
+int protoTamponAjouter(ProtoTampon *t, const void *data, size_t n);
+
+/**
+ * @brief Extrait la premiere trame complete du tampon.
+ *
+ * La trame reste valide jusqu'au prochain ajout ou reservation sur `t`.
+ *
+ * @return 1 si une trame est extraite, 0 s'il manque des octets,
+ *         -1 si l'entete est invalide (longueur nulle ou > PROTO_TRAME_MAX).
+ */
+int protoExtraire(ProtoTampon *t, ProtoTrame *trame);
+
+/** 1 si protoExtraire() ne rendrait pas 0 (trame complete ou entete invalide). */
+int protoTramePrete(const ProtoTampon *t);
+
+/* =========================================================
+ * 2. ECRITURE DE TRAMES
+ * ========================================================= */
+/**
+ * @brief Commence une trame en fin de tampon ; les champs sont ajoutes par
+ * protoAjouterI32()/protoAjouterChaine(), puis protoFermer() fixe la longueur.
+ * @param debut Recoit la position de la trame, a passer a protoFermer().
+ * @return 0 si memoire insuffisante.
+ */
+int protoOuvrir(ProtoTampon *t, int opcode, size_t *debut);
+int protoAjouterU8(ProtoTampon *t, unsigned v);
+int protoAjouterI32(ProtoTampon *t, long v);
+
+/** Chaine tronquee a 255 octets. */
+int protoAjouterChaine(ProtoTampon *t, const char *s);
+void protoFermer(ProtoTampon *t, size_t debut);
+
+/** Trame sans champ (AUTH_OK, VOTE_OK...). */
+int protoEcrireVide(ProtoTampon *t, int opcode);
+int protoEcrireHello(ProtoTampon *t, int opcode, int version);
+int protoEcrireAuth(ProtoTampon *t, const char *username, const char *password);
+int protoEcrireVote(ProtoTampon *t, int idElecteur, int idCandidat);
+int protoEcrireLot(ProtoTampon *t, const ProtoVote *votes, int nb);
+
+/**
+ * @brief Reponse a un VOTEBATCH : le bit k % 8 de l'octet k / 8 vaut 1 si
+ * le vote k est enregistre.
+ */
+int protoEcrireResultatLot(ProtoTampon *t, int nb, const unsigned char *bits);
+
+/** SUBSCRIBE ; `periodeMs` 0 : la periode du serveur. */
+int protoEcrireAbonnement(ProtoTampon *t, int periodeMs);
+
+/**
+ * @brief RESULTATS si r->base vaut 0, RESULTATS_DELTA sinon, avec les
+ *        r->nb entrees de `voix`.
+ */
+int protoEcrireResultats(ProtoTampon *t, const ProtoResultats *r, const ProtoVoix *voix);
+
+/* =========================================================
+ * 3. LECTURE DES CHAMPS
+ * ========================================================= */
+void     protoLecteur(const ProtoTrame *trame, ProtoLecteur *l);
+unsigned protoLireU8(ProtoLecteur *l);
+long     protoLireI32(ProtoLecteur *l);
+
+/**
+ * @brief Lit une chaine dans `dst` (terminee par '\0').
+ * Une chaine plus longue que `taille - 1` est une erreur.
+ */
+void protoLireChaine(ProtoLecteur *l, char *dst, size_t taille);
+
+/** Fin de lecture : 1 si tous les champs etaient presents. */
+int protoLecteurOk(const ProtoLecteur *l);
+
+/**
+ * @brief Decode HELLO ou HELLO_OK.
+ * @return 1 si la trame est bien formee et porte la chaine magique.
+ */
+int protoLireHello(const ProtoTrame *trame, int *version);
+int protoLireAuth(const ProtoTrame *trame, char *username, size_t tailleU,
+                  char *password, size_t tailleP);
+int protoLireVote(const ProtoTrame *trame, int *idElecteur, int *idCandidat);
+
+/**
+ * @brief Nombre de votes d'un VOTEBATCH.
+ * @return n, ou -1 si n est hors de [1, PROTO_LOT_MAX] ou ne correspond
+ *         pas a la longueur de la trame.
+ */
+int protoNbLot(const ProtoTrame *trame);
+
+/** Decode les protoNbLot() votes d'un VOTEBATCH valide dans `votes`. */
+void protoLireLot(const ProtoTrame *trame, ProtoVote *votes);
+
+/**
+ * @brief Decode VOTEBATCH_OK ; `bits` pointe dans la trame.
+ * @return 1 si la trame est bien formee.
+ */
+int protoLireResultatLot(const ProtoTrame *trame, int *nb, const unsigned char **bits);
+
+int protoLireAbonnement(const ProtoTrame *trame, int *periodeMs);
+
+/**
+ * @brief Decode RESULTATS ou RESULTATS_DELTA : entete dans `r`, voix dans
+ *        `voix` (au plus `maxVoix` entrees).
+ * @return 1 si la trame est bien formee et tient dans `voix`.
+ */
+int protoLireResultats(const ProtoTrame *trame, ProtoResultats *r,
+                       ProtoVoix *voix, int maxVoix);
+
+#endif /* PROTOCOLE_H */
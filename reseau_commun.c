@@ -0,0 +1,296 @@
+/**
+ * @file reseau_commun.c
+ * @brief Elements communs aux backends reseau (voir reseau_commun.h).
+ */
+
+#if !defined(_WIN32)
+#define _GNU_SOURCE   /* clock_gettime */
+#endif
+
+#include "reseau_commun.h"
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+long long reseauMaintenantMs(void)
+{
+#if defined(_WIN32)
+    return (long long)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
+
+void activiteAjouter(ListeActivite *l, SessionReseau *s, long long maintenant)
+{
+    s->derniereActivite = maintenant;
+    s->prec = l->derniere;
+    s->suiv = NULL;
+    if (l->derniere) l->derniere->suiv = s; else l->premiere = s;
+    l->derniere = s;
+}
+
+void activiteRetirer(ListeActivite *l, SessionReseau *s)
+{
+    if (s->prec) s->prec->suiv = s->suiv; else l->premiere = s->suiv;
+    if (s->suiv) s->suiv->prec = s->prec; else l->derniere = s->prec;
+    s->prec = s->suiv = NULL;
+}
+
+void activiteToucher(ListeActivite *l, SessionReseau *s, long long maintenant)
+{
+    s->derniereActivite = maintenant;
+    if (l->derniere != s) {
+        activiteRetirer(l, s);
+        activiteAjouter(l, s, maintenant);
+    }
+}
+
+void reseauLibererSession(SessionReseau *s)
+{
+    protoTamponLiberer(&s->trames);
+    protoTamponLiberer(&s->sortie);
+    sessionRendreListe(s->liste);
+    s->liste = NULL;
+    if (s->vote && s->vote->fini)
+        sessionVoteLiberer(s->vote);
+    else if (s->vote)
+        s->vote->session = NULL;   /* libere par sessionFinsRelever() */
+    s->vote = NULL;
+}
+
+/* =========================================================
+ * ENTREE
+ * ========================================================= */
+int reseauAjouterEntree(SessionReseau *s, const char *data, size_t n)
+{
+    if (n == 0) return 1;
+    if (s->mode == MODE_INCONNU)
+        s->mode = (data[0] == '\0') ? MODE_TRAMES : MODE_TEXTE;
+
+    if (s->mode == MODE_TRAMES) {
+        if (protoTamponTaille(&s->trames) + n > TAILLE_ENTREE_TRAMES) return 0;
+        return protoTamponAjouter(&s->trames, data, n);
+    }
+    if (n > TAILLE_ENTREE - 1 - s->lu) return 0;
+    memcpy(s->entree + s->lu, data, n);
+    s->lu += n;
+    return 1;
+}
+
+int reseauEntreeDisponible(const SessionReseau *s)
+{
+    if (s->etat == VOTE_EN_COURS) return s->vote->fini;
+    if (s->etat != ATTENTE_AUTH && s->etat != ATTENTE_VOTE) return 0;
+    if (s->mode == MODE_TEXTE) return s->lu > 0;
+    return s->mode == MODE_TRAMES && protoTramePrete(&s->trames);
+}
+
+int reseauVoteEnAttente(const SessionReseau *s)
+{
+    return s->etat == VOTE_EN_COURS && !s->vote->fini;
+}
+
+void reseauListeEnvoyee(SessionReseau *s)
+{
+    sessionRendreListe(s->liste);
+    s->liste = NULL;
+    s->etat  = ATTENTE_VOTE;
+}
+
+/* =========================================================
+ * MACHINE A ETATS
+ * ========================================================= */
+
+/* Met la session de cote jusqu'a la fin de `v` ; 0 si memoire insuffisante. */
+static int attendreVote(SessionReseau *s, SessionVote *v)
+{
+    if (!v) return 0;
+    s->vote = v;
+    s->etat = VOTE_EN_COURS;
+    return 1;
+}
+
+static int traiterTexte(SessionReseau *s, Reponse rep[2])
+{
+    int nb = 0, idE, idC;
+
+    if (s->etat == VOTE_EN_COURS) {   /* vote fini */
+        int ok = s->vote->acceptes == 1;
+        sessionVoteLiberer(s->vote);
+        s->vote = NULL;
+        s->etat = TERMINEE;
+        rep[0].data = ok ? "OK" : "ERREUR";
+        rep[0].len  = ok ? 2 : 6;
+        return 1;
+    }
+
+    s->entree[s->lu] = '\0';
+    while (s->lu > 0 && (s->entree[s->lu - 1] == '\n' || s->entree[s->lu - 1] == '\r'))
+        s->entree[--s->lu] = '\0';
+
+    switch (s->etat) {
+    case ATTENTE_AUTH:
+        if (!sessionAuthentifier(s->entree, s->username)) {
+            rep[nb].data = "AUTH_FAIL"; rep[nb++].len = 9;
+            s->etat = TERMINEE;
+            break;
+        }
+        s->liste = sessionPrendreListe();
+        if (!s->liste) return -1;
+        rep[nb].data = "AUTH_OK";         rep[nb++].len = 7;
+        rep[nb].data = s->liste->texte;   rep[nb++].len = s->liste->lenTexte;
+        s->etat = LISTE_ENVOYEE;
+        break;
+    case ATTENTE_VOTE:
+        if (s->fins && sessionLireVote(s->entree, &idE, &idC)) {
+            if (!attendreVote(s, sessionSoumettreVote(s->fins, s, s->username, idE, idC)))
+                return -1;
+            break;                     /* reponse a la fin du vote */
+        }
+        if (sessionVoter(s->username, s->entree)) {
+            rep[nb].data = "OK";     rep[nb++].len = 2;
+        } else {
+            rep[nb].data = "ERREUR"; rep[nb++].len = 6;
+        }
+        s->etat = TERMINEE;
+        break;
+    default:
+        break;
+    }
+    s->lu = 0;
+    return nb;
+}
+
+/* VOTEBATCH d'un agregateur ; renvoie 0 si memoire insuffisante. */
+static int traiterLot(SessionReseau *s, const ProtoTrame *t, int nb)
+{
+    ProtoVote     *votes = (ProtoVote *)malloc((size_t)nb * sizeof(*votes));
+    unsigned char *bits  = s->fins ? NULL : (unsigned char *)malloc(((size_t)nb + 7) / 8);
+    int            ok    = votes && (s->fins || bits);
+
+    if (ok) {
+        protoLireLot(t, votes);
+        if (s->fins) {
+            ok = attendreVote(s, sessionSoumettreLot(s->fins, s, votes, nb));
+        } else {
+            sessionVoterLot(votes, nb, bits);
+            ok = protoEcrireResultatLot(&s->sortie, nb, bits);
+        }
+    }
+    free(votes);
+    free(bits);
+    return ok;
+}
+
+/* Traite une trame ; renvoie 0 si memoire insuffisante. */
+static int traiterTrame(SessionReseau *s, const ProtoTrame *t)
+{
+    ProtoTampon          *out = &s->sortie;
+    const ListeCandidats *liste;
+    char password[AUTH_MAX_PASSWORD + 1];
+    int  version, idE, idC, nb, ok;
+
+    if (s->version == 0) {
+        /* HELLO d'abord : fixe la version commune */
+        if (t->opcode != PROTO_HELLO || !protoLireHello(t, &version) || version < 1)
+            goto invalide;
+        s->version = version < PROTO_VERSION ? version : PROTO_VERSION;
+        return protoEcrireHello(out, PROTO_HELLO_OK, s->version);
+    }
+
+    if (s->etat == ATTENTE_AUTH && t->opcode == PROTO_AUTH) {
+        if (!protoLireAuth(t, s->username, sizeof(s->username), password, sizeof(password)))
+            goto invalide;
+        s->profil = sessionVerifierCompte(s->username, password);
+        if (s->profil == PROFIL_REFUSE) {
+            if (++s->tentatives >= SESSION_TENTATIVES) s->etat = TERMINEE;
+            return protoEcrireVide(out, PROTO_AUTH_FAIL);
+        }
+        s->etat = ATTENTE_VOTE;   /* frontieres explicites : pas d'etape LISTE_ENVOYEE */
+        if (!(liste = sessionPrendreListe())) return 0;
+        ok = protoEcrireVide(out, PROTO_AUTH_OK)
+          && protoTamponAjouter(out, liste->trame, liste->lenTrame);
+        sessionRendreListe(liste);
+        return ok;
+    }
+
+    if (s->etat == ATTENTE_VOTE && t->opcode == PROTO_VOTE && s->profil == PROFIL_VOTANT) {
+        if (!protoLireVote(t, &idE, &idC)) goto invalide;
+        if (s->fins)
+            return attendreVote(s, sessionSoumettreVote(s->fins, s, s->username, idE, idC));
+        s->etat = TERMINEE;
+        return protoEcrireVide(out, sessionEnregistrerVote(s->username, idE, idC)
+                                    ? PROTO_VOTE_OK : PROTO_VOTE_ERREUR);
+    }
+
+    if (s->etat == ATTENTE_VOTE && t->opcode == PROTO_VOTEBATCH
+        && s->profil == PROFIL_AGREGATEUR) {
+        if ((nb = protoNbLot(t)) < 0) goto invalide;
+        return traiterLot(s, t, nb);   /* puis la session attend le lot suivant */
+    }
+
+    if (s->etat == ATTENTE_VOTE && t->opcode == PROTO_SUBSCRIBE
+        && s->profil == PROFIL_OBSERVATEUR) {
+        if (!protoLireAbonnement(t, &s->periodeMs)) goto invalide;
+        s->etat = ABONNEE;             /* la suite vient de la diffusion */
+        return 1;
+    }
+
+invalide:
+    s->etat = TERMINEE;
+    return protoEcrireVide(out, PROTO_ERREUR);
+}
+
+/* Reponse au vote fini ; renvoie 0 si memoire insuffisante. */
+static int repondreVote(SessionReseau *s)
+{
+    SessionVote *v = s->vote;
+    int          ok;
+
+    if (v->resultats) {                /* VOTEBATCH : le lot suivant peut suivre */
+        s->etat = ATTENTE_VOTE;
+        ok = protoEcrireResultatLot(&s->sortie, v->nb, v->resultats);
+    } else {
+        s->etat = TERMINEE;
+        ok = protoEcrireVide(&s->sortie, v->acceptes == 1 ? PROTO_VOTE_OK : PROTO_VOTE_ERREUR);
+    }
+    sessionVoteLiberer(v);
+    s->vote = NULL;
+    return ok;
+}
+
+static int traiterTrames(SessionReseau *s, Reponse rep[2])
+{
+    ProtoTrame t;
+
+    protoTamponVider(&s->sortie);
+    if (s->etat == VOTE_EN_COURS && !repondreVote(s)) return -1;
+    while (s->etat == ATTENTE_AUTH || s->etat == ATTENTE_VOTE) {
+        int r = protoExtraire(&s->trames, &t);
+        if (r == 0) break;
+        if (r < 0) {
+            s->etat = TERMINEE;
+            if (!protoEcrireVide(&s->sortie, PROTO_ERREUR)) return -1;
+            break;
+        }
+        if (!traiterTrame(s, &t)) return -1;
+    }
+    if (protoTamponTaille(&s->sortie) == 0) return 0;
+    rep[0].data = (const char *)s->sortie.data + s->sortie.debut;
+    rep[0].len  = protoTamponTaille(&s->sortie);
+    return 1;
+}
+
+int reseauTraiterMessage(SessionReseau *s, Reponse rep[2])
+{
+    if (s->mode == MODE_TRAMES) return traiterTrames(s, rep);
+    if (s->mode == MODE_TEXTE)  return traiterTexte(s, rep);
+    return 0;
+}
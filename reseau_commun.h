@@ -0,0 +1,152 @@
+/**
+ * @file reseau_commun.h
+ * @brief Elements communs aux backends reseau (pool de threads, epoll, io_uring).
+ *
+ * Chaque backend gere ses sockets a sa facon mais partage :
+ *   - l'etat de session et la machine a etats du protocole
+ *     (ATTENTE_AUTH -> LISTE_ENVOYEE -> ATTENTE_VOTE -> TERMINEE, ou
+ *     ABONNEE pour un observateur) ;
+ *   - la detection du protocole (texte ou trame, voir protocole.h) sur le
+ *     premier octet recu, et le reassemblage des trames ;
+ *   - la liste d'activite, ordonnee de la session la plus anciennement
+ *     active a la plus recente, qui permet d'expirer les sessions
+ *     inactives sans parcourir toutes les connexions.
+ *
+ * Utilisation par un backend : chaque bloc recu est passe a
+ * reseauAjouterEntree() ; tant que reseauEntreeDisponible(), les reponses
+ * de reseauTraiterMessage() sont envoyees dans l'ordre. Elles doivent etre
+ * parties (ou copiees) avant l'appel suivant.
+ *
+ * Un backend evenementiel donne a ses sessions sa file de fins (`fins`,
+ * session.h) : un VOTE ou un VOTEBATCH est alors soumis sans attente et la
+ * session passe en VOTE_EN_COURS, sans reponse. Le backend cesse de lire
+ * son socket (reseauVoteEnAttente()) ; quand sessionFinsRelever() rend le
+ * vote, reseauEntreeDisponible() redevient vrai et reseauTraiterMessage()
+ * donne la reponse. Sans file de fins (pool de threads), le vote est
+ * attendu dans reseauTraiterMessage().
+ */
+
+#ifndef RESEAU_COMMUN_H
+#define RESEAU_COMMUN_H
+
+#include <stddef.h>
+#include "session.h"
+#include "protocole.h"
+
+#define TAILLE_ENTREE        256   /* "AUTH <login> <mdp>" tient en 160 octets */
+#define TAILLE_ENTREE_TRAMES (PROTO_ENTETE + PROTO_TRAME_MAX)
+#define SESSION_TENTATIVES   3     /* essais d'AUTH par session trame       */
+
+typedef enum {
+    ATTENTE_AUTH,    /* attend "AUTH <username> <password>"          */
+    LISTE_ENVOYEE,   /* AUTH_OK + liste en cours d'envoi (texte)     */
+    ATTENTE_VOTE,    /* liste partie, attend "VOTE <idE> <idC>"      */
+    VOTE_EN_COURS,   /* vote soumis sans attente, attend sa fin      */
+    TERMINEE,        /* reponse finale en cours d'envoi, puis close  */
+    ABONNEE          /* SUBSCRIBE recu : une fois les reponses
+                        parties, la socket passe a diffusionAbonner() */
+} EtatSession;
+
+typedef enum {
+    MODE_INCONNU,    /* rien recu                                    */
+    MODE_TEXTE,      /* un recv = un message, dans `entree`          */
+    MODE_TRAMES      /* trames reassemblees dans `trames`            */
+} ModeSession;
+
+/** Partie commune d'une connexion ; premier membre des structures des backends. */
+typedef struct SessionReseau {
+    int           fd;
+    EtatSession   etat;
+    ModeSession   mode;
+    int           version;      /* version trame negociee, 0 avant HELLO */
+    int           tentatives;   /* AUTH refuses (mode trame)             */
+    ProfilSession profil;       /* fixe par un AUTH trame accepte        */
+    int           periodeMs;    /* demandee par SUBSCRIBE                */
+    char          username[AUTH_MAX_USERNAME + 1];
+    char          entree[TAILLE_ENTREE];
+    size_t        lu;
+    ProtoTampon   trames;       /* entree en mode trame                  */
+    ProtoTampon   sortie;       /* reponses en mode trame                */
+    const ListeCandidats *liste;   /* bulletin tenu pendant son envoi */
+    SessionFins  *fins;         /* NULL : votes attendus sur place       */
+    SessionVote  *vote;         /* en cours (VOTE_EN_COURS)              */
+    long long     derniereActivite;
+    struct SessionReseau *prec;
+    struct SessionReseau *suiv;
+} SessionReseau;
+
+typedef struct {
+    SessionReseau *premiere;   /* inactive depuis le plus longtemps */
+    SessionReseau *derniere;
+} ListeActivite;
+
+/** Morceau de reponse a envoyer tel quel, dans l'ordre. */
+typedef struct {
+    const char *data;
+    size_t      len;
+} Reponse;
+
+/** Horloge monotone en millisecondes. */
+long long reseauMaintenantMs(void);
+
+void activiteAjouter(ListeActivite *l, SessionReseau *s, long long maintenant);
+void activiteRetirer(ListeActivite *l, SessionReseau *s);
+
+/** Marque la session comme active : elle passe en fin de liste. */
+void activiteToucher(ListeActivite *l, SessionReseau *s, long long maintenant);
+
+/**
+ * Rend les tampons de trames et le bulletin tenu, et abandonne le vote en
+ * cours ; la structure elle-meme reste a l'appelant.
+ */
+void reseauLibererSession(SessionReseau *s);
+
+/**
+ * @brief Ajoute des octets recus a l'entree de la session.
+ *
+ * Le premier octet fixe le protocole : nul pour une trame HELLO, sinon
+ * texte.
+ *
+ * @return 0 si l'entree deborde (message texte > TAILLE_ENTREE - 1,
+ *         trames en attente > TAILLE_ENTREE_TRAMES) : la session doit etre
+ *         fermee.
+ */
+int reseauAjouterEntree(SessionReseau *s, const char *data, size_t n);
+
+/**
+ * 1 si l'etat attend un message et qu'un message complet est arrive, ou si
+ * le vote en cours est fini.
+ */
+int reseauEntreeDisponible(const SessionReseau *s);
+
+/** 1 tant que le vote soumis n'est pas fini : le socket n'est plus lu. */
+int reseauVoteEnAttente(const SessionReseau *s);
+
+/** La liste (mode texte) est partie : rend le bulletin, passe en ATTENTE_VOTE. */
+void reseauListeEnvoyee(SessionReseau *s);
+
+/**
+ * @brief Traite les messages disponibles selon l'etat courant.
+ *
+ * Mode texte : traite le message accumule dans `s->entree`, fait avancer
+ * l'etat (ATTENTE_AUTH -> LISTE_ENVOYEE ou TERMINEE, ATTENTE_VOTE ->
+ * TERMINEE, ou VOTE_EN_COURS -> TERMINEE a la fin du vote) et vide
+ * l'entree. Les reponses sont envoyees separement, dans
+ * l'ordre, comme le faisait le serveur bloquant ; la liste est le texte du
+ * bulletin partage, tenu par la session jusqu'a reseauListeEnvoyee().
+ *
+ * Mode trame : traite toutes les trames completes (HELLO, AUTH, VOTE,
+ * VOTEBATCH, SUBSCRIBE ; une session agregateur reste en ATTENTE_VOTE
+ * apres chaque lot, une session observateur passe en ABONNEE sans
+ * reponse) ; les reponses sont concatenees dans `s->sortie` et rendues en un seul
+ * morceau. Une trame invalide ou inattendue termine la session par
+ * PROTO_ERREUR.
+ *
+ * @param s      Session.
+ * @param rep    Recoit au plus 2 reponses.
+ * @return Nombre de reponses (0 si l'etat n'attend pas de message),
+ *         -1 si memoire insuffisante.
+ */
+int reseauTraiterMessage(SessionReseau *s, Reponse rep[2]);
+
+#endif /* RESEAU_COMMUN_H */
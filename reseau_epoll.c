@@ -0,0 +1,369 @@
+/**
+ * @file reseau_epoll.c
+ * @brief Boucle evenementielle epoll du SERVEUR PIVOTE (voir reseau_epoll.h).
+ *
+ * Compile uniquement sous Linux ; sur les autres systemes le fichier est vide
+ * et le serveur garde le pool de threads.
+ */
+
+#if defined(__linux__)
+
+#define _GNU_SOURCE   /* accept4 */
+
+#include "reseau_epoll.h"
+#include "reseau_commun.h"
+#include "diffusion.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#define NB_EVENEMENTS  256   /* evenements traites par appel a epoll_wait */
+
+/* =========================================================
+ * CONNEXIONS
+ * ========================================================= */
+typedef struct {
+    SessionReseau s;              /* etat, entree, liste d'activite */
+    char         *sortie;         /* reste a envoyer, NULL si tout est parti */
+    size_t        sortieLen;
+    size_t        sortieEnvoye;
+} Connexion;
+
+typedef struct {
+    int           ep;
+    int           ecoute;
+    int           reserve;        /* fd de secours pour survivre a EMFILE */
+    int           nbConnexions;
+    ListeActivite activite;
+    SessionFins  *fins;           /* votes finis ; NULL : votes bloquants */
+} Boucle;
+
+static void oublierConnexion(Boucle *b, Connexion *c)
+{
+    activiteRetirer(&b->activite, &c->s);
+    reseauLibererSession(&c->s);
+    free(c->sortie);
+    free(c);
+    b->nbConnexions--;
+}
+
+static void fermerConnexion(Boucle *b, Connexion *c)
+{
+    close(c->s.fd);           /* retire aussi le fd de l'ensemble epoll */
+    oublierConnexion(b, c);
+}
+
+/* Observateur abonne, reponses parties : la socket passe a la diffusion. */
+static void confierConnexion(Boucle *b, Connexion *c)
+{
+    epoll_ctl(b->ep, EPOLL_CTL_DEL, c->s.fd, NULL);
+    if (diffusionAbonner(c->s.fd, c->s.periodeMs))
+        oublierConnexion(b, c);
+    else
+        fermerConnexion(b, c);
+}
+
+/* =========================================================
+ * ENTREES / SORTIES NON BLOQUANTES
+ * ========================================================= */
+
+/* Envoie ce que le noyau accepte ; renvoie 0 sur erreur fatale. */
+static int ecrireDirect(int fd, const char **data, size_t *len)
+{
+    while (*len > 0) {
+        ssize_t n = send(fd, *data, *len, MSG_NOSIGNAL);
+        if (n > 0) {
+            *data += n;
+            *len  -= (size_t)n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 1;
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Met un message en file d'envoi. Il part immediatement si rien n'attend ;
+ * seul le reste eventuel est copie, EPOLLOUT s'occupera de la suite.
+ */
+static int envoyer(Connexion *c, const char *data, size_t len)
+{
+    if (!c->sortie) {
+        if (!ecrireDirect(c->s.fd, &data, &len)) return 0;
+        if (len == 0) return 1;
+        c->sortie = (char *)malloc(len);
+        if (!c->sortie) return 0;
+        memcpy(c->sortie, data, len);
+        c->sortieLen    = len;
+        c->sortieEnvoye = 0;
+        return 1;
+    }
+
+    char *t = (char *)realloc(c->sortie, c->sortieLen + len);
+    if (!t) return 0;
+    memcpy(t + c->sortieLen, data, len);
+    c->sortie     = t;
+    c->sortieLen += len;
+    return 1;
+}
+
+/* Reprend l'envoi en attente ; renvoie 0 sur erreur fatale. */
+static int vider(Connexion *c)
+{
+    const char *data = c->sortie + c->sortieEnvoye;
+    size_t      len  = c->sortieLen - c->sortieEnvoye;
+
+    if (!ecrireDirect(c->s.fd, &data, &len)) return 0;
+    if (len > 0) {
+        c->sortieEnvoye = c->sortieLen - len;
+        return 1;
+    }
+    free(c->sortie);
+    c->sortie = NULL;
+    c->sortieLen = c->sortieEnvoye = 0;
+    return 1;
+}
+
+/*
+ * Lit tout ce qui est disponible (mode front).
+ * Renvoie -1 sur erreur ou entree trop longue, 0 si le pair a ferme,
+ * 1 sinon.
+ */
+static int lire(Connexion *c)
+{
+    char bloc[4096];
+
+    while (1) {
+        ssize_t n = recv(c->s.fd, bloc, sizeof(bloc), 0);
+        if (n > 0) {
+            if (!reseauAjouterEntree(&c->s, bloc, (size_t)n)) return -1;
+        } else if (n == 0) {
+            return 0;
+        } else if (errno == EINTR) {
+            continue;
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 1;
+        } else {
+            return -1;
+        }
+    }
+}
+
+/* =========================================================
+ * MACHINE A ETATS
+ * ========================================================= */
+
+/* Traite le message recu dans l'etat courant ; renvoie 0 si envoi impossible. */
+static int traiterMessage(Connexion *c)
+{
+    Reponse rep[2];
+    int     nb = reseauTraiterMessage(&c->s, rep);
+
+    if (nb < 0) return 0;
+    for (int i = 0; i < nb; i++)
+        if (!envoyer(c, rep[i].data, rep[i].len)) return 0;
+    return 1;
+}
+
+static void surEvenement(Boucle *b, Connexion *c, uint32_t ev, long long maintenant)
+{
+    int pairFerme = 0;
+
+    activiteToucher(&b->activite, &c->s, maintenant);
+    if (ev & EPOLLERR) {
+        fermerConnexion(b, c);
+        return;
+    }
+    if ((ev & EPOLLOUT) && c->sortie && !vider(c)) {
+        fermerConnexion(b, c);
+        return;
+    }
+    /* Vote en cours : plus rien n'est lu, le client attend sa reponse */
+    if ((ev & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) && !reseauVoteEnAttente(&c->s)) {
+        int r = lire(c);
+        if (r < 0) {
+            fermerConnexion(b, c);
+            return;
+        }
+        pairFerme = (r == 0);
+    }
+
+    /* Avance tant qu'un message complet peut etre traite */
+    while (1) {
+        if (c->s.etat == LISTE_ENVOYEE && !c->sortie)
+            reseauListeEnvoyee(&c->s);
+        if (reseauEntreeDisponible(&c->s)) {
+            if (!traiterMessage(c)) {
+                fermerConnexion(b, c);
+                return;
+            }
+            continue;
+        }
+        break;
+    }
+
+    if (pairFerme || (c->s.etat == TERMINEE && !c->sortie))
+        fermerConnexion(b, c);
+    else if (c->s.etat == ABONNEE && !c->sortie)
+        confierConnexion(b, c);
+}
+
+/*
+ * Votes finis : chaque session reprend ou elle s'etait arretee, et relit
+ * ce qui est arrive sur son socket pendant l'attente (mode front).
+ */
+static void reprendre(Boucle *b, long long maintenant)
+{
+    SessionVote *v = sessionFinsRelever(b->fins);
+    while (v) {
+        SessionVote *suiv = v->suiv;   /* v est libere avec sa reponse */
+        surEvenement(b, (Connexion *)v->session, EPOLLIN, maintenant);
+        v = suiv;
+    }
+}
+
+/* =========================================================
+ * ACCEPTATION ET BOUCLE PRINCIPALE
+ * ========================================================= */
+static void accepter(Boucle *b, int maxConnexions, long long maintenant)
+{
+    while (1) {
+        int fd = accept4(b->ecoute, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if ((errno == EMFILE || errno == ENFILE) && b->reserve >= 0) {
+                /* Plus de fd : libere la reserve pour accepter et refuser */
+                close(b->reserve);
+                fd = accept(b->ecoute, NULL, NULL);
+                if (fd >= 0) close(fd);
+                b->reserve = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                continue;
+            }
+            return;   /* EAGAIN : plus de connexion en attente */
+        }
+        if (b->nbConnexions >= maxConnexions) {
+            close(fd);
+            continue;
+        }
+
+        Connexion *c = (Connexion *)calloc(1, sizeof(*c));
+        if (!c) {
+            close(fd);
+            continue;
+        }
+        c->s.fd   = fd;
+        c->s.etat = ATTENTE_AUTH;
+        c->s.fins = b->fins;
+
+        struct epoll_event ev;
+        ev.events   = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.ptr = c;
+        if (epoll_ctl(b->ep, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            free(c);
+            continue;
+        }
+        activiteAjouter(&b->activite, &c->s, maintenant);
+        b->nbConnexions++;
+    }
+}
+
+/* Ferme les sessions inactives depuis plus de delaiMs (tete de liste). */
+static void expirer(Boucle *b, int delaiMs, long long maintenant)
+{
+    while (b->activite.premiere
+           && maintenant - b->activite.premiere->derniereActivite > delaiMs)
+        fermerConnexion(b, (Connexion *)b->activite.premiere);
+}
+
+int serveurEpoll(unsigned short port, int maxConnexions, int delaiMs)
+{
+    Boucle b;
+    struct epoll_event evs[NB_EVENEMENTS];
+    struct sockaddr_in addr;
+    int un = 1;
+
+    memset(&b, 0, sizeof(b));
+    b.ecoute = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (b.ecoute < 0) {
+        perror("[ERREUR] socket");
+        return 1;
+    }
+    setsockopt(b.ecoute, SOL_SOCKET, SO_REUSEADDR, &un, sizeof(un));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port        = htons(port);
+    if (bind(b.ecoute, (struct sockaddr*)&addr, sizeof(addr)) < 0
+        || listen(b.ecoute, SOMAXCONN) < 0) {
+        printf("[ERREUR] Impossible de lier le port %d.\n", port);
+        close(b.ecoute);
+        return 1;
+    }
+
+    b.ep = epoll_create1(EPOLL_CLOEXEC);
+    if (b.ep < 0) {
+        perror("[ERREUR] epoll_create1");
+        close(b.ecoute);
+        return 1;
+    }
+    struct epoll_event evEcoute;
+    evEcoute.events   = EPOLLIN;
+    evEcoute.data.ptr = NULL;   /* NULL = socket d'ecoute */
+    epoll_ctl(b.ep, EPOLL_CTL_ADD, b.ecoute, &evEcoute);
+    b.reserve = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+    /* Fins de votes : la boucle n'attend jamais l'ecriture du journal */
+    struct epoll_event evFins;
+    b.fins          = sessionFinsCreer();
+    evFins.events   = EPOLLIN;
+    evFins.data.ptr = b.fins;
+    if (b.fins && epoll_ctl(b.ep, EPOLL_CTL_ADD, sessionFinsDescripteur(b.fins), &evFins) < 0)
+        b.fins = NULL;
+
+    printf(">> Serveur reseau ACTIF sur le port %d (epoll, %d sessions max).\n",
+           port, maxConnexions);
+
+    while (1) {
+        /* Reveil au moins chaque seconde pour expirer les sessions inactives */
+        int n = epoll_wait(b.ep, evs, NB_EVENEMENTS, 1000);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            perror("[ERREUR] epoll_wait");
+            break;
+        }
+
+        long long maintenant = reseauMaintenantMs();
+        int       fins       = 0;
+        for (int i = 0; i < n; i++) {
+            if (evs[i].data.ptr == NULL)
+                accepter(&b, maxConnexions, maintenant);
+            else if (evs[i].data.ptr == b.fins)
+                fins = 1;   /* apres les sockets : une session fermee ici a abandonne son vote */
+            else
+                surEvenement(&b, (Connexion *)evs[i].data.ptr, evs[i].events, maintenant);
+        }
+        if (fins) reprendre(&b, maintenant);
+        if (b.fins) sessionFinsPublier(b.fins);   /* un reveil pour les votes du tour */
+        expirer(&b, delaiMs, maintenant);
+    }
+
+    while (b.activite.premiere) fermerConnexion(&b, (Connexion *)b.activite.premiere);
+    if (b.reserve >= 0) close(b.reserve);
+    close(b.ep);
+    close(b.ecoute);
+    return 1;
+}
+
+#endif /* __linux__ */
@@ -0,0 +1,37 @@
+/**
+ * @file reseau_epoll.h
+ * @brief Backend reseau evenementiel du SERVEUR PIVOTE (Linux, epoll).
+ *
+ * Un seul thread sert toutes les connexions : sockets non bloquants,
+ * epoll en mode front (EPOLLET) et, pour chaque connexion, une petite
+ * machine a etats :
+ *
+ *   ATTENTE_AUTH -> LISTE_ENVOYEE -> ATTENTE_VOTE -> VOTE_EN_COURS -> TERMINEE
+ *
+ * Le thread n'attend jamais un vote : la session est mise de cote le
+ * temps que l'applicateur le rende durable, et sa reponse part quand la
+ * file de fins (session.h) devient lisible. Les votes d'un tour de boucle
+ * partent ensemble vers l'applicateur, qui les ecrit d'un bloc.
+ *
+ * Chaque connexion occupe une structure de taille fixe (moins de 512
+ * octets) ; un tampon de sortie n'est alloue que si le noyau n'a pas pu
+ * tout envoyer d'un coup, les tampons de trames que pour les clients qui
+ * parlent le protocole trame. La machine a etats est celle de
+ * reseau_commun.h.
+ */
+
+#ifndef RESEAU_EPOLL_H
+#define RESEAU_EPOLL_H
+
+/**
+ * @brief Ecoute sur `port` et sert les sessions jusqu'a une erreur fatale.
+ *
+ * @param port           Port TCP d'ecoute.
+ * @param maxConnexions  Nombre maximal de sessions simultanees ; au-dela,
+ *                       les nouvelles connexions sont refusees (fermees).
+ * @param delaiMs        Une session inactive depuis ce delai est fermee.
+ * @return 1 si le serveur n'a pas pu demarrer ou s'est arrete sur erreur.
+ */
+int serveurEpoll(unsigned short port, int maxConnexions, int delaiMs);
+
+#endif /* RESEAU_EPOLL_H */
@@ -0,0 +1,639 @@
+/**
+ * @file reseau_uring.c
+ * @brief Backend io_uring du SERVEUR PIVOTE (voir reseau_uring.h).
+ *
+ * Compile uniquement sous Linux avec des en-tetes noyau >= 5.19 (accept
+ * multishot, anneaux de tampons) ; sinon `serveurUring()` renvoie -1 et
+ * le serveur se replie sur epoll.
+ */
+
+#if defined(__linux__)
+
+#define _GNU_SOURCE
+
+#include "reseau_uring.h"
+#include "reseau_commun.h"
+#include "diffusion.h"
+#include <errno.h>
+#include <linux/io_uring.h>
+
+#if defined(IORING_ACCEPT_MULTISHOT)
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+#define ENTREES_ANNEAU  4096   /* requetes soumises par tour au maximum  */
+#define NB_TAMPONS      4096   /* tampons de reception partages (2^n)    */
+#define TAILLE_TAMPON   TAILLE_ENTREE
+#define GROUPE_TAMPONS  0
+
+/* Type de requete, dans les 3 bits de poids faible de user_data */
+#define OP_RECV    1u
+#define OP_SEND    2u
+#define OP_ACCEPT  3u
+#define OP_CLOSE   4u
+#define OP_ANNULER 5u
+#define OP_FINS    6u   /* file de fins des votes lisible */
+#define OP_MASQUE  7u
+
+/* =========================================================
+ * ANNEAU io_uring (appels systeme bruts)
+ * ========================================================= */
+typedef struct {
+    int                  fd;
+    unsigned            *sqTete;
+    unsigned            *sqQueuePartagee;
+    unsigned             sqQueue;        /* queue locale, publiee a la soumission */
+    unsigned             sqMasque;
+    unsigned             sqEntrees;
+    struct io_uring_sqe *sqes;
+    unsigned            *cqTete;
+    unsigned            *cqQueue;
+    unsigned             cqMasque;
+    struct io_uring_cqe *cqes;
+    void                *anneauPtr;
+    size_t               anneauLen;
+    size_t               sqesLen;
+
+    struct io_uring_buf_ring *tamponsAnneau;
+    char                     *tampons;
+    unsigned short            tamponsQueue;
+} Anneau;
+
+static int uringSetup(unsigned entrees, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entrees, p);
+}
+
+static int uringEnter(int fd, unsigned aSoumettre, unsigned minFin, unsigned flags,
+                      void *arg, size_t argLen)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, aSoumettre, minFin, flags, arg, argLen);
+}
+
+static int uringRegister(int fd, unsigned op, void *arg, unsigned nb)
+{
+    return (int)syscall(__NR_io_uring_register, fd, op, arg, nb);
+}
+
+/* Verifie que le noyau connait les operations utilisees. */
+static int anneauSondage(int fd)
+{
+    static const int ops[] = { IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND,
+                               IORING_OP_CLOSE, IORING_OP_ASYNC_CANCEL,
+                               IORING_OP_POLL_ADD };
+    size_t taille = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *p = (struct io_uring_probe *)calloc(1, taille);
+    int ok = p && uringRegister(fd, IORING_REGISTER_PROBE, p, 256) == 0;
+
+    for (size_t i = 0; ok && i < sizeof(ops) / sizeof(ops[0]); i++)
+        ok = ops[i] <= p->last_op && (p->ops[ops[i]].flags & IO_URING_OP_SUPPORTED);
+    free(p);
+    return ok;
+}
+
+static void tamponRendre(Anneau *a, unsigned short bid)
+{
+    struct io_uring_buf *buf =
+        &a->tamponsAnneau->bufs[a->tamponsQueue & (NB_TAMPONS - 1)];
+    buf->addr = (uint64_t)(uintptr_t)(a->tampons + (size_t)bid * TAILLE_TAMPON);
+    buf->len  = TAILLE_TAMPON;
+    buf->bid  = bid;
+    a->tamponsQueue++;
+}
+
+static void tamponsPublier(Anneau *a)
+{
+    __atomic_store_n(&a->tamponsAnneau->tail, a->tamponsQueue, __ATOMIC_RELEASE);
+}
+
+static void anneauFermer(Anneau *a)
+{
+    if (a->fd >= 0) close(a->fd);
+    if (a->anneauPtr) munmap(a->anneauPtr, a->anneauLen);
+    if (a->sqes) munmap(a->sqes, a->sqesLen);
+    if (a->tamponsAnneau) munmap(a->tamponsAnneau, NB_TAMPONS * sizeof(struct io_uring_buf));
+    free(a->tampons);
+    memset(a, 0, sizeof(*a));
+    a->fd = -1;
+}
+
+/* Cree l'anneau et l'anneau de tampons ; renvoie 0 si io_uring est inutilisable. */
+static int anneauOuvrir(Anneau *a)
+{
+    static const unsigned modes[] = {
+#if defined(IORING_SETUP_DEFER_TASKRUN)
+        IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_DEFER_TASKRUN,
+#endif
+        IORING_SETUP_COOP_TASKRUN,
+        0
+    };
+    struct io_uring_params p;
+
+    memset(a, 0, sizeof(*a));
+    a->fd = -1;
+    for (size_t i = 0; i < sizeof(modes) / sizeof(modes[0]) && a->fd < 0; i++) {
+        memset(&p, 0, sizeof(p));
+        p.flags      = modes[i] | IORING_SETUP_CQSIZE;
+        p.cq_entries = ENTREES_ANNEAU * 4;
+        a->fd = uringSetup(ENTREES_ANNEAU, &p);
+        if (a->fd < 0 && errno != EINVAL) return 0;   /* ENOSYS, EPERM... */
+    }
+    if (a->fd < 0) return 0;
+
+    unsigned requis = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+    if ((p.features & requis) != requis || !anneauSondage(a->fd)) {
+        anneauFermer(a);
+        return 0;
+    }
+
+    size_t sqLen = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    size_t cqLen = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    a->anneauLen = sqLen > cqLen ? sqLen : cqLen;
+    a->anneauPtr = mmap(NULL, a->anneauLen, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, a->fd, IORING_OFF_SQ_RING);
+    a->sqesLen = p.sq_entries * sizeof(struct io_uring_sqe);
+    a->sqes = (struct io_uring_sqe *)mmap(NULL, a->sqesLen, PROT_READ | PROT_WRITE,
+                                          MAP_SHARED | MAP_POPULATE, a->fd, IORING_OFF_SQES);
+    if (a->anneauPtr == MAP_FAILED || a->sqes == MAP_FAILED) {
+        if (a->anneauPtr == MAP_FAILED) a->anneauPtr = NULL;
+        if (a->sqes == MAP_FAILED) a->sqes = NULL;
+        anneauFermer(a);
+        return 0;
+    }
+
+    char *base = (char *)a->anneauPtr;
+    a->sqTete          = (unsigned *)(base + p.sq_off.head);
+    a->sqQueuePartagee = (unsigned *)(base + p.sq_off.tail);
+    a->sqMasque        = *(unsigned *)(base + p.sq_off.ring_mask);
+    a->sqEntrees       = p.sq_entries;
+    a->sqQueue         = *a->sqQueuePartagee;
+    a->cqTete          = (unsigned *)(base + p.cq_off.head);
+    a->cqQueue         = (unsigned *)(base + p.cq_off.tail);
+    a->cqMasque        = *(unsigned *)(base + p.cq_off.ring_mask);
+    a->cqes            = (struct io_uring_cqe *)(base + p.cq_off.cqes);
+
+    /* Tableau d'indirection identite : l'entree i designe le SQE i */
+    unsigned *tableau = (unsigned *)(base + p.sq_off.array);
+    for (unsigned i = 0; i < p.sq_entries; i++) tableau[i] = i;
+
+    /* Anneau de tampons de reception, enregistre aupres du noyau */
+    void *br = mmap(NULL, NB_TAMPONS * sizeof(struct io_uring_buf), PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    a->tampons = (char *)malloc((size_t)NB_TAMPONS * TAILLE_TAMPON);
+    if (br == MAP_FAILED || !a->tampons) {
+        if (br != MAP_FAILED) munmap(br, NB_TAMPONS * sizeof(struct io_uring_buf));
+        anneauFermer(a);
+        return 0;
+    }
+    a->tamponsAnneau = (struct io_uring_buf_ring *)br;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr    = (uint64_t)(uintptr_t)br;
+    reg.ring_entries = NB_TAMPONS;
+    reg.bgid         = GROUPE_TAMPONS;
+    if (uringRegister(a->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        anneauFermer(a);
+        return 0;
+    }
+    for (unsigned i = 0; i < NB_TAMPONS; i++) tamponRendre(a, (unsigned short)i);
+    tamponsPublier(a);
+    return 1;
+}
+
+/*
+ * Publie les requetes preparees et, si `attendre`, bloque jusqu'a une
+ * completion ou 1 s. Un seul appel systeme pour tout le lot.
+ */
+static int anneauSoumettre(Anneau *a, int attendre)
+{
+    struct __kernel_timespec      ts;
+    struct io_uring_getevents_arg arg;
+
+    __atomic_store_n(a->sqQueuePartagee, a->sqQueue, __ATOMIC_RELEASE);
+    unsigned aSoumettre = a->sqQueue - __atomic_load_n(a->sqTete, __ATOMIC_ACQUIRE);
+
+    memset(&ts, 0, sizeof(ts));
+    memset(&arg, 0, sizeof(arg));
+    ts.tv_sec = 1;
+    arg.ts    = (uint64_t)(uintptr_t)&ts;
+
+    unsigned flags = IORING_ENTER_EXT_ARG | (attendre ? IORING_ENTER_GETEVENTS : 0);
+    if (uringEnter(a->fd, aSoumettre, attendre ? 1 : 0, flags, &arg, sizeof(arg)) < 0
+        && errno != ETIME && errno != EINTR && errno != EBUSY && errno != EAGAIN)
+        return -1;
+    return 0;
+}
+
+/* Prochain SQE libre (mis a zero) ; soumet le lot courant si la file est pleine. */
+static struct io_uring_sqe *anneauSqe(Anneau *a)
+{
+    if (a->sqQueue - __atomic_load_n(a->sqTete, __ATOMIC_ACQUIRE) == a->sqEntrees) {
+        anneauSoumettre(a, 0);
+        if (a->sqQueue - __atomic_load_n(a->sqTete, __ATOMIC_ACQUIRE) == a->sqEntrees)
+            return NULL;
+    }
+    struct io_uring_sqe *sqe = &a->sqes[a->sqQueue & a->sqMasque];
+    memset(sqe, 0, sizeof(*sqe));
+    a->sqQueue++;
+    return sqe;
+}
+
+/* =========================================================
+ * CONNEXIONS
+ * ========================================================= */
+typedef struct {
+    SessionReseau s;
+    Reponse       envois[2];      /* reponses restant a envoyer, dans l'ordre */
+    int           nbEnvois;
+    int           envoisEnVol;    /* SEND chaines en cours                  */
+    int           recvEnVol;
+    int           recvAnnule;     /* ASYNC_CANCEL soumis pour le RECV en vol */
+    int           fermee;
+} Connexion;
+
+typedef struct {
+    Anneau        a;
+    int           ecoute;
+    int           acceptMultishot;
+    int           acceptArme;
+    long long     acceptReprise;  /* pas de nouvel accept avant cet instant */
+    int           nbConnexions;
+    ListeActivite activite;
+    SessionFins  *fins;           /* votes finis ; NULL : votes bloquants */
+    int           finsArme;       /* POLL_ADD en vol sur la file de fins   */
+} Boucle;
+
+static void armerAccept(Boucle *b)
+{
+    struct io_uring_sqe *sqe = anneauSqe(&b->a);
+    if (!sqe) return;
+    sqe->opcode       = IORING_OP_ACCEPT;
+    sqe->fd           = b->ecoute;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->ioprio       = b->acceptMultishot ? IORING_ACCEPT_MULTISHOT : 0;
+    sqe->user_data    = OP_ACCEPT;
+    b->acceptArme = 1;
+}
+
+/* Surveille la file de fins ; rearme apres chaque completion (un coup). */
+static void armerFins(Boucle *b)
+{
+    struct io_uring_sqe *sqe = anneauSqe(&b->a);
+    if (!sqe) return;                         /* nouvel essai au tour suivant */
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = sessionFinsDescripteur(b->fins);
+    sqe->poll32_events = POLLIN;
+    sqe->user_data     = OP_FINS;
+    b->finsArme = 1;
+}
+
+static int armerRecv(Boucle *b, Connexion *c)
+{
+    if (c->recvEnVol) return 1;
+    struct io_uring_sqe *sqe = anneauSqe(&b->a);
+    if (!sqe) return 0;
+    sqe->opcode    = IORING_OP_RECV;
+    sqe->fd        = c->s.fd;
+    sqe->len       = TAILLE_TAMPON;
+    sqe->flags     = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = GROUPE_TAMPONS;
+    sqe->user_data = (uint64_t)(uintptr_t)c | OP_RECV;
+    c->recvEnVol = 1;
+    return 1;
+}
+
+/*
+ * Soumet toutes les reponses en attente d'un coup, chainees (IOSQE_IO_LINK)
+ * pour qu'elles partent dans l'ordre, chacune par son propre send comme
+ * avec le serveur bloquant. Un envoi partiel annule la suite de la chaine,
+ * qui est resoumise a la derniere completion.
+ */
+static int lancerEnvoi(Boucle *b, Connexion *c)
+{
+    if (c->envoisEnVol) return 1;
+    for (int i = 0; i < c->nbEnvois; i++) {
+        struct io_uring_sqe *sqe = anneauSqe(&b->a);
+        if (!sqe) return c->envoisEnVol > 0;
+        sqe->opcode    = IORING_OP_SEND;
+        sqe->fd        = c->s.fd;
+        sqe->addr      = (uint64_t)(uintptr_t)c->envois[i].data;
+        sqe->len       = (unsigned)c->envois[i].len;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->flags     = (i + 1 < c->nbEnvois) ? IOSQE_IO_LINK : 0;
+        sqe->user_data = (uint64_t)(uintptr_t)c | OP_SEND;
+        c->envoisEnVol++;
+    }
+    return 1;
+}
+
+/* Libere la connexion ; le close passe par l'anneau avec le lot suivant. */
+static void liberer(Boucle *b, Connexion *c)
+{
+    struct io_uring_sqe *sqe = anneauSqe(&b->a);
+    if (sqe) {
+        sqe->opcode    = IORING_OP_CLOSE;
+        sqe->fd        = c->s.fd;
+        sqe->user_data = OP_CLOSE;
+    } else {
+        close(c->s.fd);
+    }
+    reseauLibererSession(&c->s);
+    free(c);
+}
+
+/*
+ * Ferme la session. Si des requetes sont encore dans l'anneau, shutdown()
+ * les fait terminer et la memoire est liberee a la derniere completion.
+ */
+static void fermerConnexion(Boucle *b, Connexion *c)
+{
+    if (c->fermee) return;
+    c->fermee = 1;
+    activiteRetirer(&b->activite, &c->s);
+    b->nbConnexions--;
+    if (!c->recvEnVol && !c->envoisEnVol)
+        liberer(b, c);
+    else
+        shutdown(c->s.fd, SHUT_RDWR);
+}
+
+/*
+ * Observateur abonne : la socket passe a la diffusion des que plus rien
+ * n'est dans l'anneau pour elle. Un RECV en vol est d'abord annule ; sa
+ * completion rappelle confier().
+ */
+static void confier(Boucle *b, Connexion *c)
+{
+    if (c->nbEnvois > 0 || c->envoisEnVol) return;   /* reponses d'abord */
+    if (c->recvEnVol) {
+        if (c->recvAnnule) return;
+        struct io_uring_sqe *sqe = anneauSqe(&b->a);
+        if (!sqe) {
+            fermerConnexion(b, c);
+            return;
+        }
+        sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+        sqe->addr      = (uint64_t)(uintptr_t)c | OP_RECV;
+        sqe->user_data = OP_ANNULER;
+        c->recvAnnule  = 1;
+        return;
+    }
+
+    activiteRetirer(&b->activite, &c->s);
+    b->nbConnexions--;
+    c->fermee = 1;
+    if (diffusionAbonner(c->s.fd, c->s.periodeMs)) {
+        reseauLibererSession(&c->s);
+        free(c);
+    } else {
+        liberer(b, c);
+    }
+}
+
+/*
+ * Traite les messages recus si l'etat les attend et que les reponses
+ * precedentes sont parties, puis lance les nouvelles reponses.
+ */
+static void avancer(Boucle *b, Connexion *c)
+{
+    if (c->nbEnvois == 0 && reseauEntreeDisponible(&c->s)) {
+        int nb = reseauTraiterMessage(&c->s, c->envois);
+        if (nb < 0) {
+            fermerConnexion(b, c);
+            return;
+        }
+        c->nbEnvois = nb;
+        if (!lancerEnvoi(b, c)) {
+            fermerConnexion(b, c);
+            return;
+        }
+    }
+    /* La suite (vote, trame incomplete) peut arriver pendant les envois ;
+       pendant un vote en cours, plus rien n'est lu */
+    if (c->s.etat == ABONNEE)
+        confier(b, c);
+    else if (c->s.etat != TERMINEE && !reseauVoteEnAttente(&c->s) && !armerRecv(b, c))
+        fermerConnexion(b, c);
+}
+
+/* Votes finis : chaque session reprend ou elle s'etait arretee. */
+static void reprendre(Boucle *b, long long maintenant)
+{
+    SessionVote *v = sessionFinsRelever(b->fins);
+    while (v) {
+        SessionVote *suiv = v->suiv;   /* v est libere avec sa reponse */
+        Connexion   *c    = (Connexion *)v->session;
+        if (!c->fermee) {              /* sinon libere avec la connexion */
+            activiteToucher(&b->activite, &c->s, maintenant);
+            avancer(b, c);
+        }
+        v = suiv;
+    }
+}
+
+static void surAccept(Boucle *b, int res, unsigned flags, int maxConnexions,
+                      long long maintenant)
+{
+    if (!(flags & IORING_CQE_F_MORE)) b->acceptArme = 0;
+    if (res < 0) {
+        if (res == -EINVAL && b->acceptMultishot)
+            b->acceptMultishot = 0;               /* noyau sans accept multishot */
+        else
+            b->acceptReprise = maintenant + 100;  /* EMFILE... : laisse souffler */
+        return;
+    }
+    if (!b->acceptArme) armerAccept(b);
+
+    if (b->nbConnexions >= maxConnexions) {
+        close(res);
+        return;
+    }
+    Connexion *c = (Connexion *)calloc(1, sizeof(*c));
+    if (!c) {
+        close(res);
+        return;
+    }
+    c->s.fd   = res;
+    c->s.etat = ATTENTE_AUTH;
+    c->s.fins = b->fins;
+    activiteAjouter(&b->activite, &c->s, maintenant);
+    b->nbConnexions++;
+    if (!armerRecv(b, c)) fermerConnexion(b, c);
+}
+
+static void surRecv(Boucle *b, Connexion *c, int res, unsigned flags, long long maintenant)
+{
+    c->recvEnVol = 0;
+    if (flags & IORING_CQE_F_BUFFER) {
+        unsigned short bid = (unsigned short)(flags >> IORING_CQE_BUFFER_SHIFT);
+        if (res > 0 && !c->fermee
+            && !reseauAjouterEntree(&c->s, b->a.tampons + (size_t)bid * TAILLE_TAMPON,
+                                    (size_t)res))
+            res = -EMSGSIZE;                  /* entree trop longue : on ferme */
+        tamponRendre(&b->a, bid);
+    }
+    if (c->fermee) {
+        if (!c->envoisEnVol) liberer(b, c);
+        return;
+    }
+    if (c->s.etat == ABONNEE) {               /* RECV annule (ou arrive avant) */
+        confier(b, c);
+        return;
+    }
+    /*
+     * Tous les tampons pris : re-arme. Annule : l'annulation visait une
+     * connexion liberee entre-temps, dont celle-ci a repris l'adresse.
+     */
+    if (res == -ENOBUFS || res == -ECANCELED) {
+        if (!armerRecv(b, c)) fermerConnexion(b, c);
+        return;
+    }
+    if (res <= 0) {
+        fermerConnexion(b, c);
+        return;
+    }
+    activiteToucher(&b->activite, &c->s, maintenant);
+    avancer(b, c);
+}
+
+static void surSend(Boucle *b, Connexion *c, int res, long long maintenant)
+{
+    c->envoisEnVol--;
+    if (c->fermee) {
+        if (!c->envoisEnVol && !c->recvEnVol) liberer(b, c);
+        return;
+    }
+    if (res < 0 && res != -ECANCELED) {
+        fermerConnexion(b, c);
+        return;
+    }
+    if (res > 0) {
+        activiteToucher(&b->activite, &c->s, maintenant);
+        c->envois[0].data += res;
+        c->envois[0].len  -= (size_t)res;
+        if (c->envois[0].len == 0) {
+            c->envois[0] = c->envois[1];
+            c->nbEnvois--;
+        }
+    }
+    if (c->envoisEnVol > 0) return;           /* reste de la chaine en vol */
+    if (c->nbEnvois > 0) {                    /* envoi partiel : on reprend */
+        if (!lancerEnvoi(b, c)) fermerConnexion(b, c);
+        return;
+    }
+
+    /* Tout est parti : etape suivante */
+    if (c->s.etat == LISTE_ENVOYEE)
+        reseauListeEnvoyee(&c->s);
+    if (c->s.etat == TERMINEE)
+        fermerConnexion(b, c);
+    else
+        avancer(b, c);
+}
+
+/* =========================================================
+ * BOUCLE PRINCIPALE
+ * ========================================================= */
+int serveurUring(unsigned short port, int maxConnexions, int delaiMs)
+{
+    Boucle b;
+    struct sockaddr_in addr;
+    int un = 1;
+
+    memset(&b, 0, sizeof(b));
+    if (!anneauOuvrir(&b.a)) return -1;
+    b.acceptMultishot = 1;
+
+    b.ecoute = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (b.ecoute < 0) {
+        perror("[ERREUR] socket");
+        anneauFermer(&b.a);
+        return 1;
+    }
+    setsockopt(b.ecoute, SOL_SOCKET, SO_REUSEADDR, &un, sizeof(un));
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port        = htons(port);
+    if (bind(b.ecoute, (struct sockaddr*)&addr, sizeof(addr)) < 0
+        || listen(b.ecoute, SOMAXCONN) < 0) {
+        printf("[ERREUR] Impossible de lier le port %d.\n", port);
+        close(b.ecoute);
+        anneauFermer(&b.a);
+        return 1;
+    }
+
+    printf(">> Serveur reseau ACTIF sur le port %d (io_uring, %d sessions max).\n",
+           port, maxConnexions);
+    armerAccept(&b);
+    b.fins = sessionFinsCreer();   /* NULL : votes attendus dans la boucle */
+
+    while (1) {
+        /* Soumet tout le lot du tour precedent et attend (1 s au plus) */
+        if (anneauSoumettre(&b.a, 1) < 0) {
+            perror("[ERREUR] io_uring_enter");
+            break;
+        }
+
+        long long maintenant = reseauMaintenantMs();
+        unsigned  tete  = *b.a.cqTete;
+        unsigned  queue = __atomic_load_n(b.a.cqQueue, __ATOMIC_ACQUIRE);
+        unsigned short tampons = b.a.tamponsQueue;
+        int            fins    = 0;
+
+        for (; tete != queue; tete++) {
+            const struct io_uring_cqe *cqe = &b.a.cqes[tete & b.a.cqMasque];
+            uint64_t  ud    = cqe->user_data;
+            int       res   = cqe->res;
+            unsigned  flags = cqe->flags;
+            Connexion *c    = (Connexion *)(uintptr_t)(ud & ~(uint64_t)OP_MASQUE);
+
+            switch ((unsigned)(ud & OP_MASQUE)) {
+            case OP_ACCEPT: surAccept(&b, res, flags, maxConnexions, maintenant); break;
+            case OP_RECV:   surRecv(&b, c, res, flags, maintenant);                break;
+            case OP_SEND:   surSend(&b, c, res, maintenant);                       break;
+            case OP_FINS:   b.finsArme = 0; fins = 1;                              break;
+            case OP_CLOSE:  break;
+            default: break;                   /* OP_ANNULER */
+            }
+        }
+        __atomic_store_n(b.a.cqTete, tete, __ATOMIC_RELEASE);
+        if (fins) reprendre(&b, maintenant);
+        if (b.fins) sessionFinsPublier(b.fins);   /* un reveil pour les votes du tour */
+        if (b.a.tamponsQueue != tampons) tamponsPublier(&b.a);
+        if (b.fins && !b.finsArme) armerFins(&b);
+
+        while (b.activite.premiere
+               && maintenant - b.activite.premiere->derniereActivite > delaiMs)
+            fermerConnexion(&b, (Connexion *)b.activite.premiere);
+        if (!b.acceptArme && maintenant >= b.acceptReprise) armerAccept(&b);
+    }
+
+    while (b.activite.premiere) fermerConnexion(&b, (Connexion *)b.activite.premiere);
+    close(b.ecoute);
+    anneauFermer(&b.a);
+    return 1;
+}
+
+#else /* en-tetes noyau sans accept multishot */
+
+int serveurUring(unsigned short port, int maxConnexions, int delaiMs)
+{
+    (void)port; (void)maxConnexions; (void)delaiMs;
+    return -1;
+}
+
+#endif /* IORING_ACCEPT_MULTISHOT */
+
+#endif /* __linux__ */
@@ -0,0 +1,38 @@
+/**
+ * @file reseau_uring.h
+ * @brief Backend reseau io_uring du SERVEUR PIVOTE (Linux).
+ *
+ * Meme protocole et meme machine a etats que le backend epoll
+ * (reseau_commun.h), mais les accept/recv/send passent par un anneau
+ * io_uring pour reduire le nombre d'appels systeme lors de l'affluence
+ * de l'ouverture :
+ *   - un seul accept multishot arme pour toutes les connexions ;
+ *   - les receptions piochent dans un anneau de tampons fournis
+ *     (provided buffer ring) : aucun tampon de reception par connexion ;
+ *   - toutes les requetes preparees pendant un tour de boucle sont
+ *     soumises par un seul io_uring_enter, qui attend aussi les suivantes ;
+ *   - les votes ne sont pas attendus : la file de fins (session.h) est
+ *     surveillee par un POLL_ADD, et les votes d'un tour partent ensemble
+ *     vers l'applicateur.
+ *
+ * Aucune dependance a liburing : l'anneau est pilote par les appels
+ * systeme bruts.
+ */
+
+#ifndef RESEAU_URING_H
+#define RESEAU_URING_H
+
+/**
+ * @brief Ecoute sur `port` et sert les sessions avec io_uring.
+ *
+ * @param port           Port TCP d'ecoute.
+ * @param maxConnexions  Nombre maximal de sessions simultanees.
+ * @param delaiMs        Une session inactive depuis ce delai est fermee.
+ * @return -1 si io_uring est indisponible (noyau trop ancien, appels
+ *         interdits...) : rien n'a ete ouvert, l'appelant peut se replier
+ *         sur `serveurEpoll()` ;
+ *         1 si le serveur n'a pas pu demarrer ou s'est arrete sur erreur.
+ */
+int serveurUring(unsigned short port, int maxConnexions, int delaiMs);
+
+#endif /* RESEAU_URING_H */
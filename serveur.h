@@ -2,29 +2,57 @@
  * @file serveur.h
  * @brief Signatures des fonctions du SERVEUR PIVOTE V2 (administrateur).
  *
- * Compilation (MinGW / Code::Blocks, C99) :
- * gcc -std=c99 -Wall serveur_impl.c serveur_main.c auth.c -o serveur.exe -lws2_32
+ * Compilation (Windows ou Linux, C99) : cmake -S . -B build && cmake --build build
+ * (cible pivote-serveur), ou le projet Code::Blocks Pivoteserveur2.0.cbp.
  */
 
 #ifndef SERVEUR_H
 #define SERVEUR_H
 #include "auth.h"
-#include <winsock2.h>
-#include <windows.h>
+#include "decompte.h"
+#include "diffusion.h"
+#include "file_votes.h"
+#include "instantane.h"
+#include "journal_votes.h"
+#include "plateforme.h"
+#include "session.h"
+#include "table_electeurs.h"
 #include <stddef.h>
 #include <locale.h>
 
 /* =========================================================
  * CONSTANTES
  * ========================================================= */
-#define MAX                100
+#define MAX_CANDIDATS      DECOMPTE_MAX_CANDIDATS   /* electeurs : sans limite */
 #define PORT               8888
 #define BUFFER             2048
-#define FICHIER_SAUVEGARDE "vote_data.txt"
+#define FICHIER_INSTANTANE "vote_data.snap"      /* base (instantane.h)        */
+#define FICHIER_SAUVEGARDE "vote_data.txt"       /* ancienne base, relue seule  */
+#define SAUVEGARDE_SUFFIXE_MIGREE ".migre"       /* ancienne base, une fois reprise */
+#define FICHIER_JOURNAL    "vote_data.journal"   /* votes depuis l'instantane   */
+#define JOURNAL_PERIODE_MS 50      /* PIVOTE_FSYNC=periodique, sans PIVOTE_FSYNC_MS */
+#define COMMIT_LOT_MAX     4096    /* votes par ecriture du journal (PIVOTE_COMMIT_LOT) */
+#define COMMIT_ATTENTE_MS  0       /* attente des retardataires (PIVOTE_COMMIT_MS)  */
+#define FILE_VOTES_MAX     4096    /* demandes de vote en file (PIVOTE_FILE_VOTES)  */
+#define INSTANTANE_VOTES   1000000L   /* votes entre deux instantanes (PIVOTE_INSTANTANE_VOTES) */
 #define FICHIER_EXCEL      "resultats_vote.csv"
+#define FICHIER_JSON       "resultats_vote.json"
+#define EXPORT_PERIODE_MS  10000   /* exports au plus une fois par periode (PIVOTE_EXPORT_MS) */
 #define FICHIER_RAPPORT    "rapport_final.txt"
 #define CSV_PATH           "users.csv"
 
+/* Pool de workers reseau (taille : nbWorkersReseau, sinon PIVOTE_WORKERS) */
+#define NB_WORKERS_MIN     8
+#define NB_WORKERS_MAX     512
+#define FILE_CLIENTS       256     /* connexions acceptees en attente      */
+#define DELAI_CLIENT_MS    300000  /* kiosque inactif : connexion fermee  */
+
+/* Backends Linux (io_uring, epoll) : sessions servies par un seul thread */
+#define RESEAU_MAX_CONNEXIONS 16384
+
+/* Observateurs abonnes (diffusion.h) : une mise a jour au plus par periode */
+#define DIFFUSION_PERIODE_MS 250   /* PIVOTE_DIFFUSION_MS */
+
 /* =========================================================
  * NAVIGATION MENU (flches + couleurs)
  * ========================================================= */
@@ -38,7 +66,7 @@ void afficherMenuNavigue(int selection);
 /**
  * @brief Lance la navigation au clavier (flches + Entre).
  *        Retourne le numro de l'option choisie (comme avant : 1, 2, 3...).
- * @return Numro de l'option slectionne.
+ * @return Numro de l'option slectionne, -1 si l'entre est ferme.
  */
 int naviguerMenu(void);
 
@@ -51,30 +79,34 @@ int naviguerMenu(void);
 /* =========================================================
  * STRUCTURES
  * ========================================================= */
+/* Saisie d'un electeur (ajout, import) ; la table est en colonnes (table_electeurs.h). */
 typedef struct {
     int  id;
     char nom[50];
-    int  a_vote;
-    int  vote_blanc;
     char username[AUTH_MAX_USERNAME + 1];
 } Electeur;
 
+/* Les voix sont dans le decompte (decompte.h), indexe comme candidats[]. */
 typedef struct {
     int  id;
     char nom[50];
-    int  voix;
 } Candidat;
 
 /* =========================================================
  * VARIABLES GLOBALES (extern)
  * ========================================================= */
-extern Electeur electeurs[MAX];
-extern Candidat candidats[MAX];
-extern int nbElecteurs;
+extern TableElecteurs electeurs;
+extern Candidat candidats[MAX_CANDIDATS];
 extern int nbCandidats;
 extern int voteOuvert;
 extern int affichageAutoActif;
 
+/** Taille du pool reseau ; 0 = PIVOTE_WORKERS ou 4 par coeur. */
+extern int nbWorkersReseau;
+
+/** Protege electeurs et candidats[] entre le menu et les workers. */
+extern Verrou verrouDonnees;
+
 /* =========================================================
  * 1. HELPERS CONSOLE
  * ========================================================= */
@@ -86,6 +118,8 @@ void vider_buffer_stdin(void);
  * ========================================================= */
 void ajouterElecteur(void);
 void afficherElecteurs(void);
+int  importerElecteurs(const char *chemin);
+void importerElecteursCSV(void);
 void ajouterCandidat(void);
 void afficherCandidats(void);
 
@@ -115,7 +149,8 @@ void afficherGagnant(void);
 
 /**
  * @brief Genere rapport_final.txt : date/heure, resultats,
- *        gagnant, taux de participation, votes blancs.
+ *        gagnant, taux de participation, votes blancs ; et, de la meme
+ *        copie du decompte, resultats_vote.csv et resultats_vote.json.
  *        Appele automatiquement a la fermeture du vote.
  */
 void genererRapportFinal(void);
@@ -123,21 +158,52 @@ void genererRapportFinal(void);
 /* =========================================================
  * 5. PERSISTANCE DES DONNEES
  * ========================================================= */
-void sauvegarderDonnees(void);
+/**
+ * @brief Fait ecrire par l'ecrivain de fond un instantane de l'etat
+ *        courant (fichier temporaire force sur disque puis renomme) et
+ *        attend qu'il soit en place ; un nouveau segment du journal des
+ *        votes commence a la copie de l'etat.
+ * @return 1 si un instantane au moins aussi recent est en place, 0 sinon
+ *         (les precedents restent intacts).
+ */
+int sauvegarderDonnees(void);
+
+/**
+ * @brief Charge le dernier instantane valide (sinon l'ancienne sauvegarde
+ *        texte), rejoue la fin du journal des votes puis l'ouvre
+ *        (politique de synchronisation : PIVOTE_FSYNC, PIVOTE_FSYNC_MS).
+ */
 void chargerDonnees(void);
+
+/**
+ * @brief Fait ecrire tout de suite les exports (CSV, JSON, rapport) par
+ *        l'ecrivain de fond et l'attend. Hors de ces appels, il les tient a
+ *        jour au plus une fois par PIVOTE_EXPORT_MS (defaut
+ *        EXPORT_PERIODE_MS), quand les resultats ont change.
+ */
 void exporterVersExcel(void);
 
 /* =========================================================
- * 6. SERVEUR RESEAU (threads Windows)
+ * 6. SERVEUR RESEAU (pool de threads, epoll, io_uring)
+ * Un thread accepte les connexions, un pool de workers les sert
+ * (sous Linux : io_uring ou epoll, voir reseau_uring.h et reseau_epoll.h).
+ * Les etapes de session sont declarees dans session.h.
  * Protocole :
  *   Client -> "AUTH <username> <password>"
  *   Serveur -> "AUTH_OK" ou "AUTH_FAIL"
  *   Serveur -> liste des candidats
  *   Client -> "VOTE <idElecteur> <idCandidat>"
  *   Serveur -> "OK" ou "ERREUR"
+ * ou son equivalent trame, negocie a la connexion (voir protocole.h).
  * ========================================================= */
-DWORD WINAPI threadServeurReseau(LPVOID arg);
-DWORD WINAPI threadAffichageTempsReel(LPVOID arg);
+/**
+ * @brief Reconstruit le bulletin partage (session.h) depuis candidats[].
+ *        A appeler apres toute modification de la table des candidats.
+ */
+void publierListeCandidats(void);
+
+void threadServeurReseau(void *arg);
+void threadAffichageTempsReel(void *arg);
 void lancerServeurReseau(void);
 
 /* =========================================================
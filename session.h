@@ -0,0 +1,230 @@
+/**
+ * @file session.h
+ * @brief Etapes d'une session votant, communes a tous les backends reseau.
+ *
+ * Une session suit toujours le meme enchainement :
+ *   Client  -> "AUTH <username> <password>"
+ *   Serveur -> "AUTH_OK" puis la liste des candidats, ou "AUTH_FAIL"
+ *   Client  -> "VOTE <idElecteur> <idCandidat>"
+ *   Serveur -> "OK" ou "ERREUR"
+ * en texte, ou son equivalent trame (protocole.h). Un observateur (trames
+ * seulement) envoie SUBSCRIBE a la place du vote : sa socket est confiee a
+ * la diffusion des resultats (diffusion.h). Les fonctions texte
+ * analysent la requete puis appellent les fonctions de base, communes aux
+ * deux protocoles.
+ *
+ * Les backends (pool de threads, epoll, io_uring) ne s'occupent que des
+ * sockets ; la logique (authentification, liste, enregistrement du vote et
+ * synchronisation des donnees) est implementee ici une seule fois.
+ * Ce fichier ne depend d'aucune API systeme.
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stddef.h>
+#include "auth.h"
+#include "protocole.h"
+
+/** Taille maximale d'un message de session (= BUFFER du serveur et du client). */
+#define SESSION_TAILLE_MESSAGE 2048
+
+/** Role des comptes autorises a envoyer des VOTEBATCH. */
+#define ROLE_AGREGATEUR "agregateur"
+
+/** Role des comptes autorises a suivre les resultats (SUBSCRIBE). */
+#define ROLE_OBSERVATEUR "observateur"
+
+#define SESSION_MAX_CANDIDATS 128   /* = MAX_CANDIDATS (serveur.h) */
+
+/** Ce qu'un compte authentifie peut faire sur le reseau. */
+typedef enum {
+    PROFIL_REFUSE = 0,    /* compte inconnu, inactif, ou autre role    */
+    PROFIL_VOTANT,        /* un VOTE pour ses propres electeurs         */
+    PROFIL_AGREGATEUR,    /* des VOTEBATCH pour n'importe quel electeur */
+    PROFIL_OBSERVATEUR    /* SUBSCRIBE, lecture seule                   */
+} ProfilSession;
+
+/**
+ * @brief Verifie les identifiants d'un compte.
+ * @return PROFIL_VOTANT, PROFIL_AGREGATEUR ou PROFIL_OBSERVATEUR si le
+ *         compte existe, est actif et a le role "votant", ROLE_AGREGATEUR
+ *         ou ROLE_OBSERVATEUR ; PROFIL_REFUSE sinon.
+ */
+ProfilSession sessionVerifierCompte(const char *username, const char *password);
+
+/**
+ * @brief Enregistre le vote de l'electeur `idElecteur` pour `idCandidat`.
+ *
+ * Le vote est refuse si le scrutin est ferme, si l'electeur n'existe pas,
+ * n'appartient pas a `username` ou a deja vote. Un candidat inconnu compte
+ * comme vote blanc. Un vote accepte est persiste avant le retour, dans la
+ * meme ecriture du journal que les votes deposes par les autres sessions
+ * pendant ce temps (commit groupe).
+ *
+ * @return 1 si le vote est enregistre, 0 sinon.
+ */
+int sessionEnregistrerVote(const char *username, int idElecteur, int idCandidat);
+
+/**
+ * @brief Enregistre un lot de votes transmis par un agregateur.
+ *
+ * Le lot est compte d'un bloc par l'applicateur des votes : aucun
+ * instantane ne contient un lot a moitie applique, et il est ajoute au
+ * journal des votes en une seule ecriture avant le retour. Chaque vote est controle comme par
+ * sessionEnregistrerVote(), sans le controle du proprietaire ; un electeur
+ * present deux fois n'est compte qu'une fois. Si l'ecriture echoue, le
+ * lot entier est annule.
+ *
+ * @param votes     Votes du lot.
+ * @param nb        Nombre de votes.
+ * @param resultats Recoit (nb + 7) / 8 octets : bit k % 8 de l'octet k / 8
+ *                  a 1 si le vote k est enregistre.
+ * @return Nombre de votes enregistres, -1 si le lot a ete annule.
+ */
+int sessionVoterLot(const ProtoVote *votes, int nb, unsigned char *resultats);
+
+/**
+ * Votes sans attente, pour les backends evenementiels (epoll, io_uring) :
+ * un seul thread y sert toutes les sessions, il ne doit attendre ni
+ * l'ecriture du journal ni une place dans la file des votes.
+ *
+ * La boucle cree sa file de fins (sessionFinsCreer()) et surveille son
+ * descripteur en lecture. sessionSoumettreVote() et sessionSoumettreLot()
+ * valident les votes, les confient a l'applicateur et rendent tout de
+ * suite un SessionVote : la session est mise de cote. Quand les votes sont
+ * comptes et durables (ou refuses), l'applicateur range le SessionVote
+ * dans la file de fins, et le descripteur devient lisible ;
+ * sessionFinsRelever() rend alors les votes finis et la boucle envoie les
+ * reponses. File des votes pleine : seuls les votes concernes attendent,
+ * dans la file de fins, une place que l'applicateur signale par le meme
+ * descripteur.
+ *
+ * Les depots ne reveillent pas l'applicateur : la boucle appelle
+ * sessionFinsPublier() une fois par tour, apres avoir traite tous ses
+ * evenements, et les votes de tout le tour partagent une ecriture du
+ * journal.
+ *
+ * Tout se passe dans le thread de la boucle, sauf le rangement par
+ * l'applicateur. Une session fermee avant la fin de son vote met
+ * `session` a NULL : sessionFinsRelever() le liberera (compte ou non).
+ */
+typedef struct SessionFins SessionFins;
+
+typedef struct SessionVote {
+    void               *session;    /* a l'appelant ; NULL : vote abandonne  */
+    struct SessionVote *suiv;       /* votes rendus par sessionFinsRelever() */
+    int                 fini;       /* rendu par sessionFinsRelever()        */
+    int                 acceptes;   /* fini : votes enregistres, -1 si annules */
+    int                 nb;         /* votes soumis                          */
+    unsigned char      *resultats;  /* lot : comme sessionVoterLot() ; NULL pour un VOTE */
+} SessionVote;
+
+/**
+ * @brief Cree une file de fins (une par boucle, pour la vie du processus).
+ * @return NULL si le systeme ne le permet pas (hors Linux, plus de
+ *         descripteur...) : la boucle garde alors les votes bloquants.
+ */
+SessionFins *sessionFinsCreer(void);
+
+/** Descripteur lisible quand des votes sont finis (ou une place liberee). */
+int sessionFinsDescripteur(const SessionFins *f);
+
+/**
+ * @brief Redepose les votes qui attendaient une place, puis rend les votes
+ *        finis depuis l'appel precedent, dans l'ordre (chaines par `suiv`).
+ * Les votes abandonnes sont liberes au passage.
+ */
+SessionVote *sessionFinsRelever(SessionFins *f);
+
+/** Reveille l'applicateur si des votes ont ete deposes depuis l'appel precedent. */
+void sessionFinsPublier(SessionFins *f);
+
+/**
+ * @brief Soumet le vote de sessionEnregistrerVote() sans l'attendre.
+ * @return Le vote en cours (resultat : `acceptes` == 1), NULL si memoire
+ *         insuffisante.
+ */
+SessionVote *sessionSoumettreVote(SessionFins *f, void *session, const char *username,
+                                  int idElecteur, int idCandidat);
+
+/**
+ * @brief Soumet le lot de sessionVoterLot() sans l'attendre.
+ * @return Le lot en cours (resultat : `acceptes` et `resultats`), NULL si
+ *         memoire insuffisante.
+ */
+SessionVote *sessionSoumettreLot(SessionFins *f, void *session, const ProtoVote *votes, int nb);
+
+/** Libere un vote fini, une fois sa reponse construite. */
+void sessionVoteLiberer(SessionVote *v);
+
+/**
+ * Bulletin pre-serialise : la liste des candidats sous ses deux formes,
+ * construite une seule fois a chaque modification de la table des
+ * candidats et envoyee telle quelle par toutes les sessions. Immuable une
+ * fois publie ; libere quand la derniere session qui le tient le rend.
+ */
+typedef struct {
+    unsigned long        version;    /* incremente a chaque publication   */
+    const char          *texte;      /* liste texte, vote blanc compris   */
+    size_t               lenTexte;
+    const unsigned char *trame;      /* trame PROTO_CANDIDATS complete    */
+    size_t               lenTrame;
+    volatile long        refs;
+} ListeCandidats;
+
+/**
+ * @brief Prend une reference sur le bulletin courant.
+ * @return Le bulletin, a rendre par sessionRendreListe() ; NULL si aucun
+ *         n'a pu etre construit (memoire insuffisante).
+ */
+const ListeCandidats *sessionPrendreListe(void);
+
+/** Rend une reference prise par sessionPrendreListe() (NULL accepte). */
+void sessionRendreListe(const ListeCandidats *liste);
+
+/** Etat du decompte vu par les observateurs. */
+typedef struct {
+    int       voteOuvert;
+    long      inscrits;
+    long      votants;     /* bulletins, blancs compris */
+    long      blancs;
+    int       nbCandidats;
+    ProtoVoix voix[SESSION_MAX_CANDIDATS];   /* dans l'ordre du bulletin */
+} SessionResultats;
+
+/**
+ * @brief Lit le decompte courant (une passe, voir decompteAgreger()).
+ * Les votes en cours peuvent ne pas encore y figurer.
+ */
+void sessionLireResultats(SessionResultats *r);
+
+/**
+ * @brief Traite la requete "AUTH <username> <password>".
+ *
+ * Le protocole texte n'accepte que les votants.
+ *
+ * @param requete  Message recu du client (termine par '\0').
+ * @param username Recoit l'identifiant authentifie (AUTH_MAX_USERNAME + 1 octets).
+ * @return 1 si le compte existe, est actif et a le role "votant", 0 sinon.
+ */
+int sessionAuthentifier(const char *requete, char *username);
+
+/**
+ * @brief Traite la requete "VOTE <idElecteur> <idCandidat>"
+ * (voir sessionEnregistrerVote()).
+ *
+ * @param username Identifiant authentifie de la session.
+ * @param requete  Message recu du client (termine par '\0').
+ * @return 1 si le vote est enregistre ("OK"), 0 sinon ("ERREUR").
+ */
+int sessionVoter(const char *username, const char *requete);
+
+/**
+ * @brief Analyse la requete "VOTE <idElecteur> <idCandidat>" ; un nombre
+ *        absent vaut -1.
+ * @return 1 si c'est une requete VOTE, 0 sinon.
+ */
+int sessionLireVote(const char *requete, int *idElecteur, int *idCandidat);
+
+#endif /* SESSION_H */
@@ -0,0 +1,132 @@
+/**
+ * @file table_electeurs.c
+ * @brief Table des electeurs en colonnes (voir table_electeurs.h).
+ */
+
+#include "table_electeurs.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Garantit `octets` libres en fin d'arene. */
+static int areneReserver(TableElecteurs *t, size_t octets)
+{
+    if (octets > UINT_MAX - t->areneTaille) return 0;   /* positions sur 32 bits */
+    if (t->areneCap - t->areneTaille >= octets) return 1;
+
+    size_t cap = t->areneCap ? t->areneCap : 16384;
+    while (cap - t->areneTaille < octets) cap *= 2;
+    char *a = (char *)realloc(t->arene, cap);
+    if (!a) return 0;
+    t->arene    = a;
+    t->areneCap = cap;
+    return 1;
+}
+
+int tableElecteursReserver(TableElecteurs *t, int nb, size_t octets)
+{
+    if (!areneReserver(t, octets)) return 0;
+    if (nb <= t->cap - t->nb) return 1;
+    if (nb > INT_MAX / 2 - t->nb) return 0;
+
+    int cap = t->cap ? t->cap : 1024;
+    while (cap < t->nb + nb) cap *= 2;
+
+    /* Une colonne deja agrandie reste valide si la suivante echoue :
+       t->cap ne change qu'a la fin */
+    size_t mots = DECOMPTE_MOTS(cap), anciens = DECOMPTE_MOTS(t->cap);
+    void  *p;
+    if (!(p = realloc(t->id, (size_t)cap * sizeof(*t->id)))) return 0;
+    t->id = (int *)p;
+    if (!(p = realloc((void *)t->aVote, mots * sizeof(DecompteMot)))) return 0;
+    t->aVote = (volatile DecompteMot *)p;
+    memset((void *)(t->aVote + anciens), 0, (mots - anciens) * sizeof(DecompteMot));
+    if (!(p = realloc((void *)t->blanc, mots * sizeof(DecompteMot)))) return 0;
+    t->blanc = (volatile DecompteMot *)p;
+    memset((void *)(t->blanc + anciens), 0, (mots - anciens) * sizeof(DecompteMot));
+    if (!(p = realloc(t->choix, (size_t)cap * sizeof(*t->choix)))) return 0;
+    t->choix = (short *)p;
+    if (!(p = realloc(t->nom, (size_t)cap * sizeof(*t->nom)))) return 0;
+    t->nom = (unsigned int *)p;
+    if (!(p = realloc(t->login, (size_t)cap * sizeof(*t->login)))) return 0;
+    t->login = (unsigned int *)p;
+    t->cap = cap;
+    return 1;
+}
+
+/* Copie `s` en fin d'arene (place deja reservee) et rend sa position. */
+static unsigned int areneAjouter(TableElecteurs *t, const char *s, size_t n)
+{
+    unsigned int pos = (unsigned int)t->areneTaille;
+    memcpy(t->arene + t->areneTaille, s, n);
+    t->areneTaille += n;
+    return pos;
+}
+
+int tableElecteursAjouter(TableElecteurs *t, int id, const char *nom, const char *login)
+{
+    size_t lNom = strlen(nom) + 1, lLogin = strlen(login) + 1;
+
+    if (!tableElecteursReserver(t, 1, lNom + lLogin)) return -1;
+
+    int slot = t->nb++;
+    t->id[slot]    = id;
+    decompteLiberer(t->aVote, slot);
+    decompteLiberer(t->blanc, slot);
+    t->choix[slot] = -1;
+    t->nom[slot]   = areneAjouter(t, nom, lNom);
+    t->login[slot] = areneAjouter(t, login, lLogin);
+    return slot;
+}
+
+int tableElecteursCopier(TableElecteurs *dst, const TableElecteurs *src)
+{
+    size_t mots = DECOMPTE_MOTS(src->nb);
+
+    dst->nb          = 0;
+    dst->areneTaille = 0;
+    if (!tableElecteursReserver(dst, src->nb, src->areneTaille)) return 0;
+    if (src->nb > 0) {
+        memcpy(dst->id, src->id, (size_t)src->nb * sizeof(*src->id));
+        memcpy((void *)dst->aVote, (const void *)src->aVote, mots * sizeof(DecompteMot));
+        memcpy((void *)dst->blanc, (const void *)src->blanc, mots * sizeof(DecompteMot));
+        memcpy(dst->choix, src->choix, (size_t)src->nb * sizeof(*src->choix));
+        memcpy(dst->nom, src->nom, (size_t)src->nb * sizeof(*src->nom));
+        memcpy(dst->login, src->login, (size_t)src->nb * sizeof(*src->login));
+    }
+    if (src->areneTaille > 0) memcpy(dst->arene, src->arene, src->areneTaille);
+    dst->nb          = src->nb;
+    dst->areneTaille = src->areneTaille;
+    return 1;
+}
+
+void tableElecteursTronquer(TableElecteurs *t, int nb)
+{
+    if (nb < 0 || nb >= t->nb) return;
+    t->nb = nb;
+    /* Le login est la derniere chaine ecrite pour un electeur */
+    t->areneTaille = nb == 0 ? 0
+                   : t->login[nb - 1] + strlen(t->arene + t->login[nb - 1]) + 1;
+}
+
+void tableElecteursLiberer(TableElecteurs *t)
+{
+    free(t->id);
+    free((void *)t->aVote);
+    free((void *)t->blanc);
+    free(t->choix);
+    free(t->nom);
+    free(t->login);
+    free(t->arene);
+    memset(t, 0, sizeof(*t));
+}
+
+const char *tableElecteursNom(const TableElecteurs *t, int slot)
+{
+    return t->arene + t->nom[slot];
+}
+
+const char *tableElecteursLogin(const TableElecteurs *t, int slot)
+{
+    return t->arene + t->login[slot];
+}
@@ -0,0 +1,70 @@
+/**
+ * @file table_electeurs.h
+ * @brief Table des electeurs du SERVEUR PIVOTE, en colonnes (struct of arrays).
+ *
+ * Chaque champ est un tableau dense indexe par le slot de l'electeur :
+ * un parcours (participation, sauvegarde, recherche par id) ne lit que
+ * les colonnes dont il a besoin. Les colonnes chaudes (id, drapeaux, choix)
+ * tiennent en un peu plus de 6 octets par electeur ; les chaines (nom,
+ * login) sont rangees bout a bout dans une arene et reperees par leur
+ * position.
+ *
+ * La table grandit par doublement : un ajout peut deplacer toutes les
+ * colonnes. L'appelant serialise donc les ajouts avec les lectures
+ * (verrouDonnees, cote serveur). Ce module ne depend d'aucune API systeme.
+ */
+
+#ifndef TABLE_ELECTEURS_H
+#define TABLE_ELECTEURS_H
+
+#include <stddef.h>
+#include "decompte.h"
+
+typedef struct {
+    int            nb;
+    int            cap;
+    /* Colonnes chaudes ; aVote et blanc : un bit par electeur (decompte.h) */
+    int                  *id;
+    volatile DecompteMot *aVote;   /* reserve par decompteReserver()  */
+    volatile DecompteMot *blanc;
+    short                *choix;   /* slot du candidat choisi, -1 sinon */
+    /* Colonnes froides : positions dans l'arene */
+    unsigned int         *nom;
+    unsigned int         *login;
+    char                 *arene;
+    size_t                areneTaille;
+    size_t                areneCap;
+} TableElecteurs;
+
+/**
+ * @brief Garantit la place de `nb` electeurs de plus, dont les chaines
+ *        (terminateurs compris) font `octets` au total : les ajouts qui
+ *        suivent ne peuvent plus echouer.
+ * @return 0 si memoire insuffisante ; la table reste utilisable.
+ */
+int tableElecteursReserver(TableElecteurs *t, int nb, size_t octets);
+
+/**
+ * @brief Ajoute un electeur qui n'a pas vote.
+ * @return Son slot, -1 si memoire insuffisante (table inchangee).
+ */
+int tableElecteursAjouter(TableElecteurs *t, int id, const char *nom, const char *login);
+
+/**
+ * @brief Remplace le contenu de `dst` par une copie de `src`, colonne par
+ *        colonne. `dst` garde ses tableaux d'une copie a l'autre : une
+ *        fois a la taille de `src`, la copie n'alloue plus rien.
+ * @return 0 si memoire insuffisante (`dst` est alors vide).
+ */
+int tableElecteursCopier(TableElecteurs *dst, const TableElecteurs *src);
+
+/** Ramene la table a ses `nb` premiers electeurs (rechargement). */
+void tableElecteursTronquer(TableElecteurs *t, int nb);
+
+void tableElecteursLiberer(TableElecteurs *t);
+
+/** Chaines de l'electeur `slot` ; valides jusqu'au prochain ajout. */
+const char *tableElecteursNom(const TableElecteurs *t, int slot);
+const char *tableElecteursLogin(const TableElecteurs *t, int slot);
+
+#endif /* TABLE_ELECTEURS_H */